@@ -9,14 +9,14 @@
 	
 	MFC usage instructions:
 
-	1. Add "CNumericEditControl.h" and "CNumericEditControl.cpp" to your MFC project
+	1. Add "CNumericEditControl.h", "CNumericEditControl.cpp" and "NumericRadix*.h" to your MFC project (C++17 or later)
 	2. If necessary, add common controls manifest (see "stdafx.h" in example project)
 	3. #include "CNumericEditControl.h"
 	4. Add edit control to your dialog
 	5. Add control variable for the edit control	
 	6. Change the control variable type from CEdit to CNumericEditControl
 	7. Use the control as normal
-	8. Use methods AsString() or AsValue() to access value
+	8. Use methods AsString(), AsValue(), TryGetValue() or GetValue() to access value
 	9. If necessary, call ChangeMode() to change the display mode at runtime
 
 	MIT License for CNumericEditControl:
@@ -54,24 +54,41 @@
 #define WM_OCTMODE		WM_USER + 0x7F02
 #define WM_BINMODE		WM_USER + 0x7F03
 
+#define IDT_PUBLISH		0x7F10
+
 IMPLEMENT_DYNAMIC(CNumericEditControl, CEdit)
 
-CNumericEditControl::CNumericEditControl()
+//Shared formatted-text cache, off unless EnableFormatCache() is called
+static std::unique_ptr<numeric_radix::FormatCache<WCHAR>> s_pFormatCache;
+
+//The other constructors delegate to the full one, which sets every member
+CNumericEditControl::CNumericEditControl() : CNumericEditControl(VALUEINVALID, EDisplayMode::DISPLAY_DEC)
 {
-	m_llInitialValue = VALUEINVALID;
-	m_modeEx = EDisplayMode::DISPLAY_DEC;
 }
 
-CNumericEditControl::CNumericEditControl(EDisplayMode mode)
+CNumericEditControl::CNumericEditControl(EDisplayMode mode) : CNumericEditControl(VALUEINVALID, mode)
 {
-	m_llInitialValue = VALUEINVALID;
-	m_modeEx = mode;
 }
 
 CNumericEditControl::CNumericEditControl(LONGLONG llInitialValue, EDisplayMode mode)
 {
 	m_llInitialValue = llInitialValue;
 	m_modeEx = mode;
+	m_nBitWidth = 64;
+	m_bSigned = false;
+	ZeroMemory(m_nGroupDigits, sizeof(m_nGroupDigits));
+	m_numberType = ENumberType::NUMBER_INTEGER;
+	m_qFormat = numeric_radix::QFormat();
+	m_bExpressionMode = false;
+	m_bValueCached = false;
+	m_cachedStatus = numeric_radix::ParseStatus::Empty;
+	m_llCachedValue = VALUEINVALID;
+	m_nCachedRadix = 0;
+	m_cacheStats = ValueCacheStats();
+	m_publishStats = PublishStats();
+#ifdef NUMERIC_RADIX_INSTRUMENT
+	m_traceStats = numeric_radix::trace::Stats();
+#endif
 }
 
 CNumericEditControl::~CNumericEditControl()
@@ -83,90 +100,105 @@ BEGIN_MESSAGE_MAP(CNumericEditControl, CEdit)
 	ON_WM_CONTEXTMENU()
 	ON_WM_CHAR()	
 	ON_WM_KEYDOWN()
+	ON_WM_TIMER()
+	ON_CONTROL_REFLECT_EX(EN_CHANGE, OnChange)
+	ON_MESSAGE(WM_SETTEXT, OnSetText)
 END_MESSAGE_MAP()
 
-//Control lost focus
+//Control lost focus: regroup typed digits, or replace an expression with its value. The text is
+//only replaced if it changes, so no spurious EN_CHANGE is sent
 void CNumericEditControl::OnKillFocus(CWnd* pNewWnd)
 {
 	CEdit::OnKillFocus(pNewWnd);
+
+	LONGLONG llValue = VALUEINVALID;
+	if ((GetGrouping().groupSize || IsExpressionText()) && TryGetValue(llValue))
+	{
+		WCHAR szText[numeric_radix::GROUPED_FORMAT_BUFFER_SIZE] = L"";
+		WCHAR szCurrent[numeric_radix::GROUPED_FORMAT_BUFFER_SIZE] = L"";
+		FormatDisplayText(llValue, szText, _countof(szText));
+		GetWindowText(szCurrent, _countof(szCurrent));
+
+		if (wcscmp(szText, szCurrent) != 0)
+			DisplayValue(true, llValue);
+	}
 }
 
 //Filter input to prevent invalid characters
 void CNumericEditControl::OnChar(UINT nChar, UINT nRepCnt, UINT nFlags)
 {	
+	NUMERIC_RADIX_PROBE(m_traceStats, OnChar);
+
 	//Ignore all but permitted characters
 	BOOL bAllowed = false;
 
-	CString sValue;
-	GetWindowText(sValue);
-	int nValueLength = sValue.GetLength();
-
 	//Backspace always permitted
 	if (nChar == VK_BACK)
 		bAllowed = true;
 
-	//Decimal input
-	else if (m_modeEx == EDisplayMode::DISPLAY_DEC)
+	//Real text in decimal mode is only checked character by character (see NumericRadixReal.h)
+	else if (IsRealText())
+		bAllowed = numeric_radix::IsRealKeystrokeAllowed(nChar, m_numberType != ENumberType::NUMBER_FIXED_POINT);
+
+	//Integers follow the rule shared with the headless model (see NumericRadixModel.h): digits of
+	//the current radix (and x/X in hex mode) are permitted subject to position and digit count,
+	//signed decimal also accepts a leading '-' and expressions their operators and names. Only the
+	//length, selection and first two characters are read until the text may reach the width's
+	//digit count; from there the text is read in full so that separators are not counted as digits
+	//and a value beyond the bit width is refused
+	else
 	{
-		//0 not permitted if leading character in decimal mode (to avoid confusion with octal)
-		if (nValueLength == 0 && nChar == '0')
-		bAllowed = false;
+		int nStart = 0, nEnd = 0;
+		GetSel(nStart, nEnd);
 
-		//0-9 otherwise always permitted
-		else if (nChar >= '0' && nChar <= '9')
-			bAllowed = true;
-	}
+		numeric_radix::KeystrokeContext<WCHAR> context;
+		context.length = GetWindowTextLength();
+		context.selStart = nStart;
+		context.selEnd = nEnd;
 
-	//Hex input
-	else if (m_modeEx == EDisplayMode::DISPLAY_HEX)
-	{
-		//0 not permitted as second character in hex mode if leading character was 0 (to force 0x format)
-		if (nValueLength == 1 && sValue[0] == L'0' && nChar == '0')
-			bAllowed = false;
+		WCHAR szText[numeric_radix::GROUPED_FORMAT_BUFFER_SIZE + 1] = L"";
+		GetWindowText(szText, 3);
+		context.first = szText[0];
+		context.second = szText[0] ? szText[1] : L'\0';
 
-		//x and X permitted in hex mode for "0x" but only for second character
-		else if (nValueLength == 1 && (nChar == 'x' || nChar == 'X'))
-			bAllowed = true;
-
-		//0-9 otherwise always permitted
-		else if (nChar >= '0' && nChar <= '9')
-			bAllowed = true;
-
-		//a-f also permitted in hex mode
-		else if (nChar >= 'a' && nChar <= 'f')
-			bAllowed = true;
+		//Longer text is read truncated to one character more than any grouped value, and refused
+		auto fnText = [&]()
+		{
+			return std::wstring_view(szText, GetWindowText(szText, _countof(szText)));
+		};
 
-		//A-F also permitted in hex mode
-		else if (nChar >= 'A' && nChar <= 'F')
-			bAllowed = true;		
-	}
+		numeric_radix::EditFormat format = GetEditFormat();
+		bAllowed = numeric_radix::IsEditKeystrokeInRange(format, context, nChar, fnText);
 
-	//Octal input
-	else if (m_modeEx == EDisplayMode::DISPLAY_OCTAL)
-	{
-		//0 not permitted as second character in octal mode if leading character was 0 (to force leading 0 format)
-		if (nValueLength == 1 && sValue[0] == L'0' && nChar == '0')
-			bAllowed = false;
-		
-		//0-7 otherwise always permitted
-		else if (nChar >= '0' && nChar <= '7')
-			bAllowed = true;
+		//Keystrokes refused only for their digits or value are beyond the bit width
+		NUMERIC_RADIX_COUNT_IF(m_traceStats, OverflowRejections, !bAllowed && numeric_radix::IsEditKeystrokeAllowed(format, context, nChar, SIZE_MAX));
 	}
 
-	//Binary input
-	else if (m_modeEx == EDisplayMode::DISPLAY_BINARY)
-	{		
-		//0-1 always permitted
-		if (nChar >= '0' && nChar <= '1')
-			bAllowed = true;
-	}		
-
 	if (bAllowed)
 		CEdit::OnChar(nChar, nRepCnt, nFlags);	
+
+	else
+		NUMERIC_RADIX_COUNT(m_traceStats, RejectedKeystrokes);
+}
+
+//Text changed by the user: discard the cached value. The notification is also passed to the parent
+BOOL CNumericEditControl::OnChange()
+{
+	InvalidateValueCache();
+	return false;
+}
+
+//Text set programmatically: discard the cached value
+LRESULT CNumericEditControl::OnSetText(WPARAM /*wParam*/, LPARAM /*lParam*/)
+{
+	InvalidateValueCache();
+	return Default();
 }
 
 void CNumericEditControl::OnKeyDown(UINT nChar, UINT nRepCnt, UINT nFlags)
 {
+	NUMERIC_RADIX_PROBE(m_traceStats, OnKeyDown);
+
 	//Assume key not handled
 	BOOL bHandled = false;
 
@@ -204,69 +236,308 @@ CString CNumericEditControl::AsString(void)
 	return sValue;
 }
 
-BOOL CNumericEditControl::ParseValueInternal(LPCWSTR pszString, int nRadix, PLONGLONG pllResult)
+numeric_radix::ParseStatus CNumericEditControl::ParseValueInternal(std::wstring_view text, int nRadix, PLONGLONG pllResult)
 {	
-	/*
-		MSDN:	strtoull returns the converted value, if any, or ULLONG_MAX on overflow. 
-				strtoull returns 0 if no conversion can be performed. wcstoull returns values analogously to strtoull. 
-				For both functions, errno is set to ERANGE if overflow or underflow occurs.
-	*/
-
-	//Ignore commas and spaces (common input from Windows Calculator application)
-	CString sCookedString = pszString;
-	sCookedString.Replace(L",", L"");
-	sCookedString.Replace(L" ", L"");
-
-	errno = 0;
-	wchar_t *end = NULL;	
-	LONGLONG llValue=wcstoull(sCookedString.GetString(), &end, nRadix);
-
-	//Not a valid number
-	if (end == sCookedString.GetString())
-		return false;
+	//Commas and spaces are ignored and the remainder, up to the end of the view or a NUL, must be
+	//a complete wcstoull() number that fits the bit width and signedness (see NumericRadix.h and
+	//NumericRadixSigned.h)
+	//Real values in decimal mode are parsed to their bit patterns (see NumericRadixReal.h)
+	ULONGLONG ullValue = 0;
+	numeric_radix::ParseStatus status = numeric_radix::ParseStatus::Invalid;
+	if (m_numberType != ENumberType::NUMBER_INTEGER && nRadix == 10)
+	{
+		float fValue = 0;
+		double dValue = 0;
+		switch (m_numberType)
+		{
+			case ENumberType::NUMBER_FLOAT:			status = numeric_radix::parse_float(text, fValue);
+													ullValue = numeric_radix::FloatBits(fValue);
+													break;
 
-	//Additional characters after numeric
-	else if (L'\0' != *end)
-		return false;
+			case ENumberType::NUMBER_DOUBLE:		status = numeric_radix::parse_float(text, dValue);
+													ullValue = numeric_radix::FloatBits(dValue);
+													break;
+
+			default:								status = numeric_radix::parse_q(text, m_qFormat, ullValue);
+													break;
+		}
+	}
+
+	//Expressions are evaluated to a value that must fit the bit width (see NumericRadixExpr.h)
+	else if (IsExpressionText())
+	{
+		numeric_radix::ExprResult result = EvaluateExpressionInternal(text, nRadix);
+		status = numeric_radix::ExprParseStatus(result.status);
+		ullValue = result.value;
+	}
+
+	else
+		status = numeric_radix::parse_fixed(nRadix, text, GetFixedFormat(), ullValue);
+
+	if (status == numeric_radix::ParseStatus::Ok)
+		*pllResult = (LONGLONG)ullValue;
 
-	//Value out of range
-	else if ((LLONG_MIN == llValue || ULLONG_MAX == llValue) && ERANGE == errno)
+	NUMERIC_RADIX_COUNT_IF(m_traceStats, ParseFailures, status == numeric_radix::ParseStatus::Invalid);
+	NUMERIC_RADIX_COUNT_IF(m_traceStats, OverflowRejections, status == numeric_radix::ParseStatus::OutOfRange);
+	return status;
+}
+
+//Evaluate expression text in the current signedness, checking the result against the bit width
+//(see NumericRadixModel.h)
+numeric_radix::ExprResult CNumericEditControl::EvaluateExpressionInternal(std::wstring_view text, UINT nRadix)
+{
+	if (!m_pExprEvaluator)
+		m_pExprEvaluator = std::make_unique<numeric_radix::ExprEvaluator<WCHAR>>();
+
+	numeric_radix::FixedFormat fixed = GetFixedFormat();
+	return numeric_radix::FitExprResult(m_pExprEvaluator->Evaluate(text, numeric_radix::ExprOptions{ nRadix, fixed.isSigned }), fixed, nRadix);
+}
+
+BOOL CNumericEditControl::ParseWideValueInternal(std::wstring_view text, int nRadix, WideValue& result)
+{
+	//Same rules as ParseValueInternal() at the current bit width, to which negative values wrap
+	WideValue value;
+	if (!numeric_radix::parse_wide(nRadix, text, value, m_nBitWidth))
+	{
+		//A number that is only too wide counts as an overflow (checked only when instrumented)
+		NUMERIC_RADIX_COUNT_IF(m_traceStats, OverflowRejections, numeric_radix::parse_wide(nRadix, text, value));
+		NUMERIC_RADIX_COUNT_IF(m_traceStats, ParseFailures, !numeric_radix::parse_wide(nRadix, text, value));
 		return false;
+	}
 
-	*pllResult = llValue;
+	result = value;
 	return true;
 }
 
 LONGLONG CNumericEditControl::AsValue(void)
+{
+	LONGLONG llValue = VALUEINVALID;
+	if (!TryGetValue(llValue))
+		return VALUEINVALID;
+	
+	return llValue;
+}
+
+BOOL CNumericEditControl::TryGetValue(LONGLONG& llValue)
+{
+	return GetValue(llValue) == numeric_radix::ParseStatus::Ok;
+}
+
+numeric_radix::ParseStatus CNumericEditControl::GetValue(LONGLONG& llValue)
+{
+	NUMERIC_RADIX_PROBE(m_traceStats, AsValue);
+
+	UINT nRadix = GetRadix(m_modeEx);
+
+	//Reparse only if the text or mode changed since the last call
+	if (m_bValueCached && m_nCachedRadix == nRadix)
+		++m_cacheStats.nHits;
+
+	else
+	{
+		++m_cacheStats.nMisses;
+
+		CString sValue;
+		GetWindowText(sValue);
+
+		LONGLONG llParsed = VALUEINVALID;
+		m_cachedStatus = ParseValueInternal(std::wstring_view(sValue.GetString(), sValue.GetLength()), nRadix, &llParsed);
+		m_llCachedValue = m_cachedStatus == numeric_radix::ParseStatus::Ok ? llParsed : VALUEINVALID;
+		m_nCachedRadix = nRadix;
+		m_bValueCached = true;
+	}
+
+	llValue = m_llCachedValue;
+	return m_cachedStatus;
+}
+
+void CNumericEditControl::SetBitWidth(UINT nBits)
+{
+	//1 bit up to the widest supported value; 64 bits is the default
+	if (nBits < 1)
+		nBits = 1;
+
+	else if (nBits > numeric_radix::MAX_WIDE_BITS)
+		nBits = numeric_radix::MAX_WIDE_BITS;
+
+	//The cached value was parsed at the old width
+	m_nBitWidth = nBits;
+	InvalidateValueCache();
+}
+
+void CNumericEditControl::SetSigned(BOOL bSigned)
+{
+	m_bSigned = bSigned;
+	InvalidateValueCache();
+}
+
+void CNumericEditControl::SetExpressionMode(BOOL bExpression)
+{
+	m_bExpressionMode = bExpression;
+	InvalidateValueCache();
+}
+
+//Returns false if the name is not an identifier or too many names are defined
+BOOL CNumericEditControl::SetExpressionVariable(LPCWSTR pszName, LONGLONG llValue)
+{
+	if (!m_pExprEvaluator)
+		m_pExprEvaluator = std::make_unique<numeric_radix::ExprEvaluator<WCHAR>>();
+
+	//The text may name the variable, so its value may have changed
+	InvalidateValueCache();
+	return m_pExprEvaluator->SetVariable(pszName, (ULONGLONG)llValue);
+}
+
+//Result of the current text as an expression, whether or not expression mode is on
+numeric_radix::ExprResult CNumericEditControl::EvaluateExpression(void)
 {
 	CString sValue;
 	GetWindowText(sValue);
-	if (!sValue.GetLength())
-		return VALUEINVALID;
+	return EvaluateExpressionInternal(std::wstring_view(sValue.GetString(), sValue.GetLength()), GetRadix(m_modeEx));
+}
 
-	LONGLONG llValue = VALUEINVALID;
-	if (m_modeEx == EDisplayMode::DISPLAY_DEC)
-	{		
-		if (!ParseValueInternal(sValue, 10, &llValue))
-			return VALUEINVALID;
+void CNumericEditControl::SetNumberType(ENumberType type)
+{
+	m_numberType = type;
+	InvalidateValueCache();
+}
+
+void CNumericEditControl::SetFixedPoint(UINT nIntBits, UINT nFracBits, BOOL bSigned)
+{
+	//Out of range formats are clamped to 64 bits, at most 63 of them fraction bits
+	numeric_radix::QFormat q;
+	q.fracBits = nFracBits < 63 ? nFracBits : 63;
+	q.intBits = nIntBits < 64 - q.fracBits ? nIntBits : 64 - q.fracBits;
+	q.isSigned = bSigned != FALSE;
+	if (q.isSigned && !q.intBits)
+		q.intBits = 1;
+
+	else if (!numeric_radix::QWidth(q))
+		q.intBits = 1;
+
+	m_qFormat = q;
+	SetNumberType(ENumberType::NUMBER_FIXED_POINT);
+}
+
+//Bits of the value: the bit width for integers, and the width of the real format otherwise
+UINT CNumericEditControl::GetValueBits(void) const
+{
+	switch (m_numberType)
+	{
+		case ENumberType::NUMBER_FLOAT:			return 32;
+		case ENumberType::NUMBER_DOUBLE:		return 64;
+		case ENumberType::NUMBER_FIXED_POINT:	return numeric_radix::QWidth(m_qFormat);
+		default:								return m_nBitWidth;
 	}
-	else if (m_modeEx == EDisplayMode::DISPLAY_HEX)
+}
+
+//Negative values are shown with a sign (or sign-extended in hex, octal and binary)
+BOOL CNumericEditControl::IsSignedValue(void) const
+{
+	if (m_numberType == ENumberType::NUMBER_FIXED_POINT)
+		return m_qFormat.isSigned;
+
+	return m_numberType == ENumberType::NUMBER_INTEGER && m_bSigned && m_nBitWidth <= 64;
+}
+
+BOOL CNumericEditControl::TryGetDouble(double& dValue)
+{
+	LONGLONG llValue = VALUEINVALID;
+	if (!TryGetValue(llValue))
+		return false;
+
+	switch (m_numberType)
 	{
-		if (!ParseValueInternal(sValue, 16, &llValue))
-			return VALUEINVALID;
-	}	
-	else if (m_modeEx == EDisplayMode::DISPLAY_OCTAL)
+		case ENumberType::NUMBER_FLOAT:			dValue = numeric_radix::FloatFromBits<float>((ULONGLONG)llValue);
+												break;
+
+		case ENumberType::NUMBER_DOUBLE:		dValue = numeric_radix::FloatFromBits<double>((ULONGLONG)llValue);
+												break;
+
+		case ENumberType::NUMBER_FIXED_POINT:	dValue = numeric_radix::QToDouble((ULONGLONG)llValue, m_qFormat);
+												break;
+
+		default:								dValue = IsSignedValue() ? (double)llValue : (double)(ULONGLONG)llValue;
+												break;
+	}
+
+	return true;
+}
+
+//Values that do not fit a Qm.n format or an integer empty the control
+void CNumericEditControl::SetDouble(double dValue)
+{
+	ULONGLONG ullBits = 0;
+	switch (m_numberType)
 	{
-		if (!ParseValueInternal(sValue, 8, &llValue))
-			return VALUEINVALID;
+		case ENumberType::NUMBER_FLOAT:			DisplayValue(true, (LONGLONG)numeric_radix::FloatBits((float)dValue));
+												break;
+
+		case ENumberType::NUMBER_DOUBLE:		DisplayValue(true, (LONGLONG)numeric_radix::FloatBits(dValue));
+												break;
+
+		case ENumberType::NUMBER_FIXED_POINT:	DisplayValue(numeric_radix::DoubleToQ(dValue, m_qFormat, ullBits), (LONGLONG)ullBits);
+												break;
+
+		default:								if (IsSignedValue())
+													DisplayValue(dValue >= -9223372036854775808.0 && dValue < 9223372036854775808.0, (LONGLONG)dValue);
+												else
+													DisplayValue(dValue >= 0 && dValue < 18446744073709551616.0, (LONGLONG)(ULONGLONG)dValue);
+												break;
 	}
-	else if (m_modeEx == EDisplayMode::DISPLAY_BINARY)
+}
+
+void CNumericEditControl::SetDigitGrouping(EDisplayMode mode, UINT nDigits)
+{
+	//A group as wide as the widest value is no grouping
+	m_nGroupDigits[(WORD)mode & 3] = nDigits < numeric_radix::FORMAT_BUFFER_SIZE ? nDigits : 0;
+}
+
+//Grouping for the current mode; the separator is a comma in decimal and a space otherwise
+numeric_radix::Grouping CNumericEditControl::GetGrouping(void) const
+{
+	numeric_radix::Grouping grouping = numeric_radix::DefaultGrouping(GetRadix(m_modeEx));
+	grouping.groupSize = GetDigitGrouping(m_modeEx);
+	return grouping;
+}
+
+UINT CNumericEditControl::GetRadix(EDisplayMode mode)
+{
+	switch (mode)
 	{
-		if (!ParseValueInternal(sValue, 2, &llValue))
-			return VALUEINVALID;
+		case EDisplayMode::DISPLAY_HEX:		return 16;
+		case EDisplayMode::DISPLAY_OCTAL:	return 8;
+		case EDisplayMode::DISPLAY_BINARY:	return 2;
+		default:							return 10;
 	}
-	
-	return llValue;
+}
+
+size_t CNumericEditControl::ParseValues(EDisplayMode mode, const std::wstring_view* pStrings, size_t nCount, LONGLONG* pValues, BYTE* pValidBits)
+{
+	return numeric_radix::parse_batch(GetRadix(mode), pStrings, nCount, pValues, pValidBits);
+}
+
+size_t CNumericEditControl::FormatValues(EDisplayMode mode, const LONGLONG* pValues, size_t nCount, LPWSTR pszBuffer, size_t nStride, size_t* pLengths)
+{
+	return numeric_radix::format_batch(GetRadix(mode), pValues, nCount, pszBuffer, nStride, pLengths);
+}
+
+void CNumericEditControl::EnableFormatCache(size_t nMaxBytes)
+{
+	if (nMaxBytes)
+		s_pFormatCache = std::make_unique<numeric_radix::FormatCache<WCHAR>>(nMaxBytes);
+
+	else
+		s_pFormatCache.reset();
+}
+
+BOOL CNumericEditControl::GetFormatCacheStats(numeric_radix::FormatCacheStats& stats)
+{
+	if (!s_pFormatCache)
+		return false;
+
+	stats = s_pFormatCache->GetStats();
+	return true;
 }
 
 void CNumericEditControl::SetString(CString sText)
@@ -276,7 +547,76 @@ void CNumericEditControl::SetString(CString sText)
 
 void CNumericEditControl::SetValue(LONGLONG llNewValue)
 {
-	UpdateControl(llNewValue);
+	//Negative values clear the control unless it is signed or holds a real value's bit pattern
+	DisplayValue(llNewValue >= 0 || IsSignedValue() || m_numberType != ENumberType::NUMBER_INTEGER, llNewValue);
+}
+
+void CNumericEditControl::EnablePublishedValues(UINT nIntervalMs)
+{
+	if (nIntervalMs)
+		SetTimer(IDT_PUBLISH, nIntervalMs, nullptr);
+
+	else
+		KillTimer(IDT_PUBLISH);
+}
+
+//Show the latest published value, if there is one and the user is not editing. Returns true if
+//the text was replaced
+BOOL CNumericEditControl::ApplyPublishedValue(void)
+{
+	if (!m_publishSlot.IsPending())
+		return false;
+
+	//Leave the value in the slot, where later values replace it, until editing ends
+	if (IsUserEditing())
+	{
+		++m_publishStats.nDeferred;
+		return false;
+	}
+
+	ULONGLONG ullValue = 0;
+	if (!m_publishSlot.Take(ullValue))
+		return false;
+
+	//The value cache holds what the text reads back as, so an unchanged value costs no repaint
+	LONGLONG llValue = (LONGLONG)ullValue;
+	BOOL bValid = llValue >= 0 || IsSignedValue() || m_numberType != ENumberType::NUMBER_INTEGER;
+	LONGLONG llShown = (LONGLONG)numeric_radix::FitToWidth(ullValue, GetFixedFormat());
+	if (m_bValueCached && m_nCachedRadix == GetRadix(m_modeEx) &&
+		(bValid ? (m_cachedStatus == numeric_radix::ParseStatus::Ok && m_llCachedValue == llShown) : m_cachedStatus == numeric_radix::ParseStatus::Empty))
+	{
+		++m_publishStats.nUnchanged;
+		return false;
+	}
+
+	SetValue(llValue);
+	++m_publishStats.nApplied;
+	return true;
+}
+
+CNumericEditControl::PublishStats CNumericEditControl::GetPublishStats(void) const
+{
+	numeric_radix::ValueSlotStats slotStats = m_publishSlot.GetStats();
+
+	PublishStats stats = m_publishStats;
+	stats.nPublished = slotStats.published;
+	stats.nCoalesced = slotStats.coalesced;
+	return stats;
+}
+
+void CNumericEditControl::ResetPublishStats(void)
+{
+	m_publishSlot.ResetStats();
+	m_publishStats = PublishStats();
+}
+
+void CNumericEditControl::OnTimer(UINT_PTR nIDEvent)
+{
+	if (nIDEvent == IDT_PUBLISH)
+		ApplyPublishedValue();
+
+	else
+		CEdit::OnTimer(nIDEvent);
 }
 
 void CNumericEditControl::Empty(void)
@@ -291,10 +631,13 @@ void CNumericEditControl::PreSubclassWindow()
 	UpdateControl(m_llInitialValue);
 }
 
-void CNumericEditControl::UpdateControl(LONGLONG llNewValue)
+void CNumericEditControl::UpdateCueBanner(void)
 {
 	//Set watermark
-	if (m_modeEx == EDisplayMode::DISPLAY_DEC)
+	if (IsRealText())
+		SetCueBanner(m_numberType == ENumberType::NUMBER_FIXED_POINT ? L"Fixed point" : L"Floating point", true);
+
+	else if (m_modeEx == EDisplayMode::DISPLAY_DEC)
 		SetCueBanner(L"Decimal", true);
 
 	else if (m_modeEx == EDisplayMode::DISPLAY_HEX)
@@ -305,29 +648,79 @@ void CNumericEditControl::UpdateControl(LONGLONG llNewValue)
 
 	else if (m_modeEx == EDisplayMode::DISPLAY_BINARY)
 		SetCueBanner(L"Binary", true);
+}
+
+void CNumericEditControl::UpdateControl(LONGLONG llNewValue)
+{
+	DisplayValue(llNewValue >= 0, llNewValue);
+}
+
+//Display a value, or empty the control if bValid is false
+void CNumericEditControl::DisplayValue(BOOL bValid, LONGLONG llValue)
+{
+	NUMERIC_RADIX_PROBE(m_traceStats, UpdateControl);
+
+	UpdateCueBanner();
 	
 	//Display formatted numeric value
-	CString sText;
-	if (llNewValue >= 0)
-	{	
-		if (m_modeEx == EDisplayMode::DISPLAY_DEC)
-			sText.Format(L"%I64u", (ULONGLONG)llNewValue);
+	UINT nRadix = GetRadix(m_modeEx);
+	WCHAR szText[numeric_radix::GROUPED_FORMAT_BUFFER_SIZE] = L"";
+	if (bValid)
+		FormatDisplayText(llValue, szText, _countof(szText));
+	
+	SetWindowText(szText);
+
+	//The displayed text is known to parse back to the new value, so prime the cache (setting the
+	//text above has already invalidated it)
+	m_cachedStatus = bValid ? numeric_radix::ParseStatus::Ok : numeric_radix::ParseStatus::Empty;
+	m_llCachedValue = bValid ? llValue : VALUEINVALID;
+	m_nCachedRadix = nRadix;
+	m_bValueCached = true;
+}
 
-		else if (m_modeEx == EDisplayMode::DISPLAY_HEX)
-			sText.Format(L"0x%I64x", (ULONGLONG)llNewValue);
+//Text for a value in the current mode, width, signedness and grouping. llValue is updated to
+//the value the text reads back as. Fixed widths, signed values and grouped text share the format
+//cache, keyed by all three
+size_t CNumericEditControl::FormatDisplayText(LONGLONG& llValue, LPWSTR pszText, size_t nCapacity)
+{
+	UINT nRadix = GetRadix(m_modeEx);
+	if (IsRealText())
+		return FormatRealText(llValue, pszText, nCapacity);
 
-		else if (m_modeEx == EDisplayMode::DISPLAY_OCTAL)
-			sText.Format(L"0%I64o", (ULONGLONG)llNewValue);
+	numeric_radix::Grouping grouping = GetGrouping();
+	if (!IsFixedWidth() && !grouping.groupSize)
+	{
+		if (s_pFormatCache)
+			return s_pFormatCache->Format(nRadix, (ULONGLONG)llValue, pszText, nCapacity);
 
-		else if (m_modeEx == EDisplayMode::DISPLAY_BINARY)
-		{			
-			WCHAR szBuffer[_MAX_U64TOSTR_BASE2_COUNT];
-			_ui64tow_s(llNewValue, szBuffer, _MAX_U64TOSTR_BASE2_COUNT, 2);
-			sText = szBuffer;			
-		}	
+		return numeric_radix::format(nRadix, (ULONGLONG)llValue, pszText, nCapacity);
+	}
+
+	numeric_radix::FixedFormat fixed = GetFixedFormat();
+	llValue = (LONGLONG)numeric_radix::FitToWidth((ULONGLONG)llValue, fixed);
+
+	auto fnFormat = [&](LPWSTR pszBuffer, size_t nBufferSize)
+	{
+		return numeric_radix::format_fixed(nRadix, (ULONGLONG)llValue, fixed, pszBuffer, nBufferSize, grouping);
+	};
+
+	if (s_pFormatCache)
+		return s_pFormatCache->Get((ULONGLONG)llValue, numeric_radix::FormatOptions(nRadix, (grouping.groupSize << 8) | (fixed.bits << 1) | fixed.isSigned), pszText, nCapacity, fnFormat);
+
+	return fnFormat(pszText, nCapacity);
+}
+
+//Decimal text of a real value from its bit pattern (see NumericRadixReal.h). Real text is not
+//grouped or cached
+size_t CNumericEditControl::FormatRealText(LONGLONG& llValue, LPWSTR pszText, size_t nCapacity)
+{
+	llValue = (LONGLONG)numeric_radix::FitToWidth((ULONGLONG)llValue, GetFixedFormat());
+	switch (m_numberType)
+	{
+		case ENumberType::NUMBER_FLOAT:			return numeric_radix::format_float(numeric_radix::FloatFromBits<float>((ULONGLONG)llValue), pszText, nCapacity);
+		case ENumberType::NUMBER_DOUBLE:		return numeric_radix::format_float(numeric_radix::FloatFromBits<double>((ULONGLONG)llValue), pszText, nCapacity);
+		default:								return numeric_radix::format_q((ULONGLONG)llValue, m_qFormat, pszText, nCapacity);
 	}
-	
-	SetWindowText(sText);
 }
 
 void CNumericEditControl::OnContextMenu(CWnd* /*pWnd*/, CPoint point)
@@ -347,7 +740,7 @@ void CNumericEditControl::OnContextMenu(CWnd* /*pWnd*/, CPoint point)
 	m_stMenuContext.InsertMenu(3, MF_BYPOSITION | (m_modeEx == EDisplayMode::DISPLAY_BINARY ? MF_CHECKED : 0), WM_BINMODE, L"Binary");
 	m_stMenuContext.InsertMenu(4, MF_BYPOSITION | (sValue.GetLength() ? 0 : MF_GRAYED), WM_CUT, L"Cut");
 	m_stMenuContext.InsertMenu(5, MF_BYPOSITION | (sValue.GetLength() ? 0 : MF_GRAYED), WM_COPY, L"Copy");
-	m_stMenuContext.InsertMenu(6, MF_BYPOSITION | (GetClipboardText().GetLength() ? 0 : MF_GRAYED), WM_PASTE, L"Paste");
+	m_stMenuContext.InsertMenu(6, MF_BYPOSITION | (HasClipboardText() ? 0 : MF_GRAYED), WM_PASTE, L"Paste");
 	m_stMenuContext.TrackPopupMenu(TPM_LEFTALIGN | TPM_LEFTBUTTON |TPM_RIGHTBUTTON, point.x, point.y, this);
 }
 
@@ -375,6 +768,8 @@ BOOL CNumericEditControl::OnCommand(WPARAM wParam, LPARAM lParam)
 		case WM_CUT:		//Cut text to clipboard
 		case WM_COPY:		//Copy text to clipboard
 							{
+								NUMERIC_RADIX_PROBE(m_traceStats, Copy);
+
 								CString sValue;
 								GetWindowText(sValue);
 					
@@ -412,35 +807,39 @@ BOOL CNumericEditControl::OnCommand(WPARAM wParam, LPARAM lParam)
 
 		case WM_PASTE:		//Paste text from clipboard							
 							{
-								CString sNewValue = GetClipboardText();
-								if (!sNewValue.GetLength())
-									return true;														
+								NUMERIC_RADIX_PROBE(m_traceStats, Paste);
 
-								//Parse text and determine if valid numeric value
+								//The text is parsed in place in the clipboard's memory, and the
+								//control is only updated once the clipboard has been closed
+								BOOL bValid = false;
 								LONGLONG llValue = VALUEINVALID;
-								if (m_modeEx == EDisplayMode::DISPLAY_DEC)
-								{
-									if (!ParseValueInternal(sNewValue, 10, &llValue))
-										llValue = VALUEINVALID;
-								}
-								else if (m_modeEx == EDisplayMode::DISPLAY_HEX)
-								{
-									if (!ParseValueInternal(sNewValue, 16, &llValue))
-										llValue = VALUEINVALID;
-								}
-								else if (m_modeEx == EDisplayMode::DISPLAY_OCTAL)
+								WideValue value;
+
+								BOOL bText = WithClipboardText([&](LPCWSTR pszText, size_t nCapacity)
 								{
-									if (!ParseValueInternal(sNewValue, 8, &llValue))
-										llValue = VALUEINVALID;
-								}
-								else if (m_modeEx == EDisplayMode::DISPLAY_BINARY)
+									std::wstring_view text(pszText, nCapacity);
+									if (IsWideMode())
+										bValid = ParseWideValueInternal(text, GetRadix(m_modeEx), value);
+									else
+										bValid = ParseValueInternal(text, GetRadix(m_modeEx), &llValue) == numeric_radix::ParseStatus::Ok;
+								});
+
+								if (!bText)
+									return true;
+
+								//Wide mode: keep values up to the current bit width
+								if (IsWideMode())
 								{
-									if (!ParseValueInternal(sNewValue, 2, &llValue))
-										llValue = VALUEINVALID;
+									if (bValid)
+										SetWideValue(value);
+									else
+										UpdateControl();
+
+									return true;
 								}
-								
+
 								//Used parsed value						
-								UpdateControl(llValue);								
+								DisplayValue(bValid, llValue);
 							}
 							return true;
 			
@@ -454,28 +853,84 @@ void CNumericEditControl::ChangeMode(EDisplayMode newMode)
 	//No change required
 	if (m_modeEx == newMode)
 		return;
+
+	NUMERIC_RADIX_PROBE(m_traceStats, ChangeMode);
 	
-	//Parse value and change mode
-	LONGLONG llCurrentValue = AsValue();
+	//Wide mode: parse value at the current bit width and change mode
+	if (IsWideMode())
+	{
+		CString sValue;
+		GetWindowText(sValue);
+
+		WideValue value;
+		BOOL bValid = ParseWideValueInternal(std::wstring_view(sValue.GetString(), sValue.GetLength()), GetRadix(m_modeEx), value);
+		m_modeEx = newMode;
+
+		if (bValid)
+			SetWideValue(value);
+		else
+			UpdateControl();
+
+		return;
+	}
+
+	//Parse value and change mode. The cached value belongs to the old mode
+	LONGLONG llCurrentValue = VALUEINVALID;
+	BOOL bValid = TryGetValue(llCurrentValue);
 	m_modeEx = newMode;	
-	UpdateControl(llCurrentValue);
+	InvalidateValueCache();
+	DisplayValue(bValid, llCurrentValue);
 }
 
-CString CNumericEditControl::GetClipboardText()
+//Call fnText(pszText, nCapacity) with the clipboard text locked in place. The text is not
+//copied: nCapacity is the size of the clipboard memory in characters, which bounds the read if
+//the terminator is missing. Returns false without calling fnText if there is no text to paste
+template <typename TextFn>
+BOOL CNumericEditControl::WithClipboardText(TextFn fnText)
 {
-	CString sResult;
+	BOOL bText = false;
 
 	if (OpenClipboard())
 	{
 		HANDLE hData = GetClipboardData(CF_UNICODETEXT);
-		if (hData)
+		LPCWSTR pszText = hData ? (LPCWSTR)GlobalLock(hData) : nullptr;
+		if (pszText)
 		{
-			sResult = (LPCWSTR)GlobalLock(hData);
+			size_t nCapacity = GlobalSize(hData) / sizeof(WCHAR);
+			if (nCapacity && pszText[0])
+			{
+				fnText(pszText, nCapacity);
+				bText = true;
+			}
+
 			GlobalUnlock(hData);
 		}
 
 		CloseClipboard();
 	}
 
-	return sResult;
+	return bText;
+}
+
+BOOL CNumericEditControl::GetClipboardValues(numeric_radix::PasteResult& result, size_t nMaxValues)
+{
+	result = numeric_radix::PasteResult();
+	return WithClipboardText([&](LPCWSTR pszText, size_t nCapacity)
+	{
+		//Each token is parsed as typed text would be: to the bit width and signedness, and as a
+		//real value or expression where those are enabled
+		UINT nRadix = GetRadix(m_modeEx);
+		result = numeric_radix::parse_paste_with(pszText, nCapacity, [&](std::wstring_view token, uint64_t& value)
+		{
+			LONGLONG llValue = 0;
+			numeric_radix::ParseStatus status = ParseValueInternal(token, nRadix, &llValue);
+			value = (ULONGLONG)llValue;
+			return status;
+		}, nMaxValues);
+	});
+}
+
+BOOL CNumericEditControl::HasClipboardText()
+{
+	return WithClipboardText([](LPCWSTR, size_t) {});
 }
\ No newline at end of file
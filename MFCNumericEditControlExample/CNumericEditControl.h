@@ -36,6 +36,19 @@
 
 #pragma once
 
+#include <string_view>
+
+#include "NumericRadixCache.h"
+#include "NumericRadixExpr.h"
+#include "NumericRadixGroup.h"
+#include "NumericRadixModel.h"
+#include "NumericRadixPaste.h"
+#include "NumericRadixPublish.h"
+#include "NumericRadixReal.h"
+#include "NumericRadixSigned.h"
+#include "NumericRadixTrace.h"
+#include "NumericRadixWide.h"
+
 // CNumericEditControl
 
 class CNumericEditControl : public CEdit
@@ -52,6 +65,14 @@ public:
 		DISPLAY_BINARY,
 	};
 
+	enum class ENumberType : WORD
+	{
+		NUMBER_INTEGER,
+		NUMBER_FLOAT,
+		NUMBER_DOUBLE,
+		NUMBER_FIXED_POINT,
+	};
+
 	CNumericEditControl();
 	CNumericEditControl(EDisplayMode mode);
 	CNumericEditControl(LONGLONG llInitialValue, EDisplayMode mode);	
@@ -64,20 +85,206 @@ public:
 	void ChangeMode(EDisplayMode newMode);
 	void Empty(void);
 
+	//Parsed value of the current text. The value is cached and only reparsed after the text,
+	//mode or width has changed, so polling is cheap. GetValue() reports why there is no value;
+	//TryGetValue() returns false if the text is empty, invalid or out of range
+	struct ValueCacheStats
+	{
+		ULONGLONG nHits;
+		ULONGLONG nMisses;
+	};
+
+	numeric_radix::ParseStatus GetValue(LONGLONG& llValue);
+	BOOL TryGetValue(LONGLONG& llValue);
+	ValueCacheStats GetValueCacheStats(void) const { return m_cacheStats; }
+	void ResetValueCacheStats(void) { m_cacheStats = ValueCacheStats(); }
+
+	//Values from other threads (see NumericRadixPublish.h). PublishValue() may be called from any
+	//thread at any rate and only stores the value. The UI thread shows the latest published value
+	//on each tick of the timer started by EnablePublishedValues() (0 stops it), or whenever the
+	//application calls ApplyPublishedValue(), e.g. once per frame, so there is at most one repaint
+	//per tick and the values published in between are coalesced. While the user is editing (the
+	//control has focus and is not read-only) values are held, and the latest is shown on the first
+	//tick after focus leaves. A value that the text already shows is not repainted
+	struct PublishStats
+	{
+		ULONGLONG nPublished;
+		ULONGLONG nApplied;
+		ULONGLONG nCoalesced;	//Overwritten before a tick took them
+		ULONGLONG nDeferred;	//Ticks that held a value while the user was editing
+		ULONGLONG nUnchanged;	//Taken but not repainted
+	};
+
+	void PublishValue(LONGLONG llNewValue) { m_publishSlot.Publish((ULONGLONG)llNewValue); }
+	void EnablePublishedValues(UINT nIntervalMs);
+	BOOL ApplyPublishedValue(void);
+	PublishStats GetPublishStats(void) const;
+	void ResetPublishStats(void);
+
+	//Parse a table of values on the clipboard (columns, CSV, hex dumps) in the current mode, one
+	//value per token between line breaks, tabs and semicolons (see NumericRadixPaste.h). Each
+	//token is checked as typed text is, against the bit width, signedness, number type and
+	//expression mode, and tokens that do not fit are reported as OutOfRange. At most nMaxValues
+	//tokens are read. The control's text is not changed. Returns false if the clipboard has no text
+	BOOL GetClipboardValues(numeric_radix::PasteResult& result, size_t nMaxValues = numeric_radix::DEFAULT_MAX_PASTE_TOKENS);
+
+	//Fixed-width and wide values (see NumericRadixSigned.h and NumericRadixWide.h). Widths below
+	//64 bits limit input to that width. Bit widths above 64 select wide mode, in which mode
+	//changes and paste keep values up to that width; AsValue() remains limited to 64 bits
+	void SetBitWidth(UINT nBits);
+	UINT GetBitWidth(void) const { return m_nBitWidth; }
+
+	//Signed values at widths up to 64 bits: decimal shows a '-' sign, and hex, octal and binary
+	//show the two's complement bit pattern with every digit of the width. SetValue() then shows
+	//negative values rather than clearing the control, and AsValue() cannot tell -1 from an
+	//invalid value, so use GetValue() or TryGetValue(). Width and signedness apply from the next
+	//value displayed
+	void SetSigned(BOOL bSigned);
+	BOOL IsSigned(void) const { return m_bSigned; }
+
+	//Digit grouping on display (see NumericRadixGroup.h): nDigits digits between separators in the
+	//given mode, or 0 for none (the default). Typically 3 in decimal ("1,234,567") and octal, and
+	//4, 8 or 16 in hex and binary ("0x1234 5678"). Typed digits are regrouped when the control
+	//loses focus; separators are ignored on input as before
+	void SetDigitGrouping(EDisplayMode mode, UINT nDigits);
+	UINT GetDigitGrouping(EDisplayMode mode) const { return m_nGroupDigits[(WORD)mode & 3]; }
+
+	//Floating-point and Qm.n fixed-point values (see NumericRadixReal.h). Decimal mode shows the
+	//value (the shortest round-trip text of a float, the exact text of a Qm.n value) and accepts
+	//decimal or, for floats, hex-float input ("0x1.8p3"); hex, octal and binary show the raw bit
+	//pattern. The integer value (AsValue(), SetValue()) is the bit pattern: 32 or 64 bits for
+	//floats, and m + n bits for Qm.n, sign-extended when signed. SetFixedPoint() selects Qm.n, in
+	//which m includes the sign bit (Q1.15, Q16.16). Like the width, the type applies from the next
+	//value displayed
+	void SetNumberType(ENumberType type);
+	ENumberType GetNumberType(void) const { return m_numberType; }
+	void SetFixedPoint(UINT nIntBits, UINT nFracBits, BOOL bSigned = true);
+	BOOL TryGetDouble(double& dValue);
+	void SetDouble(double dValue);
+
+	//Expression input for integers up to 64 bits (see NumericRadixExpr.h): the text may be an
+	//expression such as "0x1000 + 4*0x40" or "~0xFF & mask", with literals in the current mode's
+	//radix unless prefixed, and names defined with SetExpressionVariable(). The value is the
+	//result, which must fit the bit width; the result replaces the text when the control loses
+	//focus. EvaluateExpression() evaluates the current text with the error and its position, for a
+	//live preview. Compiled expressions are cached, so polling unchanged text is cheap
+	void SetExpressionMode(BOOL bExpression);
+	BOOL IsExpressionMode(void) const { return m_bExpressionMode; }
+	BOOL SetExpressionVariable(LPCWSTR pszName, LONGLONG llValue);
+	numeric_radix::ExprResult EvaluateExpression(void);
+
+	//Wide values at the bit width: AsWideValue() reads the text as wide mode does (negative values
+	//wrap to the width) and fails if the value does not also fit Bits; SetWideValue() rejects a
+	//value wider than the bit width and leaves the control unchanged
+	template <size_t Bits>
+	BOOL AsWideValue(numeric_radix::WideUInt<Bits>& value)
+	{
+		static_assert(Bits <= numeric_radix::MAX_WIDE_BITS, "Bits must be at most MAX_WIDE_BITS");
+
+		CString sValue;
+		GetWindowText(sValue);
+
+		WideValue wide;
+		if (!ParseWideValueInternal(std::wstring_view(sValue.GetString(), sValue.GetLength()), GetRadix(m_modeEx), wide) || wide.BitLength() > Bits)
+			return false;
+
+		for (size_t i = 0; i < value.LIMBS; ++i)
+			value.limbs[i] = wide.limbs[i];
+
+		return true;
+	}
+
+	template <size_t Bits>
+	BOOL SetWideValue(const numeric_radix::WideUInt<Bits>& value)
+	{
+		if (value.BitLength() > m_nBitWidth)
+			return false;
+
+		WCHAR szText[numeric_radix::WideUInt<Bits>::FORMAT_BUFFER_SIZE];
+		numeric_radix::format_wide(GetRadix(m_modeEx), value, szText, _countof(szText));
+		UpdateCueBanner();
+		SetWindowText(szText);
+		return true;
+	}
+
+	//Optional process-wide cache of formatted text shared by all controls (see NumericRadixCache.h),
+	//bounded to nMaxBytes; 0 disables it. Call on the UI thread before controls display values
+	static void EnableFormatCache(size_t nMaxBytes);
+	static BOOL GetFormatCacheStats(numeric_radix::FormatCacheStats& stats);
+
+#ifdef NUMERIC_RADIX_INSTRUMENT
+	//Call counts, latency histograms and event counters for this control (see NumericRadixTrace.h);
+	//numeric_radix::trace::GlobalStats() has the totals for all controls
+	const numeric_radix::trace::Stats& GetTraceStats(void) const { return m_traceStats; }
+	void ResetTraceStats(void) { m_traceStats.Reset(); }
+#endif
+
+	//Batch conversion of arrays without a window (see NumericRadix.h). Invalid strings are returned
+	//as VALUEINVALID and cleared in the pValidBits bitmap; negative values format as empty strings
+	static UINT GetRadix(EDisplayMode mode);
+	static size_t ParseValues(EDisplayMode mode, const std::wstring_view* pStrings, size_t nCount, LONGLONG* pValues, BYTE* pValidBits);
+	static size_t FormatValues(EDisplayMode mode, const LONGLONG* pValues, size_t nCount, LPWSTR pszBuffer, size_t nStride, size_t* pLengths);
+
 private:
+	using WideValue = numeric_radix::WideUInt<numeric_radix::MAX_WIDE_BITS>;
+
 	EDisplayMode m_modeEx;
 	LONGLONG m_llInitialValue;
+	UINT m_nBitWidth;
+	BOOL m_bSigned;
+	UINT m_nGroupDigits[4];
+	ENumberType m_numberType;
+	numeric_radix::QFormat m_qFormat;
+	BOOL m_bExpressionMode;
+	std::unique_ptr<numeric_radix::ExprEvaluator<WCHAR>> m_pExprEvaluator;
+
+	//Value cache, valid for m_nCachedRadix until the text changes
+	BOOL m_bValueCached;
+	numeric_radix::ParseStatus m_cachedStatus;
+	LONGLONG m_llCachedValue;
+	UINT m_nCachedRadix;
+	ValueCacheStats m_cacheStats;
+
+	//Latest value from PublishValue(); applied, deferred and unchanged counts are kept here
+	numeric_radix::ValueSlot m_publishSlot;
+	PublishStats m_publishStats;
+
+#ifdef NUMERIC_RADIX_INSTRUMENT
+	numeric_radix::trace::Stats m_traceStats;
+#endif
 
-	afx_msg void OnKillFocus(CWnd* pNewWnd);
 	afx_msg void UpdateControl(LONGLONG llNewValue = VALUEINVALID);
+	void DisplayValue(BOOL bValid, LONGLONG llValue);
+	size_t FormatDisplayText(LONGLONG& llValue, LPWSTR pszText, size_t nCapacity);
+	size_t FormatRealText(LONGLONG& llValue, LPWSTR pszText, size_t nCapacity);
+	numeric_radix::Grouping GetGrouping(void) const;
+	UINT GetValueBits(void) const;
+	BOOL IsSignedValue(void) const;
+	BOOL IsWideMode(void) const { return m_numberType == ENumberType::NUMBER_INTEGER && m_nBitWidth > 64; }
+	BOOL IsRealText(void) const { return m_numberType != ENumberType::NUMBER_INTEGER && m_modeEx == EDisplayMode::DISPLAY_DEC; }
+	BOOL IsExpressionText(void) const { return m_bExpressionMode && m_numberType == ENumberType::NUMBER_INTEGER && m_nBitWidth <= 64; }
+	BOOL IsUserEditing(void) const { return !(GetStyle() & ES_READONLY) && ::GetFocus() == GetSafeHwnd(); }
+	BOOL IsFixedWidth(void) const { return GetValueBits() < 64 || (GetValueBits() == 64 && IsSignedValue()); }
+	numeric_radix::FixedFormat GetFixedFormat(void) const { return { GetValueBits() < 64 ? GetValueBits() : 64, IsSignedValue() != FALSE }; }
+	numeric_radix::EditFormat GetEditFormat(void) const { return { GetRadix(m_modeEx), GetFixedFormat(), GetGrouping(), IsExpressionText() != FALSE }; }
 	virtual BOOL OnCommand(WPARAM wParam, LPARAM lParam);
 	afx_msg void OnContextMenu(CWnd* pWnd, CPoint point);
+	afx_msg BOOL OnChange();
+	afx_msg LRESULT OnSetText(WPARAM wParam, LPARAM lParam);
+	numeric_radix::ParseStatus ParseValueInternal(std::wstring_view text, int nRadix, PLONGLONG pllResult);
+	BOOL ParseWideValueInternal(std::wstring_view text, int nRadix, WideValue& result);
+	numeric_radix::ExprResult EvaluateExpressionInternal(std::wstring_view text, UINT nRadix);
+	void UpdateCueBanner(void);
+	void InvalidateValueCache(void) { m_bValueCached = false; }
+	template <typename TextFn> BOOL WithClipboardText(TextFn fnText);
+	BOOL HasClipboardText();
+
+protected:
+	afx_msg void OnKillFocus(CWnd* pNewWnd);
 	afx_msg void OnChar(UINT nChar, UINT nRepCnt, UINT nFlags);
 	afx_msg void OnKeyDown(UINT nChar, UINT nRepCnt, UINT nFlags);
-	BOOL ParseValueInternal(LPCWSTR pszString, int nRadix, PLONGLONG pllResult);	
-	CString GetClipboardText();
+	afx_msg void OnTimer(UINT_PTR nIDEvent);
 
-protected:
 	DECLARE_MESSAGE_MAP()
 	virtual void PreSubclassWindow();
 };
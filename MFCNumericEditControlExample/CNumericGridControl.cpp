@@ -0,0 +1,296 @@
+/*
+	CNumericGridControl.h
+
+	Virtual list control for displaying and editing large grids of numeric fields with the
+	display rules of CNumericEditControl. Only visible cells are formatted, and a single
+	CNumericEditControl is created while a cell is being edited.
+
+	MFC usage instructions:
+
+	1. Add "CNumericGridControl.*" in addition to the CNumericEditControl files to your MFC project
+	2. #include "CNumericGridControl.h"
+	3. Add a list control to your dialog with View "Report" and Owner Data set (LVS_OWNERDATA)
+	4. Add a control variable of type CNumericGridControl for the list control
+	5. In OnInitDialog(), insert the list columns with InsertColumn() and call SetGridSize()
+	6. Use SetValue()/GetValue() and SetCellMode()/SetColumnMode() to access cells
+	7. Double-click a cell to edit it; Enter or loss of focus commits and Escape cancels
+
+	MIT License for CNumericEditControl:
+
+	Copyright (c) 2019-2020 Data Synergy UK Ltd
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "stdafx.h"
+#include "CNumericGridControl.h"
+
+//Private definitions
+//
+#define WM_ENDEDIT		WM_USER + 0x7F10
+#define IDC_GRIDEDITOR	0x7F10
+
+static_assert(static_cast<int>(CNumericEditControl::EDisplayMode::DISPLAY_DEC) == static_cast<int>(numeric_radix::DisplayMode::Decimal)
+	&& static_cast<int>(CNumericEditControl::EDisplayMode::DISPLAY_HEX) == static_cast<int>(numeric_radix::DisplayMode::Hex)
+	&& static_cast<int>(CNumericEditControl::EDisplayMode::DISPLAY_OCTAL) == static_cast<int>(numeric_radix::DisplayMode::Octal)
+	&& static_cast<int>(CNumericEditControl::EDisplayMode::DISPLAY_BINARY) == static_cast<int>(numeric_radix::DisplayMode::Binary),
+	"EDisplayMode and numeric_radix::DisplayMode must be in the same order");
+
+// CNumericGridEditor
+
+CNumericGridEditor::CNumericGridEditor(EDisplayMode mode) : CNumericEditControl(mode)
+{
+	m_bEnding = false;
+}
+
+BEGIN_MESSAGE_MAP(CNumericGridEditor, CNumericEditControl)
+	ON_WM_GETDLGCODE()
+	ON_WM_CHAR()
+	ON_WM_KILLFOCUS()
+END_MESSAGE_MAP()
+
+//Ask the grid to end editing. The message is posted so that the editor is not destroyed while
+//still handling a message, and carries the editor's window so a late message cannot end a newer edit
+void CNumericGridEditor::EndEdit(BOOL bCommit)
+{
+	if (m_bEnding)
+		return;
+
+	m_bEnding = true;
+	GetParent()->PostMessage(WM_ENDEDIT, bCommit, (LPARAM)GetSafeHwnd());
+}
+
+//Receive Enter and Escape rather than the dialog
+UINT CNumericGridEditor::OnGetDlgCode()
+{
+	return CNumericEditControl::OnGetDlgCode() | DLGC_WANTALLKEYS;
+}
+
+void CNumericGridEditor::OnChar(UINT nChar, UINT nRepCnt, UINT nFlags)
+{
+	if (nChar == VK_RETURN)
+		EndEdit(true);
+
+	else if (nChar == VK_ESCAPE)
+		EndEdit(false);
+
+	else
+		CNumericEditControl::OnChar(nChar, nRepCnt, nFlags);
+}
+
+void CNumericGridEditor::OnKillFocus(CWnd* pNewWnd)
+{
+	CNumericEditControl::OnKillFocus(pNewWnd);
+	EndEdit(true);
+}
+
+// CNumericGridControl
+
+IMPLEMENT_DYNAMIC(CNumericGridControl, CListCtrl)
+
+CNumericGridControl::CNumericGridControl()
+{
+	m_nEditRow = 0;
+	m_nEditColumn = 0;
+}
+
+CNumericGridControl::~CNumericGridControl()
+{
+}
+
+BEGIN_MESSAGE_MAP(CNumericGridControl, CListCtrl)
+	ON_NOTIFY_REFLECT(LVN_GETDISPINFO, OnGetDispInfo)
+	ON_NOTIFY_REFLECT(LVN_ODCACHEHINT, OnCacheHint)
+	ON_NOTIFY_REFLECT(NM_DBLCLK, OnDblClk)
+	ON_WM_VSCROLL()
+	ON_WM_HSCROLL()
+	ON_WM_MOUSEWHEEL()
+	ON_WM_SIZE()
+	ON_MESSAGE(WM_ENDEDIT, OnEndEdit)
+END_MESSAGE_MAP()
+
+//Init control
+void CNumericGridControl::PreSubclassWindow()
+{
+	CListCtrl::PreSubclassWindow();
+
+	//Cells are supplied on demand, so the list must be a virtual report view
+	ASSERT((GetStyle() & LVS_OWNERDATA) && (GetStyle() & LVS_TYPEMASK) == LVS_REPORT);
+	SetExtendedStyle(GetExtendedStyle() | LVS_EX_FULLROWSELECT | LVS_EX_GRIDLINES | LVS_EX_DOUBLEBUFFER);
+}
+
+void CNumericGridControl::SetGridSize(size_t nRows, size_t nColumns, EDisplayMode mode)
+{
+	EndEdit(false);
+	m_model.Resize(nRows, nColumns, static_cast<numeric_radix::DisplayMode>(mode));
+	m_model.SetVisibleRows(GetCountPerPage() + 1);
+	SetItemCountEx(static_cast<int>(nRows), 0);
+}
+
+void CNumericGridControl::SetValue(size_t nRow, size_t nColumn, LONGLONG llValue)
+{
+	if (llValue >= 0)
+		m_model.SetValue(nRow, nColumn, (ULONGLONG)llValue);
+
+	else
+		m_model.SetEmpty(nRow, nColumn);
+
+	RedrawItems(static_cast<int>(nRow), static_cast<int>(nRow));
+}
+
+LONGLONG CNumericGridControl::GetValue(size_t nRow, size_t nColumn) const
+{
+	if (m_model.IsEmpty(nRow, nColumn))
+		return VALUEINVALID;
+
+	return (LONGLONG)m_model.GetValue(nRow, nColumn);
+}
+
+void CNumericGridControl::SetCellMode(size_t nRow, size_t nColumn, EDisplayMode mode)
+{
+	m_model.SetMode(nRow, nColumn, static_cast<numeric_radix::DisplayMode>(mode));
+	RedrawItems(static_cast<int>(nRow), static_cast<int>(nRow));
+}
+
+void CNumericGridControl::SetColumnMode(size_t nColumn, EDisplayMode mode)
+{
+	m_model.SetColumnMode(nColumn, static_cast<numeric_radix::DisplayMode>(mode));
+	Invalidate(false);
+}
+
+CNumericGridControl::EDisplayMode CNumericGridControl::GetCellMode(size_t nRow, size_t nColumn) const
+{
+	return static_cast<EDisplayMode>(m_model.GetMode(nRow, nColumn));
+}
+
+//Supply cell text straight from the model's cache rather than copying it
+void CNumericGridControl::OnGetDispInfo(NMHDR* pNMHDR, LRESULT* pResult)
+{
+	LVITEM& item = reinterpret_cast<NMLVDISPINFO*>(pNMHDR)->item;
+	if ((item.mask & LVIF_TEXT) && item.iItem >= 0 && (size_t)item.iItem < m_model.Rows() && (size_t)item.iSubItem < m_model.Columns())
+		item.pszText = const_cast<LPWSTR>(m_model.GetText(item.iItem, item.iSubItem).data());
+
+	*pResult = 0;
+}
+
+//The list reports the rows it is about to draw; make the cache at least that large
+void CNumericGridControl::OnCacheHint(NMHDR* pNMHDR, LRESULT* pResult)
+{
+	NMLVCACHEHINT* pHint = reinterpret_cast<NMLVCACHEHINT*>(pNMHDR);
+	m_model.SetVisibleRows(static_cast<size_t>(pHint->iTo - pHint->iFrom + 1));
+	*pResult = 0;
+}
+
+void CNumericGridControl::OnDblClk(NMHDR* pNMHDR, LRESULT* pResult)
+{
+	NMITEMACTIVATE* pActivate = reinterpret_cast<NMITEMACTIVATE*>(pNMHDR);
+	if (pActivate->iItem >= 0 && pActivate->iSubItem >= 0)
+		BeginEdit(pActivate->iItem, pActivate->iSubItem);
+
+	*pResult = 0;
+}
+
+//Edit a cell in place with a CNumericEditControl in the cell's display mode
+void CNumericGridControl::BeginEdit(size_t nRow, size_t nColumn)
+{
+	EndEdit(true);
+	if (nRow >= m_model.Rows() || nColumn >= m_model.Columns())
+		return;
+
+	EnsureVisible(static_cast<int>(nRow), false);
+
+	CRect rect;
+	if (!GetSubItemRect(static_cast<int>(nRow), static_cast<int>(nColumn), LVIR_LABEL, rect))
+		return;
+
+	m_pEditor = std::make_unique<CNumericGridEditor>(GetCellMode(nRow, nColumn));
+	if (!m_pEditor->Create(WS_CHILD | WS_BORDER | ES_AUTOHSCROLL, rect, this, IDC_GRIDEDITOR))
+	{
+		m_pEditor.reset();
+		return;
+	}
+
+	m_nEditRow = nRow;
+	m_nEditColumn = nColumn;
+
+	//Start from the displayed text so values above LLONG_MAX are kept
+	m_pEditor->SetFont(GetFont());
+	m_pEditor->SetWindowText(m_model.GetText(nRow, nColumn).data());
+	m_pEditor->SetSel(0, -1);
+	m_pEditor->ShowWindow(SW_SHOW);
+	m_pEditor->SetFocus();
+}
+
+//Finish editing, storing the editor's text in the cell if bCommit is set and the text is valid
+void CNumericGridControl::EndEdit(BOOL bCommit)
+{
+	if (!m_pEditor)
+		return;
+
+	//Release the editor first: destroying it moves focus, which would end the edit again
+	std::unique_ptr<CNumericGridEditor> pEditor = std::move(m_pEditor);
+	if (bCommit && m_nEditRow < m_model.Rows() && m_nEditColumn < m_model.Columns())
+	{
+		CString sText;
+		pEditor->GetWindowText(sText);
+		if (m_model.SetText(m_nEditRow, m_nEditColumn, std::wstring_view(sText.GetString(), sText.GetLength())))
+			RedrawItems(static_cast<int>(m_nEditRow), static_cast<int>(m_nEditRow));
+	}
+
+	pEditor->DestroyWindow();
+}
+
+LRESULT CNumericGridControl::OnEndEdit(WPARAM wParam, LPARAM lParam)
+{
+	if (!m_pEditor || (HWND)lParam != m_pEditor->GetSafeHwnd())
+		return 0;
+
+	BOOL bHadFocus = ::GetFocus() == m_pEditor->GetSafeHwnd();
+	EndEdit(static_cast<BOOL>(wParam));
+	if (bHadFocus)
+		SetFocus();
+
+	return 0;
+}
+
+//The editor does not follow its cell, so scrolling or resizing ends the edit
+void CNumericGridControl::OnVScroll(UINT nSBCode, UINT nPos, CScrollBar* pScrollBar)
+{
+	EndEdit(true);
+	CListCtrl::OnVScroll(nSBCode, nPos, pScrollBar);
+}
+
+void CNumericGridControl::OnHScroll(UINT nSBCode, UINT nPos, CScrollBar* pScrollBar)
+{
+	EndEdit(true);
+	CListCtrl::OnHScroll(nSBCode, nPos, pScrollBar);
+}
+
+BOOL CNumericGridControl::OnMouseWheel(UINT nFlags, short zDelta, CPoint pt)
+{
+	EndEdit(true);
+	return CListCtrl::OnMouseWheel(nFlags, zDelta, pt);
+}
+
+void CNumericGridControl::OnSize(UINT nType, int cx, int cy)
+{
+	EndEdit(true);
+	CListCtrl::OnSize(nType, cx, cy);
+	m_model.SetVisibleRows(GetCountPerPage() + 1);
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+/*
+	CNumericGridControl.h
+
+	Virtual list control for displaying and editing large grids of numeric fields (register
+	views, memory dumps) without one CNumericEditControl window per field. Values and display
+	modes are held in a numeric_radix::GridModel (see NumericRadixGrid.h) and only the visible
+	rows are formatted, on demand, with the same rules as CNumericEditControl::UpdateControl().
+	Double-clicking a cell edits it in place with a single CNumericEditControl.
+
+	See CNumericGridControl.cpp for usage instructions
+
+	MIT License for CNumericEditControl:
+
+	Copyright (c) 2019-2020 Data Synergy UK Ltd
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#pragma once
+
+#include <memory>
+
+#include "CNumericEditControl.h"
+#include "NumericRadixGrid.h"
+
+// CNumericGridEditor
+
+//In-place cell editor: a CNumericEditControl that ends editing on Enter (commit), Escape
+//(cancel) or loss of focus (commit)
+class CNumericGridEditor : public CNumericEditControl
+{
+public:
+	CNumericGridEditor(EDisplayMode mode);
+
+protected:
+	BOOL m_bEnding;
+
+	void EndEdit(BOOL bCommit);
+	afx_msg UINT OnGetDlgCode();
+	afx_msg void OnChar(UINT nChar, UINT nRepCnt, UINT nFlags);
+	afx_msg void OnKillFocus(CWnd* pNewWnd);
+
+	DECLARE_MESSAGE_MAP()
+};
+
+// CNumericGridControl
+
+class CNumericGridControl : public CListCtrl
+{
+	DECLARE_DYNAMIC(CNumericGridControl)
+
+public:
+	using EDisplayMode = CNumericEditControl::EDisplayMode;
+	static constexpr auto VALUEINVALID = CNumericEditControl::VALUEINVALID;
+
+	CNumericGridControl();
+	virtual ~CNumericGridControl();
+
+	//Resize the grid to empty cells. The list columns (headings and widths) are inserted with
+	//InsertColumn() as normal
+	void SetGridSize(size_t nRows, size_t nColumns, EDisplayMode mode = EDisplayMode::DISPLAY_DEC);
+
+	//Negative values empty the cell and empty cells return VALUEINVALID, as CNumericEditControl
+	void SetValue(size_t nRow, size_t nColumn, LONGLONG llValue);
+	LONGLONG GetValue(size_t nRow, size_t nColumn) const;
+
+	void SetCellMode(size_t nRow, size_t nColumn, EDisplayMode mode);
+	void SetColumnMode(size_t nColumn, EDisplayMode mode);
+	EDisplayMode GetCellMode(size_t nRow, size_t nColumn) const;
+
+	//Direct access for bulk updates; call Invalidate() on the control afterwards
+	numeric_radix::GridModel<WCHAR>& GetModel() { return m_model; }
+
+	void BeginEdit(size_t nRow, size_t nColumn);
+	void EndEdit(BOOL bCommit);
+
+private:
+	numeric_radix::GridModel<WCHAR> m_model;
+	std::unique_ptr<CNumericGridEditor> m_pEditor;
+	size_t m_nEditRow;
+	size_t m_nEditColumn;
+
+	afx_msg void OnGetDispInfo(NMHDR* pNMHDR, LRESULT* pResult);
+	afx_msg void OnCacheHint(NMHDR* pNMHDR, LRESULT* pResult);
+	afx_msg void OnDblClk(NMHDR* pNMHDR, LRESULT* pResult);
+	afx_msg void OnVScroll(UINT nSBCode, UINT nPos, CScrollBar* pScrollBar);
+	afx_msg void OnHScroll(UINT nSBCode, UINT nPos, CScrollBar* pScrollBar);
+	afx_msg BOOL OnMouseWheel(UINT nFlags, short zDelta, CPoint pt);
+	afx_msg void OnSize(UINT nType, int cx, int cy);
+	afx_msg LRESULT OnEndEdit(WPARAM wParam, LPARAM lParam);
+
+protected:
+	DECLARE_MESSAGE_MAP()
+	virtual void PreSubclassWindow();
+};
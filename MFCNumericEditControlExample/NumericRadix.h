@@ -0,0 +1,806 @@
+#pragma once
+
+/*
+	NumericRadix.h
+
+	Portable, header-only radix parse/format engine used by CNumericEditControl. The engine has
+	no MFC or Windows dependencies, works on caller-provided string views and buffers and never
+	allocates, so the same conversions can be compiled with MSVC, GCC or Clang and run headless.
+	Every function is templated on the character type: char (ASCII or UTF-8), char8_t, wchar_t,
+	char16_t and char32_t. The control uses the UTF-16 (WCHAR) instantiation; 8-bit text is parsed
+	natively rather than widened first, and 8- and 16-bit text reaches the SIMD kernels a lane at
+	a time.
+
+	Parsing follows the semantics the control has always applied to user input: commas and spaces
+	are ignored anywhere in the text, the remainder must be a complete wcstoull() number in the
+	requested radix (leading white space, optional sign, optional "0x" prefix in hex mode) and
+	values that overflow 64 bits are rejected. A NUL character terminates the input.
+
+	Formatting produces the control's display format: decimal is unprefixed, hex is lower case
+	with a "0x" prefix, octal has a leading "0" and binary is unprefixed.
+
+	MIT License for CNumericEditControl:
+
+	Copyright (c) 2019-2020 Data Synergy UK Ltd
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "NumericRadixSimd.h"
+
+namespace numeric_radix
+{
+	//Buffer size (including terminator) sufficient for any formatted value: 64 binary digits
+	constexpr size_t FORMAT_BUFFER_SIZE = 65;
+
+	//Digit value returned for characters that are not digits in any radix
+	constexpr unsigned int NOT_A_DIGIT = 0xFF;
+
+	//Commas and spaces are ignored (common input from Windows Calculator application)
+	template <typename CharT>
+	constexpr bool IsSeparator(CharT ch) noexcept
+	{
+		return ch == CharT(',') || ch == CharT(' ');
+	}
+
+	//White space skipped before the number, as wcstoull() does
+	template <typename CharT>
+	constexpr bool IsSpace(CharT ch) noexcept
+	{
+		return ch == CharT(' ') || (ch >= CharT('\t') && ch <= CharT('\r'));
+	}
+
+	//Value of a digit in radix 36, or NOT_A_DIGIT
+	template <typename CharT>
+	constexpr unsigned int DigitValue(CharT ch) noexcept
+	{
+		if (ch >= CharT('0') && ch <= CharT('9'))
+			return static_cast<unsigned int>(ch - CharT('0'));
+
+		else if (ch >= CharT('a') && ch <= CharT('z'))
+			return static_cast<unsigned int>(ch - CharT('a')) + 10;
+
+		else if (ch >= CharT('A') && ch <= CharT('Z'))
+			return static_cast<unsigned int>(ch - CharT('A')) + 10;
+
+		return NOT_A_DIGIT;
+	}
+
+	namespace detail
+	{
+		//Forward-only reader over the input that skips separators. Reading past the end, or
+		//reaching a NUL character, yields 0.
+		template <typename CharT>
+		struct Cursor
+		{
+			const CharT* p;
+			const CharT* end;
+
+			constexpr CharT Peek() noexcept
+			{
+				while (p != end && IsSeparator(*p))
+					++p;
+
+				return p != end ? *p : CharT(0);
+			}
+
+			constexpr void Advance() noexcept
+			{
+				++p;
+			}
+		};
+
+		constexpr bool IsSupportedRadix(unsigned int radix) noexcept
+		{
+			return radix == 2 || radix == 8 || radix == 10 || radix == 16;
+		}
+
+		//Number of digits needed to write value in the given radix
+		constexpr size_t CountDigits(uint64_t value, unsigned int radix) noexcept
+		{
+			size_t nDigits = 1;
+			while (value >= radix)
+			{
+				value /= radix;
+				++nDigits;
+			}
+
+			return nDigits;
+		}
+
+		//Number of significant bits (0 for zero)
+		constexpr unsigned int BitLength(uint64_t value) noexcept
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return value ? 64 - static_cast<unsigned int>(__builtin_clzll(value)) : 0;
+#else
+			unsigned int nBits = 0;
+			for (unsigned int nShift = 32; nShift; nShift /= 2)
+			{
+				if (value >> nShift)
+				{
+					value >>= nShift;
+					nBits += nShift;
+				}
+			}
+
+			return nBits + static_cast<unsigned int>(value);
+#endif
+		}
+
+		constexpr uint64_t POW10[20] =
+		{
+			1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+			10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull, 1000000000000000ull,
+			10000000000000000ull, 100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull,
+		};
+
+		//Number of digits format() writes for value, from its bit length. For decimal,
+		//floor(bits * log10(2)) (1233 / 4096) is the digit count of the smallest value with that bit
+		//length, less one, so one comparison with a power of ten decides between the two candidates
+		template <unsigned int Radix>
+		constexpr size_t FormattedDigits(uint64_t value) noexcept
+		{
+			unsigned int nBits = BitLength(value);
+			if (Radix == 10)
+			{
+				unsigned int nLog = nBits * 1233 >> 12;
+				size_t nDigits = nLog + (value >= POW10[nLog]);
+				return nDigits ? nDigits : 1;
+			}
+
+			constexpr unsigned int nDigitBits = Radix == 16 ? 4 : (Radix == 8 ? 3 : 1);
+			return nBits ? (nBits + nDigitBits - 1) / nDigitBits : 1;
+		}
+
+		//Digit tables for format(): decimal and octal digit pairs (for 0-99 and each 6-bit group),
+		//hex digit pairs for each byte and 8 binary digits for each byte
+		template <size_t Count, size_t Digits, unsigned int Radix>
+		constexpr std::array<char, Count * Digits> MakeDigitTable() noexcept
+		{
+			std::array<char, Count * Digits> table = {};
+			for (size_t i = 0; i < Count; ++i)
+			{
+				size_t value = i;
+				for (size_t nDigit = Digits; nDigit--; value /= Radix)
+					table[i * Digits + nDigit] = "0123456789abcdef"[value % Radix];
+			}
+
+			return table;
+		}
+
+		constexpr std::array<char, 200> DECIMAL_PAIRS = MakeDigitTable<100, 2, 10>();
+		constexpr std::array<char, 512> HEX_PAIRS = MakeDigitTable<256, 2, 16>();
+		constexpr std::array<char, 128> OCTAL_PAIRS = MakeDigitTable<64, 2, 8>();
+		constexpr std::array<char, 2048> BINARY_OCTETS = MakeDigitTable<256, 8, 2>();
+
+		//Write the nDigits digits of value ending at pEnd, least significant first, a table entry
+		//at a time
+		template <unsigned int Radix, typename CharT>
+		constexpr void WriteDigits(uint64_t value, CharT* pEnd, size_t nDigits) noexcept
+		{
+			if (Radix == 10)
+			{
+				while (nDigits >= 2)
+				{
+					size_t nPair = static_cast<size_t>(value % 100) * 2;
+					value /= 100;
+					*--pEnd = CharT(DECIMAL_PAIRS[nPair + 1]);
+					*--pEnd = CharT(DECIMAL_PAIRS[nPair]);
+					nDigits -= 2;
+				}
+			}
+			else if (Radix == 16 || Radix == 8)
+			{
+				constexpr unsigned int nGroupBits = Radix == 16 ? 8 : 6;
+				const char* pPairs = Radix == 16 ? HEX_PAIRS.data() : OCTAL_PAIRS.data();
+				while (nDigits >= 2)
+				{
+					size_t nPair = static_cast<size_t>(value & ((1u << nGroupBits) - 1)) * 2;
+					value >>= nGroupBits;
+					*--pEnd = CharT(pPairs[nPair + 1]);
+					*--pEnd = CharT(pPairs[nPair]);
+					nDigits -= 2;
+				}
+			}
+			else
+			{
+				while (nDigits >= 8)
+				{
+					const char* pOctet = BINARY_OCTETS.data() + static_cast<size_t>(value & 0xFF) * 8;
+					value >>= 8;
+					pEnd -= 8;
+					for (size_t i = 0; i < 8; ++i)
+						pEnd[i] = CharT(pOctet[i]);
+
+					nDigits -= 8;
+				}
+
+				while (nDigits--)
+				{
+					*--pEnd = CharT('0' + (value & 1));
+					value >>= 1;
+				}
+			}
+
+			//Odd leading digit
+			if (Radix != 2 && nDigits)
+				*--pEnd = CharT("0123456789abcdef"[value]);
+		}
+
+		//ASCII characters that may be typed in a display mode: the radix digits, plus 'x' and
+		//'X' in hex for the "0x" prefix
+		constexpr std::array<bool, 128> MakeAllowedTable(unsigned int radix) noexcept
+		{
+			std::array<bool, 128> table = {};
+			for (unsigned int ch = 0; ch < table.size(); ++ch)
+				table[ch] = DigitValue(static_cast<char>(ch)) < radix || (radix == 16 && (ch == 'x' || ch == 'X'));
+
+			return table;
+		}
+
+		//Number of digits the SIMD kernels convert without overflow checks (0: no kernel)
+		template <unsigned int Radix>
+		constexpr size_t SIMD_MAX_DIGITS = Radix == 16 ? 16 : (Radix == 10 ? 19 : (Radix == 2 ? 64 : 0));
+
+		//Strip the "0x" prefix from a block of ASCII characters and convert the digits with a SIMD
+		//kernel. Returns false if any character is not a digit
+		template <unsigned int Radix>
+		inline bool ConvertSimd(const uint8_t* pChars, size_t nChars, uint64_t& value) noexcept
+		{
+			if (Radix == 16 && nChars > 2 && pChars[0] == '0' && (pChars[1] | 0x20) == 'x')
+			{
+				pChars += 2;
+				nChars -= 2;
+			}
+
+			if (Radix == 16)
+				return simd::ConvertHex(pChars, nChars, value);
+
+			else if (Radix == 10)
+				return simd::ConvertDecimal(pChars, nChars, value);
+
+			return simd::ConvertBinary(pChars, nChars, value);
+		}
+
+		//Fast path for plain numbers. 8- and 16-bit text is copied or narrowed into a byte block a
+		//lane at a time, and only text with separators or a NUL is then compacted one byte at a
+		//time; wider and longer text has its separators stripped while it is narrowed one character
+		//at a time. The "0x" prefix is removed and the remaining digits are validated and converted
+		//by a SIMD kernel. A NUL ends the text. Returns false if the text needs the full scalar
+		//parser (white space, sign, too many digits or any invalid character).
+		template <unsigned int Radix, typename CharT>
+		inline bool ParseSimd(std::basic_string_view<CharT> text, uint64_t& value) noexcept
+		{
+			constexpr size_t nMaxChars = SIMD_MAX_DIGITS<Radix> + (Radix == 16 ? 2 : 0);
+			using UCharT = std::make_unsigned_t<CharT>;
+
+			//Room for a separator after every digit
+			constexpr size_t nMaxText = 2 * nMaxChars;
+			if constexpr (sizeof(CharT) <= 2)
+			{
+				if (text.size() <= nMaxText)
+				{
+					alignas(16) uint8_t chars[(nMaxText + 15) / 16 * 16];
+					size_t nChars = text.size();
+					if constexpr (sizeof(CharT) == 1)
+					{
+						if (nChars)
+							memcpy(chars, text.data(), nChars);
+					}
+					else
+						simd::NarrowChars(reinterpret_cast<const uint16_t*>(text.data()), nChars, chars);
+
+					//The kernels only read the text, but zero the rest of its last lane so that no
+					//path can see uninitialized bytes
+					memset(chars + nChars, 0, (0 - nChars) & 15);
+
+					//Characters above 0x7F were narrowed to bytes that the kernels reject
+					if (simd::HasSeparators(chars, nChars))
+					{
+						size_t nLength = nChars;
+						nChars = 0;
+						for (size_t i = 0; i < nLength && chars[i]; ++i)
+						{
+							if (!IsSeparator(chars[i]))
+								chars[nChars++] = chars[i];
+						}
+					}
+
+					return nChars <= nMaxChars && ConvertSimd<Radix>(chars, nChars, value);
+				}
+			}
+
+			uint8_t block[nMaxChars];
+			size_t nChars = 0;
+			for (CharT ch : text)
+			{
+				if (ch == CharT(0))
+					break;
+
+				if (IsSeparator(ch))
+					continue;
+
+				if (nChars == nMaxChars || static_cast<UCharT>(ch) > 0x7F)
+					return false;
+
+				block[nChars++] = static_cast<uint8_t>(ch);
+			}
+
+			return ConvertSimd<Radix>(block, nChars, value);
+		}
+	}
+
+	//Parse a complete number in the given radix. The text ends at the end of the view or at the
+	//first NUL, whichever comes first. Returns false if the text is not a valid number or the value
+	//does not fit in 64 bits, in which case value is left unchanged. The text is read once, front to
+	//back, and reading stops at the first invalid character or digit that overflows.
+	template <unsigned int Radix, typename CharT>
+	constexpr bool parse(std::basic_string_view<CharT> text, uint64_t& value) noexcept
+	{
+		static_assert(detail::IsSupportedRadix(Radix), "Radix must be 2, 8, 10 or 16");
+
+#ifdef NUMERIC_RADIX_SSE2
+		if constexpr (detail::SIMD_MAX_DIGITS<Radix> != 0)
+		{
+			if (!NUMERIC_RADIX_IS_CONSTANT_EVALUATED() && detail::ParseSimd<Radix>(text, value))
+				return true;
+		}
+#endif
+
+		detail::Cursor<CharT> cursor{ text.data(), text.data() + text.size() };
+		CharT ch = cursor.Peek();
+
+		//Leading white space
+		while (IsSpace(ch))
+		{
+			cursor.Advance();
+			ch = cursor.Peek();
+		}
+
+		//Optional sign. As with wcstoull(), a negative value is returned in two's complement
+		bool bNegative = false;
+		if (ch == CharT('+') || ch == CharT('-'))
+		{
+			bNegative = (ch == CharT('-'));
+			cursor.Advance();
+			ch = cursor.Peek();
+		}
+
+		//Optional "0x" prefix in hex, only when followed by a hex digit
+		if (Radix == 16 && ch == CharT('0'))
+		{
+			detail::Cursor<CharT> lookahead = cursor;
+			lookahead.Advance();
+
+			CharT chX = lookahead.Peek();
+			if (chX == CharT('x') || chX == CharT('X'))
+			{
+				lookahead.Advance();
+				if (DigitValue(lookahead.Peek()) < 16)
+				{
+					cursor = lookahead;
+					ch = cursor.Peek();
+				}
+			}
+		}
+
+		//Digits. The value is out of range as soon as one overflows, whatever follows
+		uint64_t ullValue = 0;
+		bool bDigits = false;
+		for (unsigned int nDigit = DigitValue(ch); nDigit < Radix; nDigit = DigitValue(ch))
+		{
+			if (ullValue > (UINT64_MAX - nDigit) / Radix)
+				return false;
+
+			ullValue = ullValue * Radix + nDigit;
+			bDigits = true;
+			cursor.Advance();
+			ch = cursor.Peek();
+		}
+
+		//Not a valid number or additional characters after numeric
+		if (!bDigits || ch != CharT(0))
+			return false;
+
+		value = bNegative ? 0 - ullValue : ullValue;
+		return true;
+	}
+
+	//Format a value in the control's display format for the given radix. Returns the number of
+	//characters written excluding the terminator, or 0 if the buffer is too small. The exact
+	//length is known before anything is written, so the digits are written once, in place.
+	template <unsigned int Radix, typename CharT>
+	constexpr size_t format(uint64_t value, CharT* buffer, size_t bufferSize) noexcept
+	{
+		static_assert(detail::IsSupportedRadix(Radix), "Radix must be 2, 8, 10 or 16");
+
+		constexpr size_t nPrefixLength = Radix == 16 ? 2 : (Radix == 8 ? 1 : 0);
+
+		size_t nDigits = detail::FormattedDigits<Radix>(value);
+		size_t nLength = nPrefixLength + nDigits;
+		if (nLength >= bufferSize)
+			return 0;
+
+		if (Radix == 16)
+		{
+			buffer[0] = CharT('0');
+			buffer[1] = CharT('x');
+		}
+		else if (Radix == 8)
+			buffer[0] = CharT('0');
+
+		buffer[nLength] = CharT(0);
+		detail::WriteDigits<Radix>(value, buffer + nLength, nDigits);
+		return nLength;
+	}
+
+	//Value-returning parse, usable in constant expressions: static_assert(parse<16>("0xFF") == 255)
+	template <unsigned int Radix, typename CharT>
+	constexpr std::optional<uint64_t> parse(std::basic_string_view<CharT> text) noexcept
+	{
+		uint64_t value = 0;
+		if (!parse<Radix>(text, value))
+			return std::nullopt;
+
+		return value;
+	}
+
+	template <unsigned int Radix, typename CharT>
+	constexpr std::optional<uint64_t> parse(const CharT* pszText) noexcept
+	{
+		return parse<Radix>(std::basic_string_view<CharT>(pszText));
+	}
+
+	//Compile-time description of a display radix. Code that knows its radix at compile time uses
+	//these members directly; code that selects it at runtime switches once into the matching
+	//instantiation (see the dispatch functions below).
+	template <unsigned int N>
+	struct Radix
+	{
+		static_assert(detail::IsSupportedRadix(N), "Radix must be 2, 8, 10 or 16");
+
+		static constexpr unsigned int VALUE = N;
+
+		//Digits in the largest 64-bit value
+		static constexpr size_t MAX_DIGITS = detail::CountDigits(UINT64_MAX, N);
+
+		//Display prefix: "0x" for hex, "0" for octal
+		static constexpr size_t PREFIX_LENGTH = N == 16 ? 2 : (N == 8 ? 1 : 0);
+
+		//Longest formatted value excluding the terminator
+		static constexpr size_t MAX_FORMAT_LENGTH = PREFIX_LENGTH + MAX_DIGITS;
+
+		//Characters accepted from the keyboard in this mode
+		static constexpr std::array<bool, 128> ALLOWED = detail::MakeAllowedTable(N);
+
+		template <typename CharT>
+		static constexpr bool IsAllowed(CharT ch) noexcept
+		{
+			auto uch = static_cast<std::make_unsigned_t<CharT>>(ch);
+			return uch < ALLOWED.size() && ALLOWED[uch];
+		}
+
+		template <typename CharT>
+		static constexpr bool parse(std::basic_string_view<CharT> text, uint64_t& value) noexcept
+		{
+			return numeric_radix::parse<N>(text, value);
+		}
+
+		template <typename CharT>
+		static constexpr size_t format(uint64_t value, CharT* buffer, size_t bufferSize) noexcept
+		{
+			return numeric_radix::format<N>(value, buffer, bufferSize);
+		}
+	};
+
+	static_assert(Radix<2>::MAX_FORMAT_LENGTH + 1 == FORMAT_BUFFER_SIZE, "FORMAT_BUFFER_SIZE must hold 64 binary digits");
+	static_assert(Radix<16>::MAX_DIGITS == 16 && Radix<10>::MAX_DIGITS == 20 && Radix<8>::MAX_DIGITS == 22, "Unexpected digit counts");
+	static_assert(parse<16>("0xFF") == 255 && parse<8>("0377") == 255 && parse<2>("1,111,1111") == 255, "Compile-time parse");
+	static_assert(!parse<10>("18446744073709551616") && !parse<16>("0x"), "Compile-time parse must reject invalid input");
+
+	//Number of digits in the largest value of the given bit width
+	constexpr size_t MaxDigits(unsigned int radix, size_t bits) noexcept
+	{
+		switch (radix)
+		{
+			case 2:		return bits;
+			case 8:		return (bits + 2) / 3;
+			case 16:	return (bits + 3) / 4;
+			default:	return bits * 30103 / 100000 + 1;	//floor(bits * log10(2)) + 1, exact up to 8192 bits
+		}
+	}
+
+	//Edit state a keystroke is checked against. All of it can be read from an edit control in O(1)
+	//without copying the text: the length, the selection replaced by the typed character (start
+	//equal to end for a plain caret) and the first two characters (0 if absent)
+	template <typename CharT>
+	struct KeystrokeContext
+	{
+		size_t length = 0;
+		size_t selStart = 0;
+		size_t selEnd = 0;
+		CharT first = 0;
+		CharT second = 0;
+	};
+
+	//Context for typing at the end of text
+	template <typename CharT>
+	constexpr KeystrokeContext<CharT> MakeKeystrokeContext(std::basic_string_view<CharT> text) noexcept
+	{
+		KeystrokeContext<CharT> context;
+		context.length = context.selStart = context.selEnd = text.size();
+		context.first = text.size() > 0 ? text[0] : CharT(0);
+		context.second = text.size() > 1 ? text[1] : CharT(0);
+		return context;
+	}
+
+	namespace detail
+	{
+		template <typename CharT>
+		constexpr uint32_t CharCode(CharT ch) noexcept
+		{
+			return static_cast<uint32_t>(static_cast<std::make_unsigned_t<CharT>>(ch));
+		}
+
+		constexpr bool IsX(uint32_t ch) noexcept
+		{
+			return ch == 'x' || ch == 'X';
+		}
+	}
+
+	//Keystroke filter applied by CNumericEditControl::OnChar(). The prefix state of the text after
+	//the keystroke (empty, "0", "0x" or digits) is derived from the context, so each check is O(1).
+	//The characters of Radix<N>::ALLOWED are permitted except:
+	//
+	//	- 0 as the leading character in decimal (to avoid confusion with octal)
+	//	- 0 typed directly before or after a leading 0 in hex and octal (to force the "0x" and
+	//	  leading 0 formats)
+	//	- x/X anywhere but directly after a leading 0 in hex. The original control accepted x/X as
+	//	  the second character after any first character, which could only make invalid text
+	//	- a digit that would take the text beyond maxDigits digits, excluding the prefix. Every
+	//	  character counts, so callers discount separators (see MakeDigitContext()) or check the
+	//	  value itself near the limit (see IsEditKeystrokeInRange())
+	template <unsigned int Radix, typename CharT, typename KeyT>
+	constexpr bool IsKeystrokeAllowed(const KeystrokeContext<CharT>& context, KeyT ch,
+		size_t maxDigits = numeric_radix::Radix<Radix>::MAX_DIGITS) noexcept
+	{
+		if (!numeric_radix::Radix<Radix>::IsAllowed(ch))
+			return false;
+
+		//The typed character replaces the selection
+		size_t nEnd = context.selEnd < context.length ? context.selEnd : context.length;
+		size_t nStart = context.selStart < nEnd ? context.selStart : nEnd;
+		size_t nNewLength = context.length - (nEnd - nStart) + 1;
+		uint32_t chKey = detail::CharCode(ch);
+
+		//Character at index i after the keystroke: 0 past the end, and NOT_A_DIGIT where it comes
+		//from beyond the first two characters. Those are never prefix characters, so only a
+		//selection from the start that is replaced by 0 can miss an unknown 0 following it
+		auto after = [&](size_t i) -> uint32_t
+		{
+			if (i == nStart)
+				return chKey;
+
+			size_t nOriginal = i < nStart ? i : nEnd + (i - nStart - 1);
+			if (nOriginal >= context.length)
+				return 0;
+
+			return nOriginal == 0 ? detail::CharCode(context.first) : (nOriginal == 1 ? detail::CharCode(context.second) : NOT_A_DIGIT);
+		};
+
+		if (detail::IsX(chKey))
+			return nStart == 1 && after(0) == '0' && !detail::IsX(after(2));
+
+		if (chKey == '0' && nStart <= 1)
+		{
+			if (Radix == 10 && nStart == 0)
+				return false;
+
+			if ((Radix == 16 || Radix == 8) && after(0) == '0' && after(1) == '0')
+				return false;
+		}
+
+		size_t nPrefixLength = 0;
+		if (Radix == 16 && after(0) == '0' && detail::IsX(after(1)))
+			nPrefixLength = 2;
+
+		else if (Radix == 8 && after(0) == '0')
+			nPrefixLength = 1;
+
+		return nNewLength - nPrefixLength <= maxDigits;
+	}
+
+	//Keystroke typed at the end of text
+	template <unsigned int Radix, typename CharT, typename KeyT>
+	constexpr bool IsKeystrokeAllowed(std::basic_string_view<CharT> text, KeyT ch) noexcept
+	{
+		return IsKeystrokeAllowed<Radix>(MakeKeystrokeContext(text), ch);
+	}
+
+	//Runtime radix dispatch. Unsupported radices fail to parse and format as nothing
+	template <typename CharT>
+	constexpr bool parse(unsigned int radix, std::basic_string_view<CharT> text, uint64_t& value) noexcept
+	{
+		switch (radix)
+		{
+			case 2:		return parse<2>(text, value);
+			case 8:		return parse<8>(text, value);
+			case 10:	return parse<10>(text, value);
+			case 16:	return parse<16>(text, value);
+			default:	return false;
+		}
+	}
+
+	//Parse a NUL-terminated buffer in place, e.g. the locked CF_UNICODETEXT memory of a paste.
+	//capacity bounds the read if the terminator is missing; the text is neither measured nor
+	//copied, so the cost depends on where parsing stops rather than on the size of the buffer.
+	template <typename CharT>
+	constexpr bool parse_buffer(unsigned int radix, const CharT* buffer, size_t capacity, uint64_t& value) noexcept
+	{
+		return parse(radix, std::basic_string_view<CharT>(buffer, buffer ? capacity : 0), value);
+	}
+
+	template <typename CharT>
+	constexpr bool IsAllowed(unsigned int radix, CharT ch) noexcept
+	{
+		switch (radix)
+		{
+			case 2:		return Radix<2>::IsAllowed(ch);
+			case 8:		return Radix<8>::IsAllowed(ch);
+			case 10:	return Radix<10>::IsAllowed(ch);
+			case 16:	return Radix<16>::IsAllowed(ch);
+			default:	return false;
+		}
+	}
+
+	template <typename CharT, typename KeyT>
+	constexpr bool IsKeystrokeAllowed(unsigned int radix, const KeystrokeContext<CharT>& context, KeyT ch, size_t maxDigits) noexcept
+	{
+		switch (radix)
+		{
+			case 2:		return IsKeystrokeAllowed<2>(context, ch, maxDigits);
+			case 8:		return IsKeystrokeAllowed<8>(context, ch, maxDigits);
+			case 10:	return IsKeystrokeAllowed<10>(context, ch, maxDigits);
+			case 16:	return IsKeystrokeAllowed<16>(context, ch, maxDigits);
+			default:	return false;
+		}
+	}
+
+	template <typename CharT>
+	constexpr size_t format(unsigned int radix, uint64_t value, CharT* buffer, size_t bufferSize) noexcept
+	{
+		switch (radix)
+		{
+			case 2:		return format<2>(value, buffer, bufferSize);
+			case 8:		return format<8>(value, buffer, bufferSize);
+			case 10:	return format<10>(value, buffer, bufferSize);
+			case 16:	return format<16>(value, buffer, bufferSize);
+			default:	return 0;
+		}
+	}
+
+	//Batch conversion of contiguous arrays in one pass. ValueT is a 64-bit integer: an unsigned
+	//destination holds the parsed bit pattern, a signed destination follows the control's LONGLONG
+	//convention, i.e. parsed values are stored in two's complement and negative values format as
+	//an empty string (as UpdateControl() displays them).
+	//
+	//parse_batch() sets bit (i % 8) of validBits[i / 8] for each element that parsed; invalid
+	//elements are cleared in the bitmap and set to all ones (CNumericEditControl::VALUEINVALID).
+	//validBits may be null. Returns the number of valid elements.
+	template <unsigned int Radix, typename CharT, typename ValueT>
+	inline size_t parse_batch(const std::basic_string_view<CharT>* texts, size_t count, ValueT* values, uint8_t* validBits) noexcept
+	{
+		static_assert(std::is_integral_v<ValueT> && sizeof(ValueT) == sizeof(uint64_t), "ValueT must be a 64-bit integer");
+
+		size_t nValid = 0;
+		for (size_t i = 0; i < count; i += 8)
+		{
+			size_t nBlock = count - i < 8 ? count - i : 8;
+			uint8_t bits = 0;
+			for (size_t j = 0; j < nBlock; ++j)
+			{
+				uint64_t ullValue = UINT64_MAX;
+				bool bValid = parse<Radix>(texts[i + j], ullValue);
+				values[i + j] = static_cast<ValueT>(bValid ? ullValue : UINT64_MAX);
+				bits |= static_cast<uint8_t>(bValid) << j;
+				nValid += bValid;
+			}
+
+			if (validBits)
+				validBits[i / 8] = bits;
+		}
+
+		return nValid;
+	}
+
+	//format_batch() writes element i at buffer + i * stride, terminated, and stores its length in
+	//lengths[i] (lengths may be null). A stride of FORMAT_BUFFER_SIZE fits every value; elements that
+	//do not fit are written as an empty string. Returns the total number of characters written.
+	template <unsigned int Radix, typename CharT, typename ValueT>
+	inline size_t format_batch(const ValueT* values, size_t count, CharT* buffer, size_t stride, size_t* lengths) noexcept
+	{
+		static_assert(std::is_integral_v<ValueT> && sizeof(ValueT) == sizeof(uint64_t), "ValueT must be a 64-bit integer");
+
+		size_t nTotal = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			CharT* pCell = buffer + i * stride;
+			size_t nLength = 0;
+			if (!(std::is_signed_v<ValueT> && values[i] < 0))
+				nLength = format<Radix>(static_cast<uint64_t>(values[i]), pCell, stride);
+
+			if (!nLength && stride)
+				*pCell = CharT(0);
+
+			if (lengths)
+				lengths[i] = nLength;
+
+			nTotal += nLength;
+		}
+
+		return nTotal;
+	}
+
+	template <typename CharT, typename ValueT>
+	inline size_t parse_batch(unsigned int radix, const std::basic_string_view<CharT>* texts, size_t count, ValueT* values, uint8_t* validBits) noexcept
+	{
+		switch (radix)
+		{
+			case 2:		return parse_batch<2>(texts, count, values, validBits);
+			case 8:		return parse_batch<8>(texts, count, values, validBits);
+			case 10:	return parse_batch<10>(texts, count, values, validBits);
+			case 16:	return parse_batch<16>(texts, count, values, validBits);
+			default:	break;
+		}
+
+		//Unsupported radix: every element is invalid
+		for (size_t i = 0; i < count; ++i)
+			values[i] = static_cast<ValueT>(UINT64_MAX);
+
+		if (validBits)
+		{
+			for (size_t i = 0; i < count; i += 8)
+				validBits[i / 8] = 0;
+		}
+
+		return 0;
+	}
+
+	template <typename CharT, typename ValueT>
+	inline size_t format_batch(unsigned int radix, const ValueT* values, size_t count, CharT* buffer, size_t stride, size_t* lengths) noexcept
+	{
+		switch (radix)
+		{
+			case 2:		return format_batch<2>(values, count, buffer, stride, lengths);
+			case 8:		return format_batch<8>(values, count, buffer, stride, lengths);
+			case 10:	return format_batch<10>(values, count, buffer, stride, lengths);
+			case 16:	return format_batch<16>(values, count, buffer, stride, lengths);
+			default:	return 0;
+		}
+	}
+}
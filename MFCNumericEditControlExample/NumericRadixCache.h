@@ -0,0 +1,258 @@
+#pragma once
+
+/*
+	NumericRadixCache.h
+
+	Bounded cache of formatted strings keyed by value and format options (radix plus any caller
+	flags, such as digit grouping), for watch windows where the same values are reformatted
+	each time the user flips display modes. One cache can be shared by every control in the
+	process and by any number of threads.
+
+	The cache is set-associative: a key hashes to a set of WAYS entries, and a miss replaces
+	one of them in CLOCK order (entries hit since the hand last passed are skipped once). Each
+	entry is guarded by its own sequence counter, so lookups never lock or wait: a reader copies
+	the entry and retries as a miss if a writer changed it meanwhile. A writer that finds its
+	victim busy simply does not cache the value. The memory ceiling is fixed at construction.
+
+	MIT License for CNumericEditControl:
+
+	Copyright (c) 2019-2020 Data Synergy UK Ltd
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include <atomic>
+#include <memory>
+
+#include "NumericRadix.h"
+
+namespace numeric_radix
+{
+	struct FormatCacheStats
+	{
+		uint64_t hits;
+		uint64_t misses;
+		uint64_t evictions;
+		size_t entries;
+		size_t bytes;
+	};
+
+	//Options key for a plain format() in a radix; callers add their own flags above bit 8
+	constexpr uint32_t FormatOptions(unsigned int radix, uint32_t flags = 0) noexcept
+	{
+		return (flags << 8) | (radix & 0xFF);
+	}
+
+	template <typename CharT>
+	class FormatCache
+	{
+	public:
+		static constexpr size_t WAYS = 4;
+
+		//Longest cached text; longer results, and text that is not ASCII, are formatted every time
+		static constexpr size_t MAX_LENGTH = FORMAT_BUFFER_SIZE - 1;
+
+		//The largest power-of-two number of sets whose entries fit in maxBytes. Below WAYS entries
+		//the cache is disabled and every call formats
+		explicit FormatCache(size_t maxBytes)
+		{
+			size_t nSets = 0;
+			size_t nMaxSets = maxBytes / (sizeof(Entry) * WAYS + sizeof(std::atomic<uint8_t>));
+			if (nMaxSets)
+			{
+				nSets = 1;
+				while (nSets * 2 <= nMaxSets)
+					nSets *= 2;
+			}
+
+			m_nSetMask = nSets ? nSets - 1 : 0;
+			m_nEntries = nSets * WAYS;
+			if (m_nEntries)
+			{
+				m_pEntries = std::make_unique<Entry[]>(m_nEntries);
+				m_pHands = std::make_unique<std::atomic<uint8_t>[]>(nSets);
+			}
+		}
+
+		FormatCache(const FormatCache&) = delete;
+		FormatCache& operator=(const FormatCache&) = delete;
+
+		//Text for value under options, from the cache or from fnFormat(buffer, capacity), which must
+		//return the length written (0 on failure) and depend only on value and options. The text is
+		//NUL-terminated; returns its length
+		template <typename FormatFn>
+		size_t Get(uint64_t value, uint32_t options, CharT* buffer, size_t capacity, FormatFn fnFormat)
+		{
+			if (!m_nEntries)
+				return fnFormat(buffer, capacity);
+
+			size_t nSet = SetOf(value, options);
+			Entry* pSet = &m_pEntries[nSet * WAYS];
+			for (size_t nWay = 0; nWay < WAYS; ++nWay)
+			{
+				size_t nLength = TryRead(pSet[nWay], value, options, buffer, capacity);
+				if (nLength != NOT_FOUND)
+				{
+					m_hits.fetch_add(1, std::memory_order_relaxed);
+					return nLength;
+				}
+			}
+
+			m_misses.fetch_add(1, std::memory_order_relaxed);
+			size_t nLength = fnFormat(buffer, capacity);
+			if (nLength && nLength <= MAX_LENGTH)
+				Insert(pSet, nSet, value, options, buffer, nLength);
+
+			return nLength;
+		}
+
+		//Cached format(radix, value, ...)
+		size_t Format(unsigned int radix, uint64_t value, CharT* buffer, size_t capacity)
+		{
+			return Get(value, FormatOptions(radix), buffer, capacity, [&](CharT* pBuffer, size_t nCapacity)
+			{
+				return format(radix, value, pBuffer, nCapacity);
+			});
+		}
+
+		FormatCacheStats GetStats() const noexcept
+		{
+			return FormatCacheStats{ m_hits.load(std::memory_order_relaxed), m_misses.load(std::memory_order_relaxed),
+				m_evictions.load(std::memory_order_relaxed), m_nEntries, m_nEntries * sizeof(Entry) + (m_nEntries / WAYS) };
+		}
+
+		void ResetStats() noexcept
+		{
+			m_hits.store(0, std::memory_order_relaxed);
+			m_misses.store(0, std::memory_order_relaxed);
+			m_evictions.store(0, std::memory_order_relaxed);
+		}
+
+	private:
+		static constexpr size_t TEXT_WORDS = (MAX_LENGTH + 7) / 8;
+		static constexpr size_t NOT_FOUND = SIZE_MAX;
+
+		//Every field is atomic so that a read racing a write is well defined; the sequence counter
+		//is odd while a writer owns the entry and 0 until the entry is first written. Text is held
+		//as 8-bit characters, 8 to a word, whatever CharT is
+		struct Entry
+		{
+			std::atomic<uint32_t> sequence;
+			std::atomic<uint32_t> options;
+			std::atomic<uint64_t> value;
+			std::atomic<uint8_t> length;
+			std::atomic<uint8_t> referenced;
+			std::atomic<uint64_t> text[TEXT_WORDS];
+		};
+
+		size_t SetOf(uint64_t value, uint32_t options) const noexcept
+		{
+			uint64_t nHash = (value ^ (static_cast<uint64_t>(options) << 40)) * 0x9E3779B97F4A7C15ull;
+			return static_cast<size_t>(nHash >> 32) & m_nSetMask;
+		}
+
+		static size_t TryRead(Entry& entry, uint64_t value, uint32_t options, CharT* buffer, size_t capacity) noexcept
+		{
+			uint32_t nSequence = entry.sequence.load(std::memory_order_acquire);
+			if (nSequence == 0 || (nSequence & 1))
+				return NOT_FOUND;
+
+			if (entry.value.load(std::memory_order_relaxed) != value || entry.options.load(std::memory_order_relaxed) != options)
+				return NOT_FOUND;
+
+			size_t nLength = entry.length.load(std::memory_order_relaxed);
+			uint64_t text[TEXT_WORDS];
+			for (size_t i = 0; i < (nLength + 7) / 8; ++i)
+				text[i] = entry.text[i].load(std::memory_order_relaxed);
+
+			//Discard the copy if a writer took the entry while it was being read
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (entry.sequence.load(std::memory_order_relaxed) != nSequence)
+				return NOT_FOUND;
+
+			if (nLength >= capacity)
+				return NOT_FOUND;
+
+			const char* pText = reinterpret_cast<const char*>(text);
+			for (size_t i = 0; i < nLength; ++i)
+				buffer[i] = static_cast<CharT>(pText[i]);
+
+			buffer[nLength] = CharT(0);
+
+			if (!entry.referenced.load(std::memory_order_relaxed))
+				entry.referenced.store(1, std::memory_order_relaxed);
+
+			return nLength;
+		}
+
+		void Insert(Entry* pSet, size_t nSet, uint64_t value, uint32_t options, const CharT* pText, size_t nLength) noexcept
+		{
+			uint64_t text[TEXT_WORDS] = {};
+			char* pNarrow = reinterpret_cast<char*>(text);
+			for (size_t i = 0; i < nLength; ++i)
+			{
+				if (static_cast<uint32_t>(pText[i]) >= 0x80)
+					return;
+
+				pNarrow[i] = static_cast<char>(pText[i]);
+			}
+
+			//CLOCK: pass over entries referenced since the last sweep, clearing their bits
+			std::atomic<uint8_t>& hand = m_pHands[nSet];
+			size_t nWay = hand.load(std::memory_order_relaxed) % WAYS;
+			for (size_t i = 0; i < WAYS && pSet[nWay].referenced.load(std::memory_order_relaxed); ++i)
+			{
+				pSet[nWay].referenced.store(0, std::memory_order_relaxed);
+				nWay = (nWay + 1) % WAYS;
+			}
+
+			hand.store(static_cast<uint8_t>((nWay + 1) % WAYS), std::memory_order_relaxed);
+
+			Entry& entry = pSet[nWay];
+			uint32_t nSequence = entry.sequence.load(std::memory_order_relaxed);
+			if ((nSequence & 1) || !entry.sequence.compare_exchange_strong(nSequence, nSequence + 1, std::memory_order_relaxed))
+				return;
+
+			std::atomic_thread_fence(std::memory_order_release);
+
+			if (nSequence)
+				m_evictions.fetch_add(1, std::memory_order_relaxed);
+
+			entry.value.store(value, std::memory_order_relaxed);
+			entry.options.store(options, std::memory_order_relaxed);
+			entry.length.store(static_cast<uint8_t>(nLength), std::memory_order_relaxed);
+			entry.referenced.store(0, std::memory_order_relaxed);
+			for (size_t i = 0; i < (nLength + 7) / 8; ++i)
+				entry.text[i].store(text[i], std::memory_order_relaxed);
+
+			//Skip 0 on wrap-around so a written entry never looks unused
+			uint32_t nNext = nSequence + 2;
+			entry.sequence.store(nNext ? nNext : 2, std::memory_order_release);
+		}
+
+		size_t m_nSetMask = 0;
+		size_t m_nEntries = 0;
+		std::unique_ptr<Entry[]> m_pEntries;
+		std::unique_ptr<std::atomic<uint8_t>[]> m_pHands;
+
+		std::atomic<uint64_t> m_hits{ 0 };
+		std::atomic<uint64_t> m_misses{ 0 };
+		std::atomic<uint64_t> m_evictions{ 0 };
+	};
+}
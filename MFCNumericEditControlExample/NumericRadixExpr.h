@@ -0,0 +1,744 @@
+#pragma once
+
+/*
+	NumericRadixExpr.h
+
+	Integer expressions for the NumericRadix.h engine, e.g. "0x1000 + 4*0x40", "1 << 12 | 0b101"
+	or "~0xFF & mask", with C operators and precedence:
+
+		( )					grouping
+		- + ~				unary minus, plus and bitwise not
+		* / %				multiply, divide, remainder
+		+ -					add, subtract
+		<< >>				shifts (arithmetic right shift when signed)
+		&  ^  |				bitwise and, exclusive or, or
+
+	Literals are in the default radix of the display mode unless prefixed: "0x" is hex and "0b" is
+	binary (except in hex, where it is the digits 0 and b). A leading 0 is not a prefix, so "012"
+	is 12 in decimal, as parse() reads it. Separators are ignored inside literals, as in parse(), so grouped display text such
+	as "0x1234 5678" reads back; a space only joins digits when another digit follows it. Names
+	are variables defined with SetVariable(); a defined name takes precedence over a hex literal
+	of the same letters.
+
+	Arithmetic is 64-bit and checked: a result that does not fit, unsigned or signed as chosen,
+	is an Overflow rather than a wrapped value (so in unsigned arithmetic "1 - 2" is an error and
+	"~0" is all ones). The exception is unsigned negation, which wraps as a '-' sign does in
+	parse(), so "-5" is 2^64 - 5 and is then out of range below 64 bits, as in parse_fixed(). Bitwise operators and shifts never overflow; shifts of 64 or more bits are
+	BadShift.
+
+	An expression compiles to a fixed-size program of 4-byte postfix instructions with constant
+	subexpressions folded, so a constant expression is a single instruction. Programs are
+	evaluated on a small fixed stack with no allocation. ExprEvaluator caches compiled programs
+	(and compile errors) by text, so re-evaluating text that has not changed, as a live preview
+	polled on every keystroke does, costs a hash lookup and the evaluation.
+
+	MIT License for CNumericEditControl:
+
+	Copyright (c) 2019-2020 Data Synergy UK Ltd
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include <cstring>
+#include <vector>
+
+#include "NumericRadix.h"
+
+namespace numeric_radix
+{
+	enum class ExprStatus : uint8_t
+	{
+		Ok,
+		Empty,				//Nothing but white space and separators
+		Syntax,				//Not an expression
+		UnknownName,		//A name that is not a defined variable
+		TooComplex,			//More than the fixed program size, stack or nesting allow
+		OutOfRange,			//A literal that does not fit in 64 bits
+		Overflow,			//Checked arithmetic that does not fit
+		DivideByZero,
+		BadShift,			//A shift count of 64 or more, or negative when signed
+	};
+
+	//Status, value when Ok, and the offset in the text of the error otherwise
+	struct ExprResult
+	{
+		ExprStatus status = ExprStatus::Empty;
+		uint64_t value = 0;
+		size_t offset = 0;
+	};
+
+	//Default radix of literals and whether arithmetic is signed
+	struct ExprOptions
+	{
+		unsigned int radix = 10;
+		bool isSigned = false;
+	};
+
+	enum class ExprOp : uint8_t
+	{
+		Const,				//Push constants[arg]
+		Var,				//Push variables[arg]
+		Neg,
+		Not,
+		Mul,
+		Div,
+		Mod,
+		Add,
+		Sub,
+		Shl,
+		Shr,
+		And,
+		Xor,
+		Or,
+	};
+
+	struct ExprInstruction
+	{
+		ExprOp op;
+		uint8_t arg;
+		uint16_t offset;	//Of the operator or operand in the text, for errors
+	};
+
+	struct ExprProgram
+	{
+		static constexpr size_t MAX_CODE = 64;
+		static constexpr size_t MAX_CONSTANTS = 32;
+		static constexpr size_t MAX_STACK = 16;
+
+		ExprInstruction code[MAX_CODE];
+		uint64_t constants[MAX_CONSTANTS];
+		uint8_t length = 0;
+		uint8_t constantCount = 0;
+		bool isSigned = false;
+	};
+
+	//Variable names and values. Names are [A-Za-z_][A-Za-z0-9_]*
+	template <typename CharT>
+	class ExprSymbols
+	{
+	public:
+		static constexpr size_t MAX_VARIABLES = 16;
+
+		//Index of a name, or -1
+		int Find(std::basic_string_view<CharT> name) const noexcept
+		{
+			for (size_t i = 0; i < m_names.size(); ++i)
+			{
+				if (std::basic_string_view<CharT>(m_names[i]) == name)
+					return static_cast<int>(i);
+			}
+
+			return -1;
+		}
+
+		//Define or update a variable. Returns false if the name is not valid or the table is full
+		bool Set(std::basic_string_view<CharT> name, uint64_t value)
+		{
+			int nIndex = Find(name);
+			if (nIndex >= 0)
+			{
+				m_values[nIndex] = value;
+				return true;
+			}
+
+			if (!IsName(name) || m_names.size() == MAX_VARIABLES)
+				return false;
+
+			m_values[m_names.size()] = value;
+			m_names.emplace_back(name);
+			return true;
+		}
+
+		size_t Count() const noexcept { return m_names.size(); }
+		const uint64_t* Values() const noexcept { return m_values; }
+
+		static constexpr bool IsNameStart(CharT ch) noexcept
+		{
+			return (ch >= CharT('a') && ch <= CharT('z')) || (ch >= CharT('A') && ch <= CharT('Z')) || ch == CharT('_');
+		}
+
+		static constexpr bool IsNameChar(CharT ch) noexcept
+		{
+			return IsNameStart(ch) || (ch >= CharT('0') && ch <= CharT('9'));
+		}
+
+		static constexpr bool IsName(std::basic_string_view<CharT> name) noexcept
+		{
+			if (name.empty() || !IsNameStart(name[0]))
+				return false;
+
+			for (CharT ch : name)
+			{
+				if (!IsNameChar(ch))
+					return false;
+			}
+
+			return true;
+		}
+
+	private:
+		std::vector<std::basic_string<CharT>> m_names;
+		uint64_t m_values[MAX_VARIABLES] = {};
+	};
+
+	namespace detail
+	{
+		//Checked 64-bit arithmetic: returns false on overflow, leaving result unspecified
+		constexpr bool CheckedAdd(uint64_t a, uint64_t b, bool bSigned, uint64_t& result) noexcept
+		{
+			result = a + b;
+			return bSigned ? !(((a ^ result) & (b ^ result)) >> 63) : result >= a;
+		}
+
+		constexpr bool CheckedSub(uint64_t a, uint64_t b, bool bSigned, uint64_t& result) noexcept
+		{
+			result = a - b;
+			return bSigned ? !(((a ^ b) & (a ^ result)) >> 63) : a >= b;
+		}
+
+		constexpr bool CheckedMul(uint64_t a, uint64_t b, bool bSigned, uint64_t& result) noexcept
+		{
+			bool bNegative = bSigned && ((a ^ b) >> 63);
+			uint64_t nA = bSigned && (a >> 63) ? 0 - a : a;
+			uint64_t nB = bSigned && (b >> 63) ? 0 - b : b;
+			if (nA && nB > UINT64_MAX / nA)
+				return false;
+
+			uint64_t nProduct = nA * nB;
+			uint64_t nLimit = !bSigned ? UINT64_MAX : (bNegative ? 1ull << 63 : (1ull << 63) - 1);
+			result = bNegative ? 0 - nProduct : nProduct;
+			return nProduct <= nLimit;
+		}
+
+		//Apply one operator to the top of a stack; returns the status
+		constexpr ExprStatus ApplyOp(ExprOp op, uint64_t* pTop, bool bSigned) noexcept
+		{
+			uint64_t& a = pTop[-1];
+			uint64_t b = pTop[0];
+			switch (op)
+			{
+				case ExprOp::Neg:	return CheckedSub(0, b, bSigned, pTop[0]) || !bSigned ? ExprStatus::Ok : ExprStatus::Overflow;
+				case ExprOp::Not:	pTop[0] = ~b;
+									return ExprStatus::Ok;
+
+				case ExprOp::Mul:	return CheckedMul(a, b, bSigned, a) ? ExprStatus::Ok : ExprStatus::Overflow;
+				case ExprOp::Add:	return CheckedAdd(a, b, bSigned, a) ? ExprStatus::Ok : ExprStatus::Overflow;
+				case ExprOp::Sub:	return CheckedSub(a, b, bSigned, a) ? ExprStatus::Ok : ExprStatus::Overflow;
+
+				case ExprOp::Div:
+				case ExprOp::Mod:	if (!b)
+										return ExprStatus::DivideByZero;
+
+									if (!bSigned)
+										a = op == ExprOp::Div ? a / b : a % b;
+
+									//The one signed quotient that does not fit
+									else if (a == (1ull << 63) && b == UINT64_MAX)
+									{
+										if (op == ExprOp::Div)
+											return ExprStatus::Overflow;
+
+										a = 0;
+									}
+									else
+									{
+										int64_t nA = static_cast<int64_t>(a);
+										int64_t nB = static_cast<int64_t>(b);
+										a = static_cast<uint64_t>(op == ExprOp::Div ? nA / nB : nA % nB);
+									}
+
+									return ExprStatus::Ok;
+
+				case ExprOp::Shl:
+				case ExprOp::Shr:	if (b >= 64)
+										return ExprStatus::BadShift;
+
+									if (op == ExprOp::Shl)
+										a <<= b;
+									else if (bSigned)
+										a = static_cast<uint64_t>(static_cast<int64_t>(a) >> b);
+									else
+										a >>= b;
+
+									return ExprStatus::Ok;
+
+				case ExprOp::And:	a &= b;
+									return ExprStatus::Ok;
+
+				case ExprOp::Xor:	a ^= b;
+									return ExprStatus::Ok;
+
+				case ExprOp::Or:	a |= b;
+									return ExprStatus::Ok;
+
+				default:			return ExprStatus::Syntax;
+			}
+		}
+
+		constexpr bool IsUnaryOp(ExprOp op) noexcept
+		{
+			return op == ExprOp::Neg || op == ExprOp::Not;
+		}
+
+		//Recursive descent over the text, emitting postfix code as each operator is reduced
+		template <typename CharT>
+		class ExprCompiler
+		{
+		public:
+			ExprCompiler(std::basic_string_view<CharT> text, ExprOptions options, const ExprSymbols<CharT>& symbols, ExprProgram& program) noexcept
+				: m_text(text), m_options(options), m_symbols(symbols), m_program(program)
+			{
+				//The text ends at a NUL, as in parse()
+				size_t nEnd = m_text.find(CharT(0));
+				if (nEnd != std::basic_string_view<CharT>::npos)
+					m_text = m_text.substr(0, nEnd);
+
+				m_program.length = 0;
+				m_program.constantCount = 0;
+				m_program.isSigned = options.isSigned;
+			}
+
+			ExprResult Compile() noexcept
+			{
+				SkipSpace();
+				if (m_nPos == m_text.size())
+					return ExprResult{ ExprStatus::Empty, 0, 0 };
+
+				if (ParseBinary(0))
+				{
+					SkipSpace();
+					if (m_nPos != m_text.size())
+						Fail(ExprStatus::Syntax, m_nPos);
+				}
+
+				return ExprResult{ m_status, 0, m_nErrorOffset };
+			}
+
+		private:
+			static constexpr int MAX_NESTING = 32;
+
+			bool Fail(ExprStatus status, size_t nOffset) noexcept
+			{
+				if (m_status == ExprStatus::Ok)
+				{
+					m_status = status;
+					m_nErrorOffset = nOffset;
+				}
+
+				return false;
+			}
+
+			CharT Peek(size_t nAhead = 0) const noexcept
+			{
+				return m_nPos + nAhead < m_text.size() ? m_text[m_nPos + nAhead] : CharT(0);
+			}
+
+			void SkipSpace() noexcept
+			{
+				while (m_nPos < m_text.size() && (IsSpace(m_text[m_nPos]) || IsSeparator(m_text[m_nPos])))
+					++m_nPos;
+			}
+
+			//Binary operator at the current position and its precedence (higher binds tighter), or 0
+			int PeekBinary(ExprOp& op, size_t& nLength) const noexcept
+			{
+				nLength = 1;
+				switch (static_cast<uint32_t>(Peek()))
+				{
+					case '*':	op = ExprOp::Mul;	return 7;
+					case '/':	op = ExprOp::Div;	return 7;
+					case '%':	op = ExprOp::Mod;	return 7;
+					case '+':	op = ExprOp::Add;	return 6;
+					case '-':	op = ExprOp::Sub;	return 6;
+					case '<':	nLength = 2;
+								op = ExprOp::Shl;
+								return Peek(1) == CharT('<') ? 5 : 0;
+
+					case '>':	nLength = 2;
+								op = ExprOp::Shr;
+								return Peek(1) == CharT('>') ? 5 : 0;
+
+					case '&':	op = ExprOp::And;	return 4;
+					case '^':	op = ExprOp::Xor;	return 3;
+					case '|':	op = ExprOp::Or;	return 2;
+					default:	return 0;
+				}
+			}
+
+			//Operators binding tighter than nMinPrecedence, by precedence climbing
+			bool ParseBinary(int nMinPrecedence) noexcept
+			{
+				if (!ParseUnary())
+					return false;
+
+				for (;;)
+				{
+					SkipSpace();
+					ExprOp op = ExprOp::Add;
+					size_t nLength = 0;
+					int nPrecedence = PeekBinary(op, nLength);
+					if (nPrecedence <= nMinPrecedence)
+						return true;
+
+					size_t nOffset = m_nPos;
+					m_nPos += nLength;
+					if (!ParseBinary(nPrecedence) || !Emit(op, 0, nOffset))
+						return false;
+				}
+			}
+
+			bool ParseUnary() noexcept
+			{
+				SkipSpace();
+				CharT ch = Peek();
+				size_t nOffset = m_nPos;
+				if (ch == CharT('-') || ch == CharT('~') || ch == CharT('+'))
+				{
+					if (++m_nDepth > MAX_NESTING)
+						return Fail(ExprStatus::TooComplex, nOffset);
+
+					++m_nPos;
+					bool bOk = ParseUnary() && (ch == CharT('+') || Emit(ch == CharT('-') ? ExprOp::Neg : ExprOp::Not, 0, nOffset));
+					--m_nDepth;
+					return bOk;
+				}
+
+				if (ch == CharT('('))
+				{
+					if (++m_nDepth > MAX_NESTING)
+						return Fail(ExprStatus::TooComplex, nOffset);
+
+					++m_nPos;
+					if (!ParseBinary(0))
+						return false;
+
+					SkipSpace();
+					if (Peek() != CharT(')'))
+						return Fail(ExprStatus::Syntax, m_nPos);
+
+					++m_nPos;
+					--m_nDepth;
+					return true;
+				}
+
+				if (ExprSymbols<CharT>::IsNameStart(ch))
+				{
+					size_t nEnd = m_nPos;
+					while (nEnd < m_text.size() && ExprSymbols<CharT>::IsNameChar(m_text[nEnd]))
+						++nEnd;
+
+					int nIndex = m_symbols.Find(m_text.substr(m_nPos, nEnd - m_nPos));
+					if (nIndex >= 0)
+					{
+						m_nPos = nEnd;
+						return Emit(ExprOp::Var, static_cast<uint8_t>(nIndex), nOffset);
+					}
+
+					//In hex an undefined name of hex digits is a literal
+					bool bHex = m_options.radix == 16;
+					for (size_t i = m_nPos; bHex && i < nEnd; ++i)
+						bHex = DigitValue(m_text[i]) < 16;
+
+					if (!bHex)
+						return Fail(ExprStatus::UnknownName, nOffset);
+				}
+
+				if (DigitValue(ch) < 16)
+					return ParseLiteral();
+
+				return Fail(ExprStatus::Syntax, nOffset);
+			}
+
+			//A literal in its prefix's radix or the default one. Separators inside it are skipped,
+			//so grouped text from format_grouped() reads back
+			bool ParseLiteral() noexcept
+			{
+				size_t nOffset = m_nPos;
+				unsigned int nRadix = m_options.radix;
+				CharT chNext = Peek(1);
+				if (Peek() == CharT('0') && (chNext == CharT('x') || chNext == CharT('X')) && DigitValue(Peek(2)) < 16)
+				{
+					nRadix = 16;
+					m_nPos += 2;
+				}
+				else if (Peek() == CharT('0') && (chNext == CharT('b') || chNext == CharT('B')) && nRadix != 16 && DigitValue(Peek(2)) < 2)
+				{
+					nRadix = 2;
+					m_nPos += 2;
+				}
+
+				uint64_t nValue = 0;
+				bool bOverflow = false;
+				for (; m_nPos < m_text.size(); ++m_nPos)
+				{
+					CharT ch = m_text[m_nPos];
+					if (ch == CharT(','))
+						continue;
+
+					//A space groups digits ("0x1234 5678") only when a digit of the literal follows;
+					//otherwise it ends the literal. Two operands in a row are never valid, so this
+					//cannot change the meaning of an expression
+					if (ch == CharT(' ') && DigitValue(Peek(1)) < nRadix)
+						continue;
+
+					unsigned int nDigit = DigitValue(ch);
+					if (nDigit >= nRadix)
+						break;
+
+					bOverflow |= nValue > (UINT64_MAX - nDigit) / nRadix;
+					nValue = nValue * nRadix + nDigit;
+				}
+
+				//"12ab" in decimal, "19" in octal
+				if (m_nPos < m_text.size() && ExprSymbols<CharT>::IsNameChar(m_text[m_nPos]))
+					return Fail(ExprStatus::Syntax, m_nPos);
+
+				if (bOverflow)
+					return Fail(ExprStatus::OutOfRange, nOffset);
+
+				return EmitConstant(nValue, nOffset);
+			}
+
+			bool EmitConstant(uint64_t nValue, size_t nOffset) noexcept
+			{
+				if (m_program.constantCount == ExprProgram::MAX_CONSTANTS)
+					return Fail(ExprStatus::TooComplex, nOffset);
+
+				m_program.constants[m_program.constantCount] = nValue;
+				return Emit(ExprOp::Const, m_program.constantCount++, nOffset);
+			}
+
+			//Append an instruction, folding an operator whose operands are all constants
+			bool Emit(ExprOp op, uint8_t nArg, size_t nOffset) noexcept
+			{
+				ExprInstruction* pCode = m_program.code;
+				size_t nLength = m_program.length;
+				size_t nOperands = op == ExprOp::Const || op == ExprOp::Var ? 0 : (IsUnaryOp(op) ? 1 : 2);
+				bool bConstant = nLength >= nOperands;
+				for (size_t i = 1; bConstant && i <= nOperands; ++i)
+					bConstant = pCode[nLength - i].op == ExprOp::Const;
+
+				if (nOperands && bConstant)
+				{
+					//The operands are the last constants allocated, so the first one's slot is reused
+					uint8_t nSlot = pCode[nLength - nOperands].arg;
+					uint64_t stack[3] = { 0, m_program.constants[nSlot], m_program.constants[pCode[nLength - 1].arg] };
+					ExprStatus status = ApplyOp(op, stack + 2, m_options.isSigned);
+					if (status != ExprStatus::Ok)
+						return Fail(status, nOffset);
+
+					m_program.length = static_cast<uint8_t>(nLength - nOperands + 1);
+					m_program.constantCount = static_cast<uint8_t>(nSlot + 1);
+					m_program.constants[nSlot] = stack[3 - nOperands];
+					m_nStack -= nOperands - 1;
+					return true;
+				}
+
+				if (nLength == ExprProgram::MAX_CODE || nOffset > UINT16_MAX)
+					return Fail(ExprStatus::TooComplex, nOffset);
+
+				m_nStack = m_nStack + 1 - nOperands;
+				if (m_nStack > ExprProgram::MAX_STACK)
+					return Fail(ExprStatus::TooComplex, nOffset);
+
+				pCode[nLength] = ExprInstruction{ op, nArg, static_cast<uint16_t>(nOffset) };
+				m_program.length = static_cast<uint8_t>(nLength + 1);
+				return true;
+			}
+
+			std::basic_string_view<CharT> m_text;
+			ExprOptions m_options;
+			const ExprSymbols<CharT>& m_symbols;
+			ExprProgram& m_program;
+			size_t m_nPos = 0;
+			size_t m_nStack = 0;
+			int m_nDepth = 0;
+			ExprStatus m_status = ExprStatus::Ok;
+			size_t m_nErrorOffset = 0;
+		};
+	}
+
+	//Compile text into program. The result's status is Ok or the compile error and its offset
+	template <typename CharT>
+	inline ExprResult compile_expr(std::basic_string_view<CharT> text, ExprOptions options, const ExprSymbols<CharT>& symbols, ExprProgram& program) noexcept
+	{
+		return detail::ExprCompiler<CharT>(text, options, symbols, program).Compile();
+	}
+
+	//Run a compiled program against the current variable values
+	inline ExprResult evaluate_expr(const ExprProgram& program, const uint64_t* variables) noexcept
+	{
+		uint64_t stack[ExprProgram::MAX_STACK + 1];
+		uint64_t* pTop = stack;
+		for (size_t i = 0; i < program.length; ++i)
+		{
+			const ExprInstruction& instruction = program.code[i];
+			switch (instruction.op)
+			{
+				case ExprOp::Const:		*++pTop = program.constants[instruction.arg];
+										break;
+
+				case ExprOp::Var:		*++pTop = variables[instruction.arg];
+										break;
+
+				//Unary operators work on the top entry, binary operators pop one into the next
+				default:				ExprStatus status = detail::ApplyOp(instruction.op, pTop, program.isSigned);
+										if (status != ExprStatus::Ok)
+											return ExprResult{ status, 0, instruction.offset };
+
+										pTop -= !detail::IsUnaryOp(instruction.op);
+										break;
+			}
+		}
+
+		return ExprResult{ ExprStatus::Ok, pTop[0], 0 };
+	}
+
+	struct ExprCacheStats
+	{
+		uint64_t hits;
+		uint64_t misses;
+	};
+
+	//Compiles and evaluates expressions, caching compiled programs by text and options in a
+	//direct-mapped table. Defining a new variable clears the cache; changing the value of one does
+	//not. Not thread-safe: use one evaluator per thread (or per control)
+	template <typename CharT>
+	class ExprEvaluator
+	{
+	public:
+		explicit ExprEvaluator(size_t cacheEntries = 64)
+		{
+			size_t nEntries = 1;
+			while (nEntries * 2 <= cacheEntries)
+				nEntries *= 2;
+
+			m_entries.resize(cacheEntries ? nEntries : 0);
+		}
+
+		//Define or update a variable; returns false if the name is not valid or there are too many
+		bool SetVariable(std::basic_string_view<CharT> name, uint64_t value)
+		{
+			size_t nCount = m_symbols.Count();
+			if (!m_symbols.Set(name, value))
+				return false;
+
+			//Programs compiled before the name existed reported it as unknown
+			if (m_symbols.Count() != nCount)
+				ClearCache();
+
+			return true;
+		}
+
+		ExprResult Evaluate(std::basic_string_view<CharT> text, ExprOptions options)
+		{
+			if (m_entries.empty())
+			{
+				ExprProgram program;
+				ExprResult result = compile_expr(text, options, m_symbols, program);
+				return result.status == ExprStatus::Ok ? evaluate_expr(program, m_symbols.Values()) : result;
+			}
+
+			uint32_t nOptions = (options.radix << 1) | options.isSigned;
+			uint64_t nHash = HashText(text, nOptions);
+			Entry& entry = m_entries[static_cast<size_t>(nHash >> 32) & (m_entries.size() - 1)];
+			if (entry.used && entry.hash == nHash && entry.options == nOptions && entry.text.size() == text.size() &&
+				std::memcmp(entry.text.data(), text.data(), text.size() * sizeof(CharT)) == 0)
+				++m_stats.hits;
+
+			else
+			{
+				++m_stats.misses;
+				entry.used = true;
+				entry.hash = nHash;
+				entry.options = nOptions;
+				entry.text.assign(text.data(), text.size());
+				entry.result = compile_expr(text, options, m_symbols, entry.program);
+			}
+
+			return entry.result.status == ExprStatus::Ok ? evaluate_expr(entry.program, m_symbols.Values()) : entry.result;
+		}
+
+		void ClearCache() noexcept
+		{
+			for (Entry& entry : m_entries)
+				entry.used = false;
+		}
+
+		ExprCacheStats GetStats() const noexcept { return m_stats; }
+		void ResetStats() noexcept { m_stats = ExprCacheStats(); }
+
+	private:
+		struct Entry
+		{
+			bool used = false;
+			uint32_t options = 0;
+			uint64_t hash = 0;
+			std::basic_string<CharT> text;
+			ExprProgram program;
+			ExprResult result;
+		};
+
+		//FNV-1a over pairs of code units and the options, ending text at a NUL in the same pass
+		static uint64_t HashText(std::basic_string_view<CharT>& text, uint32_t nOptions) noexcept
+		{
+			uint64_t nHash = 0xCBF29CE484222325ull ^ nOptions;
+			size_t nLength = 0;
+			while (nLength < text.size() && text[nLength] != CharT(0))
+			{
+				uint64_t nPair = detail::CharCode(text[nLength++]);
+				if (nLength < text.size() && text[nLength] != CharT(0))
+					nPair |= static_cast<uint64_t>(detail::CharCode(text[nLength++])) << 32;
+
+				nHash = (nHash ^ nPair) * 0x100000001B3ull;
+			}
+
+			text = text.substr(0, nLength);
+			return nHash;
+		}
+
+		std::vector<Entry> m_entries;
+		ExprSymbols<CharT> m_symbols;
+		ExprCacheStats m_stats = {};
+	};
+
+	//Keystroke filter for expression text: digits and letters (for every radix prefix and for
+	//names), operators, parentheses, separators and white space. The text is validated when it is
+	//compiled
+	template <typename KeyT>
+	constexpr bool IsExprKeystrokeAllowed(KeyT ch) noexcept
+	{
+		uint32_t chKey = detail::CharCode(ch);
+		if (chKey >= 0x80)
+			return false;
+
+		if (DigitValue(static_cast<char>(chKey)) != NOT_A_DIGIT || chKey == '_' || chKey == ' ' || chKey == ',')
+			return true;
+
+		for (const char* p = "+-*/%&|^~<>()"; *p; ++p)
+		{
+			if (chKey == static_cast<uint32_t>(*p))
+				return true;
+		}
+
+		return false;
+	}
+
+	static_assert(sizeof(ExprInstruction) == 4 && static_cast<uint8_t>(ExprProgram::MAX_CONSTANTS) == ExprProgram::MAX_CONSTANTS, "Compact instructions");
+}
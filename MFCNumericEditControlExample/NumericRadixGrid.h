@@ -0,0 +1,271 @@
+#pragma once
+
+/*
+	NumericRadixGrid.h
+
+	Data model and formatting cache for grids of numeric fields, such as register or memory
+	views with tens of thousands of values. Values are held in one contiguous uint64_t array
+	with one mode byte per cell (display mode plus an empty flag), so a cell costs 9 bytes and
+	no window.
+
+	Text is formatted on demand with the control's rules (see NumericRadix.h) and cached only for
+	the visible rows. The cache is a ring of row slots: row r is held in slot r % capacity, so
+	any run of visible rows maps to distinct slots and scrolling by one row reformats only the
+	row that scrolls into view. Changing a value or mode invalidates just that cell's text.
+
+	The model has no platform dependencies; CNumericGridControl displays it in a virtual list
+	control with a CNumericEditControl as in-place editor.
+
+	MIT License for CNumericEditControl:
+
+	Copyright (c) 2019-2020 Data Synergy UK Ltd
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include <vector>
+
+#include "NumericRadix.h"
+
+namespace numeric_radix
+{
+	//Display modes, in the order of CNumericEditControl::EDisplayMode
+	enum class DisplayMode : uint8_t
+	{
+		Decimal,
+		Hex,
+		Octal,
+		Binary,
+	};
+
+	constexpr unsigned int RadixOf(DisplayMode mode) noexcept
+	{
+		switch (mode)
+		{
+			case DisplayMode::Hex:		return 16;
+			case DisplayMode::Octal:	return 8;
+			case DisplayMode::Binary:	return 2;
+			default:					return 10;
+		}
+	}
+
+	template <typename CharT>
+	class GridModel
+	{
+	public:
+		using StringView = std::basic_string_view<CharT>;
+
+		struct CacheStats
+		{
+			uint64_t hits;
+			uint64_t misses;
+		};
+
+		GridModel() = default;
+
+		GridModel(size_t rows, size_t columns, DisplayMode mode = DisplayMode::Decimal)
+		{
+			Resize(rows, columns, mode);
+		}
+
+		//Discard all cells and create rows x columns empty cells in the given mode
+		void Resize(size_t rows, size_t columns, DisplayMode mode = DisplayMode::Decimal)
+		{
+			m_nRows = rows;
+			m_nColumns = columns;
+			m_values.assign(rows * columns, 0);
+			m_modes.assign(rows * columns, static_cast<uint8_t>(static_cast<uint8_t>(mode) | EMPTY));
+			m_nCacheRows = 0;
+			m_cachedRows.clear();
+			m_lengths.clear();
+			SetVisibleRows(m_nVisibleRows);
+		}
+
+		size_t Rows() const noexcept { return m_nRows; }
+		size_t Columns() const noexcept { return m_nColumns; }
+
+		uint64_t GetValue(size_t row, size_t column) const noexcept { return m_values[Cell(row, column)]; }
+		bool IsEmpty(size_t row, size_t column) const noexcept { return (m_modes[Cell(row, column)] & EMPTY) != 0; }
+		DisplayMode GetMode(size_t row, size_t column) const noexcept { return static_cast<DisplayMode>(m_modes[Cell(row, column)] & MODE_MASK); }
+
+		//Contiguous row-major values, e.g. for format_batch() or a memory snapshot
+		const uint64_t* Values() const noexcept { return m_values.data(); }
+
+		void SetValue(size_t row, size_t column, uint64_t value) noexcept
+		{
+			size_t nCell = Cell(row, column);
+			m_values[nCell] = value;
+			m_modes[nCell] &= MODE_MASK;
+			InvalidateCell(row, column);
+		}
+
+		void SetEmpty(size_t row, size_t column) noexcept
+		{
+			m_modes[Cell(row, column)] |= EMPTY;
+			InvalidateCell(row, column);
+		}
+
+		void SetMode(size_t row, size_t column, DisplayMode mode) noexcept
+		{
+			uint8_t& nMode = m_modes[Cell(row, column)];
+			nMode = static_cast<uint8_t>((nMode & EMPTY) | static_cast<uint8_t>(mode));
+			InvalidateCell(row, column);
+		}
+
+		void SetColumnMode(size_t column, DisplayMode mode) noexcept
+		{
+			for (size_t nRow = 0; nRow < m_nRows; ++nRow)
+			{
+				uint8_t& nMode = m_modes[Cell(nRow, column)];
+				nMode = static_cast<uint8_t>((nMode & EMPTY) | static_cast<uint8_t>(mode));
+			}
+
+			for (size_t nSlotRow = 0; nSlotRow < m_nCacheRows; ++nSlotRow)
+				m_lengths[nSlotRow * m_nColumns + column] = NOT_FORMATTED;
+		}
+
+		//Set a cell from text in its display mode, as an edit of the cell. Empty text empties the
+		//cell. Returns false, leaving the cell unchanged, if the text is not a valid value
+		bool SetText(size_t row, size_t column, StringView text) noexcept
+		{
+			bool bBlank = true;
+			for (CharT ch : text)
+			{
+				if (!IsSpace(ch) && !IsSeparator(ch))
+				{
+					bBlank = false;
+					break;
+				}
+			}
+
+			if (bBlank)
+			{
+				SetEmpty(row, column);
+				return true;
+			}
+
+			uint64_t value = 0;
+			if (!parse(RadixOf(GetMode(row, column)), text, value))
+				return false;
+
+			SetValue(row, column, value);
+			return true;
+		}
+
+		//Size the cache for the number of rows visible at once. Text for any other row is still
+		//formatted on request, taking over the slot of the row it shares a slot with. Without a
+		//cache every request formats into a single scratch slot
+		void SetVisibleRows(size_t rows)
+		{
+			m_nVisibleRows = rows;
+			size_t nCacheRows = rows < m_nRows ? rows : m_nRows;
+			if (nCacheRows <= m_nCacheRows)
+				return;
+
+			m_nCacheRows = nCacheRows;
+			m_cachedRows.assign(m_nCacheRows, NO_ROW);
+			m_lengths.assign(m_nCacheRows * m_nColumns, NOT_FORMATTED);
+			m_text.resize(m_nCacheRows * m_nColumns * SLOT_SIZE);
+		}
+
+		//Discard all cached text, e.g. after changing the character set of the display
+		void Invalidate() noexcept
+		{
+			for (size_t& nRow : m_cachedRows)
+				nRow = NO_ROW;
+		}
+
+		//Text of a cell in the control's display format (empty for an empty cell). The view stays
+		//valid until the cell changes or its cache slot is reused by another row
+		StringView GetText(size_t row, size_t column) noexcept
+		{
+			CharT* pSlot = m_scratch;
+			uint8_t* pLength = &m_nScratchLength;
+			if (m_nCacheRows)
+			{
+				size_t nSlotRow = row % m_nCacheRows;
+				if (m_cachedRows[nSlotRow] != row)
+				{
+					m_cachedRows[nSlotRow] = row;
+					for (size_t nColumn = 0; nColumn < m_nColumns; ++nColumn)
+						m_lengths[nSlotRow * m_nColumns + nColumn] = NOT_FORMATTED;
+				}
+
+				size_t nSlot = nSlotRow * m_nColumns + column;
+				pSlot = m_text.data() + nSlot * SLOT_SIZE;
+				pLength = &m_lengths[nSlot];
+			}
+			else
+				*pLength = NOT_FORMATTED;
+
+			if (*pLength == NOT_FORMATTED)
+			{
+				++m_stats.misses;
+				size_t nCell = Cell(row, column);
+				size_t nLength = 0;
+				if (!(m_modes[nCell] & EMPTY))
+					nLength = format(RadixOf(static_cast<DisplayMode>(m_modes[nCell] & MODE_MASK)), m_values[nCell], pSlot, SLOT_SIZE);
+
+				pSlot[nLength] = CharT(0);
+				*pLength = static_cast<uint8_t>(nLength);
+			}
+			else
+				++m_stats.hits;
+
+			return StringView(pSlot, *pLength);
+		}
+
+		CacheStats GetCacheStats() const noexcept { return m_stats; }
+		void ResetCacheStats() noexcept { m_stats = CacheStats(); }
+
+	private:
+		static constexpr uint8_t MODE_MASK = 0x03;
+		static constexpr uint8_t EMPTY = 0x80;
+		static constexpr uint8_t NOT_FORMATTED = 0xFF;
+		static constexpr size_t NO_ROW = SIZE_MAX;
+		static constexpr size_t SLOT_SIZE = FORMAT_BUFFER_SIZE;
+
+		size_t Cell(size_t row, size_t column) const noexcept
+		{
+			return row * m_nColumns + column;
+		}
+
+		void InvalidateCell(size_t row, size_t column) noexcept
+		{
+			if (m_nCacheRows && m_cachedRows[row % m_nCacheRows] == row)
+				m_lengths[(row % m_nCacheRows) * m_nColumns + column] = NOT_FORMATTED;
+		}
+
+		size_t m_nRows = 0;
+		size_t m_nColumns = 0;
+		std::vector<uint64_t> m_values;
+		std::vector<uint8_t> m_modes;
+
+		//Formatting cache: the row held in each slot row, the length of each slot's text (or
+		//NOT_FORMATTED) and SLOT_SIZE characters of text per slot
+		size_t m_nVisibleRows = 0;
+		size_t m_nCacheRows = 0;
+		std::vector<size_t> m_cachedRows;
+		std::vector<uint8_t> m_lengths;
+		std::vector<CharT> m_text;
+		CharT m_scratch[SLOT_SIZE] = {};
+		uint8_t m_nScratchLength = NOT_FORMATTED;
+		CacheStats m_stats = {};
+	};
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+/*
+	NumericRadixGroup.h
+
+	Digit grouping for display with the NumericRadix.h engine: thousands separators in decimal
+	("18,446,744,073,709,551,615"), and nibble, byte or word groups in hex and binary
+	("0xdead beef", "1010 0101"). Groups are counted from the least significant digit, so only
+	the leading group can be short, and the prefix is never split.
+
+	The grouped length is known from the digit count before anything is written, so the digits
+	and separators are written once, in place, a group at a time, with no intermediate string.
+	The separators are those parse() ignores, so grouped text reads back unchanged; keystroke
+	checks use MakeDigitContext(), which discounts separators without copying the text.
+
+	MIT License for CNumericEditControl:
+
+	Copyright (c) 2019-2020 Data Synergy UK Ltd
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "NumericRadix.h"
+
+namespace numeric_radix
+{
+	//groupSize digits between separators, or 0 for no grouping. The separator must be one that
+	//parse() ignores (IsSeparator())
+	struct Grouping
+	{
+		unsigned int groupSize = 0;
+		char separator = ',';
+	};
+
+	//Longest grouped text: "0x" or a sign, 64 binary digits and 63 separators
+	constexpr size_t GROUPED_FORMAT_BUFFER_SIZE = 2 * FORMAT_BUFFER_SIZE;
+
+	//Thousands in decimal, nibbles in hex and binary, and digits of 3 in octal
+	constexpr Grouping DefaultGrouping(unsigned int radix) noexcept
+	{
+		switch (radix)
+		{
+			case 10:	return Grouping{ 3, ',' };
+			case 8:		return Grouping{ 3, ' ' };
+			case 2:
+			case 16:	return Grouping{ 4, ' ' };
+			default:	return Grouping();
+		}
+	}
+
+	namespace detail
+	{
+		//Number of characters nDigits digits take when grouped
+		constexpr size_t GroupedLength(size_t nDigits, Grouping grouping) noexcept
+		{
+			return grouping.groupSize ? nDigits + (nDigits - 1) / grouping.groupSize : nDigits;
+		}
+
+		//Write the nDigits digits of value ending at pEnd with separators between groups,
+		//GroupedLength() characters in all. Each full group is split from the value by a shift,
+		//or in decimal by a division by a power of ten, and written by WriteDigits()
+		template <unsigned int Radix, typename CharT>
+		constexpr void WriteGroupedDigits(uint64_t value, CharT* pEnd, size_t nDigits, Grouping grouping) noexcept
+		{
+			constexpr unsigned int nDigitBits = Radix == 16 ? 4 : (Radix == 8 ? 3 : 1);
+			size_t nGroup = grouping.groupSize;
+
+			//The loop only runs while a whole group and more remain, so the shift is below 64 bits
+			//and the power of ten below 10^20
+			while (nGroup && nDigits > nGroup)
+			{
+				uint64_t nLow = 0;
+				if (Radix == 10)
+				{
+					//Thousands are by far the most common, and a constant divisor is much cheaper
+					uint64_t nDivisor = nGroup == 3 ? 1000 : POW10[nGroup];
+					uint64_t nHigh = nGroup == 3 ? value / 1000 : value / nDivisor;
+					nLow = value - nHigh * nDivisor;
+					value = nHigh;
+				}
+				else
+				{
+					unsigned int nShift = static_cast<unsigned int>(nGroup) * nDigitBits;
+					nLow = value & ((1ull << nShift) - 1);
+					value >>= nShift;
+				}
+
+				WriteDigits<Radix>(nLow, pEnd, nGroup);
+				pEnd -= nGroup;
+				*--pEnd = CharT(grouping.separator);
+				nDigits -= nGroup;
+			}
+
+			WriteDigits<Radix>(value, pEnd, nDigits);
+		}
+
+		constexpr bool IsValidGrouping(Grouping grouping) noexcept
+		{
+			return !grouping.groupSize || IsSeparator(grouping.separator);
+		}
+	}
+
+	//Format a value as format() does, with digit grouping. Returns the number of characters
+	//written excluding the terminator, or 0 if the buffer is too small or the separator is not
+	//one parse() ignores
+	template <unsigned int Radix, typename CharT>
+	constexpr size_t format_grouped(uint64_t value, Grouping grouping, CharT* buffer, size_t bufferSize) noexcept
+	{
+		static_assert(detail::IsSupportedRadix(Radix), "Radix must be 2, 8, 10 or 16");
+
+		if (!detail::IsValidGrouping(grouping))
+			return 0;
+
+		constexpr size_t nPrefixLength = Radix == 16 ? 2 : (Radix == 8 ? 1 : 0);
+
+		size_t nDigits = detail::FormattedDigits<Radix>(value);
+		size_t nLength = nPrefixLength + detail::GroupedLength(nDigits, grouping);
+		if (nLength >= bufferSize)
+			return 0;
+
+		if (Radix == 16)
+		{
+			buffer[0] = CharT('0');
+			buffer[1] = CharT('x');
+		}
+		else if (Radix == 8)
+			buffer[0] = CharT('0');
+
+		buffer[nLength] = CharT(0);
+		detail::WriteGroupedDigits<Radix>(value, buffer + nLength, nDigits, grouping);
+		return nLength;
+	}
+
+	template <typename CharT>
+	constexpr size_t format_grouped(unsigned int radix, uint64_t value, Grouping grouping, CharT* buffer, size_t bufferSize) noexcept
+	{
+		switch (radix)
+		{
+			case 2:		return format_grouped<2>(value, grouping, buffer, bufferSize);
+			case 8:		return format_grouped<8>(value, grouping, buffer, bufferSize);
+			case 10:	return format_grouped<10>(value, grouping, buffer, bufferSize);
+			case 16:	return format_grouped<16>(value, grouping, buffer, bufferSize);
+			default:	return 0;
+		}
+	}
+
+	//Keystroke context for text as if its separators were removed, so that digit counts are not
+	//thrown by grouping. The selection is mapped onto the remaining characters. The text is read
+	//once and not copied
+	template <typename CharT>
+	constexpr KeystrokeContext<CharT> MakeDigitContext(std::basic_string_view<CharT> text, size_t selStart, size_t selEnd) noexcept
+	{
+		KeystrokeContext<CharT> context;
+		for (size_t i = 0; i < text.size(); ++i)
+		{
+			if (i == selStart)
+				context.selStart = context.length;
+
+			if (i == selEnd)
+				context.selEnd = context.length;
+
+			CharT ch = text[i];
+			if (IsSeparator(ch))
+				continue;
+
+			if (context.length == 0)
+				context.first = ch;
+
+			else if (context.length == 1)
+				context.second = ch;
+
+			++context.length;
+		}
+
+		if (selStart >= text.size())
+			context.selStart = context.length;
+
+		if (selEnd >= text.size())
+			context.selEnd = context.length;
+
+		return context;
+	}
+
+	static_assert(detail::GroupedLength(20, Grouping{ 3, ',' }) == 26 && detail::GroupedLength(64, Grouping{ 4, ' ' }) == 79, "Grouped lengths");
+	static_assert(detail::GroupedLength(64, Grouping{ 1, ' ' }) + 3 == GROUPED_FORMAT_BUFFER_SIZE, "GROUPED_FORMAT_BUFFER_SIZE must hold 64 grouped binary digits");
+}
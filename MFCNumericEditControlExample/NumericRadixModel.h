@@ -0,0 +1,514 @@
+#pragma once
+
+/*
+	NumericRadixModel.h
+
+	Headless model of CNumericEditControl's input logic for integers up to 64 bits: the text
+	buffer, caret and selection, the display mode, width, signedness, grouping and expression
+	settings, and what OnChar(), OnKeyDown(), OnCommand() (mode switches, cut, copy and paste),
+	ChangeMode() and OnKillFocus() do to them. Editing keys that the control leaves to CEdit
+	(backspace, delete, arrows, Home and End) are modelled on a single-line edit control. The
+	system clipboard is an EditClipboard, which several models may share.
+
+	The keystroke rule and the handling of expression results are shared with the control, so the
+	model is the control's logic rather than a copy of it, and can be profiled and replayed
+	without a window (see NumericRadixReplay.h). Wide values and real number types are not
+	modelled.
+
+	With NUMERIC_RADIX_INSTRUMENT defined the model is instrumented with the control's probes and
+	counters (see NumericRadixTrace.h).
+
+	MIT License for CNumericEditControl:
+
+	Copyright (c) 2019-2020 Data Synergy UK Ltd
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "NumericRadixExpr.h"
+#include "NumericRadixSigned.h"
+#include "NumericRadixTrace.h"
+
+namespace numeric_radix
+{
+	//Integer input settings of a control in its current mode
+	struct EditFormat
+	{
+		unsigned int radix = 10;
+		FixedFormat fixed;
+		Grouping grouping;
+		bool expression = false;
+	};
+
+	//Keystroke rule of CNumericEditControl::OnChar() for integers. Expression text accepts the
+	//expression alphabet, signed decimal also accepts a leading '-', and otherwise digits of the
+	//radix are subject to position and count (see IsKeystrokeAllowed()). Grouped text should be
+	//described by MakeDigitContext() so that separators are not counted as digits
+	template <typename CharT, typename KeyT>
+	constexpr bool IsEditKeystrokeAllowed(const EditFormat& format, const KeystrokeContext<CharT>& context, KeyT ch, size_t maxDigits) noexcept
+	{
+		if (format.expression)
+			return IsExprKeystrokeAllowed(ch);
+
+		if (format.fixed.isSigned && format.radix == 10)
+			return IsSignedKeystrokeAllowed(context, ch, maxDigits);
+
+		return IsKeystrokeAllowed(format.radix, context, ch, maxDigits);
+	}
+
+	//Digits below which every value of the format fits its width, so that a keystroke leaving
+	//fewer can be decided from its context alone. Signed decimal is bounded by 2^(bits - 1)
+	constexpr size_t SafeDigits(const EditFormat& format) noexcept
+	{
+		unsigned int nBits = format.fixed.isSigned && format.radix == 10 && format.fixed.bits ? format.fixed.bits - 1 : format.fixed.bits;
+		size_t nDigits = MaxDigits(format.radix, nBits);
+		return nDigits ? nDigits - 1 : 0;
+	}
+
+	//Keystroke rule with the running overflow bound. A keystroke that leaves fewer than
+	//SafeDigits() digits is decided by IsEditKeystrokeAllowed() in O(1). One that may reach the
+	//width's digit count is decided on the text, which fnText() reads only then: after the
+	//keystroke its digits, not counting separators, must not exceed MaxDigits() and its value must
+	//fit the width as parse_fixed() reads it. Text that is not yet a number ("-", "0x") passes, and
+	//text of GROUPED_FORMAT_BUFFER_SIZE characters or more, longer than any grouped value, is refused
+	template <typename CharT, typename KeyT, typename TextFn>
+	inline bool IsEditKeystrokeInRange(const EditFormat& format, const KeystrokeContext<CharT>& context, KeyT ch, TextFn fnText)
+	{
+		if (IsEditKeystrokeAllowed(format, context, ch, SafeDigits(format)))
+			return true;
+
+		//Expression keystrokes do not depend on the digit count
+		if (format.expression || !IsEditKeystrokeAllowed(format, context, ch, SIZE_MAX))
+			return false;
+
+		std::basic_string_view<CharT> text = fnText();
+		size_t nEnd = context.selEnd < text.size() ? context.selEnd : text.size();
+		size_t nStart = context.selStart < nEnd ? context.selStart : nEnd;
+		if (text.size() >= GROUPED_FORMAT_BUFFER_SIZE ||
+			!IsEditKeystrokeAllowed(format, MakeDigitContext(text, nStart, nEnd), ch, MaxDigits(format.radix, format.fixed.bits)))
+			return false;
+
+		CharT szText[GROUPED_FORMAT_BUFFER_SIZE];
+		size_t nLength = text.size() - (nEnd - nStart) + 1;
+
+		std::copy(text.begin(), text.begin() + nStart, szText);
+		szText[nStart] = static_cast<CharT>(ch);
+		std::copy(text.begin() + nEnd, text.end(), szText + nStart + 1);
+
+		uint64_t value = 0;
+		return parse_fixed(format.radix, std::basic_string_view<CharT>(szText, nLength), format.fixed, value) != ParseStatus::OutOfRange;
+	}
+
+	//An expression result checked against a fixed format. As with parse_fixed(), signed hex, octal
+	//and binary results may be any bit pattern of the width, and are sign-extended
+	constexpr ExprResult FitExprResult(ExprResult result, FixedFormat fixed, unsigned int radix) noexcept
+	{
+		if (result.status != ExprStatus::Ok)
+			return result;
+
+		if (fixed.isSigned && SignExtend(result.value, fixed.bits) == result.value)
+			return result;
+
+		if (result.value <= WidthMask(fixed.bits) && (!fixed.isSigned || radix != 10))
+		{
+			result.value = FitToWidth(result.value, fixed);
+			return result;
+		}
+
+		return ExprResult{ ExprStatus::OutOfRange, 0, 0 };
+	}
+
+	//Parse status of an expression: it is empty, out of range (including arithmetic overflow) or
+	//otherwise invalid
+	constexpr ParseStatus ExprParseStatus(ExprStatus status) noexcept
+	{
+		switch (status)
+		{
+			case ExprStatus::Ok:			return ParseStatus::Ok;
+			case ExprStatus::Empty:			return ParseStatus::Empty;
+			case ExprStatus::OutOfRange:
+			case ExprStatus::Overflow:		return ParseStatus::OutOfRange;
+			default:						return ParseStatus::Invalid;
+		}
+	}
+
+	template <typename CharT>
+	struct EditClipboard
+	{
+		std::basic_string<CharT> text;
+	};
+
+	//Keys handled by OnKeyDown() or left to the edit control. X, C and V are commands with Ctrl
+	enum class EditKey : uint8_t
+	{
+		Left,
+		Right,
+		Home,
+		End,
+		Delete,
+		X,
+		C,
+		V,
+	};
+
+	//Context menu and OnCommand() commands
+	enum class EditCommand : uint8_t
+	{
+		Decimal,
+		Hex,
+		Octal,
+		Binary,
+		Cut,
+		Copy,
+		Paste,
+	};
+
+	template <typename CharT>
+	class NumericEditModel
+	{
+	public:
+		static constexpr uint32_t BACKSPACE = 8;
+
+		explicit NumericEditModel(EditClipboard<CharT>& clipboard) : m_clipboard(clipboard)
+		{
+			for (unsigned int& nDigits : m_nGroupDigits)
+				nDigits = 0;
+		}
+
+		//Settings, as the control's SetBitWidth() (limited to 64 bits), SetSigned(),
+		//SetDigitGrouping() and SetExpressionMode()
+		void SetBitWidth(unsigned int nBits)
+		{
+			m_nBits = nBits < 1 ? 1 : (nBits > 64 ? 64 : nBits);
+			InvalidateValueCache();
+		}
+
+		void SetSigned(bool bSigned)
+		{
+			m_bSigned = bSigned;
+			InvalidateValueCache();
+		}
+
+		void SetDigitGrouping(unsigned int radix, unsigned int nDigits)
+		{
+			m_nGroupDigits[ModeIndex(radix)] = nDigits < FORMAT_BUFFER_SIZE ? nDigits : 0;
+		}
+
+		void SetExpressionMode(bool bExpression)
+		{
+			m_bExpression = bExpression;
+			InvalidateValueCache();
+		}
+
+		bool SetExpressionVariable(std::basic_string_view<CharT> name, uint64_t value)
+		{
+			InvalidateValueCache();
+			return Evaluator().SetVariable(name, value);
+		}
+
+		EditFormat GetFormat() const noexcept
+		{
+			Grouping grouping = DefaultGrouping(m_nRadix);
+			grouping.groupSize = m_nGroupDigits[ModeIndex(m_nRadix)];
+			return EditFormat{ m_nRadix, FixedFormat{ m_nBits, m_bSigned }, grouping, m_bExpression };
+		}
+
+		unsigned int GetRadix() const noexcept { return m_nRadix; }
+		std::basic_string_view<CharT> GetText() const noexcept { return m_text; }
+		size_t GetSelStart() const noexcept { return m_nCaret < m_nAnchor ? m_nCaret : m_nAnchor; }
+		size_t GetSelEnd() const noexcept { return m_nCaret < m_nAnchor ? m_nAnchor : m_nCaret; }
+		size_t GetCaret() const noexcept { return m_nCaret; }
+
+		//Programmatic text, as SetWindowText(): the caret moves to the start
+		void SetText(std::basic_string_view<CharT> text)
+		{
+			m_text.assign(text.data(), text.size());
+			m_nCaret = m_nAnchor = 0;
+			InvalidateValueCache();
+		}
+
+		void SetValue(uint64_t value) { DisplayValue(true, value); }
+		void Empty() { SetText(std::basic_string_view<CharT>()); }
+
+		//Parsed value of the text, cached until the text or settings change
+		ParseStatus GetValue(uint64_t& value)
+		{
+			NUMERIC_RADIX_PROBE(m_traceStats, AsValue);
+
+			if (!m_bValueCached)
+			{
+				m_cachedStatus = ParseValueInternal(m_text, m_cachedValue);
+				m_bValueCached = true;
+			}
+
+			value = m_cachedStatus == ParseStatus::Ok ? m_cachedValue : 0;
+			return m_cachedStatus;
+		}
+
+		//WM_CHAR: backspace, or a character subject to the keystroke rule. Returns false if the
+		//character was rejected
+		bool Char(uint32_t ch)
+		{
+			NUMERIC_RADIX_PROBE(m_traceStats, OnChar);
+
+			if (ch == BACKSPACE)
+			{
+				if (GetSelStart() == GetSelEnd() && m_nCaret)
+					m_nAnchor = m_nCaret - 1;
+
+				ReplaceSelection(nullptr, 0);
+				return true;
+			}
+
+			EditFormat format = GetFormat();
+			KeystrokeContext<CharT> context;
+			context.length = m_text.size();
+			context.selStart = GetSelStart();
+			context.selEnd = GetSelEnd();
+			context.first = m_text.size() > 0 ? m_text[0] : CharT(0);
+			context.second = m_text.size() > 1 ? m_text[1] : CharT(0);
+
+			bool bAllowed = IsEditKeystrokeInRange(format, context, ch, [&]() { return std::basic_string_view<CharT>(m_text); });
+
+			//Keystrokes refused only for their digits or value are beyond the bit width
+			NUMERIC_RADIX_COUNT_IF(m_traceStats, OverflowRejections, !bAllowed && IsEditKeystrokeAllowed(format, context, ch, SIZE_MAX));
+			if (!bAllowed)
+			{
+				NUMERIC_RADIX_COUNT(m_traceStats, RejectedKeystrokes);
+				return false;
+			}
+
+			CharT chText = static_cast<CharT>(ch);
+			ReplaceSelection(&chText, 1);
+			return true;
+		}
+
+		//WM_KEYDOWN: Ctrl+X, Ctrl+C and Ctrl+V are clipboard commands; other keys move the caret
+		//(extending the selection with Shift) or delete
+		void KeyDown(EditKey key, bool bShift, bool bControl)
+		{
+			NUMERIC_RADIX_PROBE(m_traceStats, OnKeyDown);
+
+			if (bControl && !bShift && (key == EditKey::X || key == EditKey::C || key == EditKey::V))
+			{
+				Command(key == EditKey::X ? EditCommand::Cut : (key == EditKey::C ? EditCommand::Copy : EditCommand::Paste));
+				return;
+			}
+
+			size_t nStart = GetSelStart();
+			size_t nEnd = GetSelEnd();
+			switch (key)
+			{
+				case EditKey::Left:		m_nCaret = (nStart != nEnd && !bShift) ? nStart : (m_nCaret ? m_nCaret - 1 : 0);
+										break;
+
+				case EditKey::Right:	m_nCaret = (nStart != nEnd && !bShift) ? nEnd : (m_nCaret < m_text.size() ? m_nCaret + 1 : m_nCaret);
+										break;
+
+				case EditKey::Home:		m_nCaret = 0;
+										break;
+
+				case EditKey::End:		m_nCaret = m_text.size();
+										break;
+
+				case EditKey::Delete:	if (nStart == nEnd && m_nCaret < m_text.size())
+											m_nAnchor = m_nCaret + 1;
+
+										ReplaceSelection(nullptr, 0);
+										return;
+
+				default:				return;
+			}
+
+			if (!bShift)
+				m_nAnchor = m_nCaret;
+		}
+
+		//OnCommand(). Cut and copy take all of the text, and paste replaces it with the value of
+		//the clipboard text (or empties the control if the clipboard text is not a valid value)
+		void Command(EditCommand command)
+		{
+			switch (command)
+			{
+				case EditCommand::Decimal:	ChangeMode(10);
+											return;
+
+				case EditCommand::Hex:		ChangeMode(16);
+											return;
+
+				case EditCommand::Octal:	ChangeMode(8);
+											return;
+
+				case EditCommand::Binary:	ChangeMode(2);
+											return;
+
+				case EditCommand::Cut:
+				case EditCommand::Copy:		{
+												NUMERIC_RADIX_PROBE(m_traceStats, Copy);
+
+												if (m_text.empty())
+													return;
+
+												m_clipboard.text = m_text;
+												if (command == EditCommand::Cut)
+													DisplayValue(false, 0);
+											}
+											return;
+
+				case EditCommand::Paste:	{
+												NUMERIC_RADIX_PROBE(m_traceStats, Paste);
+
+												std::basic_string_view<CharT> text(m_clipboard.text);
+												if (text.empty() || text[0] == CharT(0))
+													return;
+
+												uint64_t value = 0;
+												bool bValid = ParseValueInternal(text, value) == ParseStatus::Ok;
+												DisplayValue(bValid, value);
+											}
+											return;
+			}
+		}
+
+		//Parse the value in the current mode and display it in the new one
+		void ChangeMode(unsigned int radix)
+		{
+			if (radix == m_nRadix || !detail::IsSupportedRadix(radix))
+				return;
+
+			NUMERIC_RADIX_PROBE(m_traceStats, ChangeMode);
+
+			uint64_t value = 0;
+			bool bValid = GetValue(value) == ParseStatus::Ok;
+			m_nRadix = radix;
+			InvalidateValueCache();
+			DisplayValue(bValid, value);
+		}
+
+		//Regroup typed digits, or replace an expression with its value, if the text changes
+		void KillFocus()
+		{
+			EditFormat format = GetFormat();
+			uint64_t value = 0;
+			if ((format.grouping.groupSize || format.expression) && GetValue(value) == ParseStatus::Ok)
+			{
+				CharT szText[GROUPED_FORMAT_BUFFER_SIZE];
+				size_t nLength = format_fixed(format.radix, value, format.fixed, szText, GROUPED_FORMAT_BUFFER_SIZE, format.grouping);
+				if (std::basic_string_view<CharT>(szText, nLength) != std::basic_string_view<CharT>(m_text))
+					DisplayValue(true, value);
+			}
+		}
+
+#ifdef NUMERIC_RADIX_INSTRUMENT
+		const trace::Stats& GetTraceStats() const noexcept { return m_traceStats; }
+		void ResetTraceStats() noexcept { m_traceStats.Reset(); }
+#endif
+
+	private:
+		//Index of a radix in the control's EDisplayMode order
+		static constexpr size_t ModeIndex(unsigned int radix) noexcept
+		{
+			return radix == 16 ? 1 : (radix == 8 ? 2 : (radix == 2 ? 3 : 0));
+		}
+
+		ExprEvaluator<CharT>& Evaluator()
+		{
+			if (!m_pEvaluator)
+				m_pEvaluator = std::make_unique<ExprEvaluator<CharT>>();
+
+			return *m_pEvaluator;
+		}
+
+		void InvalidateValueCache() noexcept { m_bValueCached = false; }
+
+		ParseStatus ParseValueInternal(std::basic_string_view<CharT> text, uint64_t& value)
+		{
+			EditFormat format = GetFormat();
+			ParseStatus status = ParseStatus::Invalid;
+			if (format.expression)
+			{
+				ExprResult result = FitExprResult(Evaluator().Evaluate(text, ExprOptions{ format.radix, format.fixed.isSigned }), format.fixed, format.radix);
+				status = ExprParseStatus(result.status);
+				if (status == ParseStatus::Ok)
+					value = result.value;
+			}
+
+			else
+				status = parse_fixed(format.radix, text, format.fixed, value);
+
+			NUMERIC_RADIX_COUNT_IF(m_traceStats, ParseFailures, status == ParseStatus::Invalid);
+			NUMERIC_RADIX_COUNT_IF(m_traceStats, OverflowRejections, status == ParseStatus::OutOfRange);
+			return status;
+		}
+
+		//Display a value, or empty the text if bValid is false. The text parses back to the value,
+		//so the cache is primed
+		void DisplayValue(bool bValid, uint64_t value)
+		{
+			NUMERIC_RADIX_PROBE(m_traceStats, UpdateControl);
+
+			EditFormat format = GetFormat();
+			CharT szText[GROUPED_FORMAT_BUFFER_SIZE];
+			size_t nLength = 0;
+			if (bValid)
+			{
+				value = FitToWidth(value, format.fixed);
+				nLength = format_fixed(format.radix, value, format.fixed, szText, GROUPED_FORMAT_BUFFER_SIZE, format.grouping);
+			}
+
+			SetText(std::basic_string_view<CharT>(szText, nLength));
+			m_cachedStatus = bValid ? ParseStatus::Ok : ParseStatus::Empty;
+			m_cachedValue = value;
+			m_bValueCached = true;
+		}
+
+		//Replace the selection with text and put the caret after it
+		void ReplaceSelection(const CharT* pText, size_t nLength)
+		{
+			size_t nStart = GetSelStart();
+			m_text.replace(nStart, GetSelEnd() - nStart, pText ? pText : m_text.data(), nLength);
+			m_nCaret = m_nAnchor = nStart + nLength;
+			InvalidateValueCache();
+		}
+
+		EditClipboard<CharT>& m_clipboard;
+		std::basic_string<CharT> m_text;
+		size_t m_nCaret = 0;
+		size_t m_nAnchor = 0;
+
+		unsigned int m_nRadix = 10;
+		unsigned int m_nBits = 64;
+		bool m_bSigned = false;
+		bool m_bExpression = false;
+		unsigned int m_nGroupDigits[4];
+		std::unique_ptr<ExprEvaluator<CharT>> m_pEvaluator;
+
+		bool m_bValueCached = false;
+		ParseStatus m_cachedStatus = ParseStatus::Empty;
+		uint64_t m_cachedValue = 0;
+
+#ifdef NUMERIC_RADIX_INSTRUMENT
+		trace::Stats m_traceStats = {};
+#endif
+	};
+}
@@ -0,0 +1,308 @@
+#pragma once
+
+/*
+	NumericRadixParallel.h
+
+	Multi-threaded versions of the NumericRadix.h batch conversions for very large inputs such as
+	memory-dump columns. The input is split into fixed-size chunks that are claimed dynamically
+	from a shared counter by the calling thread and a set of helper threads, so faster threads
+	take more chunks and the load stays balanced. Every element is written only to its own slot
+	and chunks are multiples of 8 elements, so no two threads share a byte of the validity bitmap
+	and the output is identical to the serial batch functions regardless of thread count.
+
+	Helpers come from a ParallelPool passed in the options, whose threads park between calls so
+	repeated conversions do not pay to create and join threads. Calls made at the same time, from
+	several threads or from inside a chunk, share the pool's threads: each call runs its own
+	chunks and an idle helper joins whichever call has fewest helpers. Without a pool, helpers are
+	started and joined for the call.
+
+	The pool has an explicit owner rather than being a static, because its destructor joins its
+	threads. In a DLL that must happen before unload (e.g. in ExitInstance()), not from a static
+	destructor or DllMain(), which run under the loader lock that exiting threads need.
+
+	Inputs smaller than the serial threshold, or a thread count of 1, run the serial batch
+	function directly on the calling thread.
+
+	MIT License for CNumericEditControl:
+
+	Copyright (c) 2019-2020 Data Synergy UK Ltd
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "NumericRadix.h"
+
+namespace numeric_radix
+{
+	class ParallelPool;
+
+	struct ParallelOptions
+	{
+		//Number of threads including the caller (0: one per hardware thread)
+		unsigned int threadCount = 0;
+
+		//Elements per chunk (0: sized so a chunk's input and output stay within L2)
+		size_t chunkSize = 0;
+
+		//Inputs with fewer elements than this are converted serially
+		size_t serialThreshold = 64 * 1024;
+
+		//Parked helper threads to take (nullptr: helpers are started and joined for the call)
+		ParallelPool* pool = nullptr;
+	};
+
+	//Helper threads for the parallel conversions of every thread that passes the pool in its
+	//ParallelOptions. The constructor starts the threads and the destructor joins them; it must
+	//not run while a conversion is using the pool
+	class ParallelPool
+	{
+	public:
+		//threadCount helpers (0: one fewer than the hardware threads, the caller being the other).
+		//If a thread cannot be started the pool stays smaller and the callers take more chunks
+		explicit ParallelPool(unsigned int threadCount = 0)
+		{
+			if (!threadCount)
+			{
+				unsigned int nHardware = std::thread::hardware_concurrency();
+				threadCount = nHardware > 1 ? nHardware - 1 : 1;
+			}
+
+			m_threads.reserve(threadCount);
+			for (unsigned int i = 0; i < threadCount; ++i)
+			{
+				try
+				{
+					m_threads.emplace_back(&ParallelPool::Work, this);
+				}
+				catch (const std::system_error&)
+				{
+					break;
+				}
+			}
+		}
+
+		~ParallelPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_bStop = true;
+			}
+
+			m_wake.notify_all();
+			for (std::thread& thread : m_threads)
+				thread.join();
+		}
+
+		ParallelPool(const ParallelPool&) = delete;
+		ParallelPool& operator=(const ParallelPool&) = delete;
+
+		size_t GetThreadCount() const noexcept
+		{
+			return m_threads.size();
+		}
+
+		//Run fnJob on the calling thread and on up to nHelpers idle helpers. fnJob must return
+		//once there is no work left, and helpers that have not started it by the time the
+		//caller's own run returns are not given it. Any number of threads may call Run() at
+		//once, including from inside a job; an idle helper joins the open job with fewest helpers
+		template <typename JobFn>
+		void Run(unsigned int nHelpers, JobFn& fnJob)
+		{
+			Job job;
+			job.pfnRun = [](void* pContext) { (*static_cast<JobFn*>(pContext))(); };
+			job.pContext = &fnJob;
+			job.nWanted = nHelpers;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_jobs.push_back(&job);
+			}
+
+			m_wake.notify_all();
+			fnJob();
+
+			//Close the job to helpers that have not claimed it, and wait for those that have
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_jobs.erase(std::find(m_jobs.begin(), m_jobs.end(), &job));
+			m_done.wait(lock, [&]() { return job.nFinished == job.nClaimed; });
+		}
+
+	private:
+		struct Job
+		{
+			void (*pfnRun)(void*) = nullptr;
+			void* pContext = nullptr;
+			unsigned int nWanted = 0;
+			unsigned int nClaimed = 0;
+			unsigned int nFinished = 0;
+		};
+
+		//The open job that wants a helper and has fewest, or nullptr
+		Job* FindJob() const noexcept
+		{
+			Job* pBest = nullptr;
+			for (Job* pJob : m_jobs)
+			{
+				if (pJob->nClaimed < pJob->nWanted && (!pBest || pJob->nClaimed < pBest->nClaimed))
+					pBest = pJob;
+			}
+
+			return pBest;
+		}
+
+		void Work()
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			for (;;)
+			{
+				Job* pJob = nullptr;
+				m_wake.wait(lock, [&]() { return m_bStop || (pJob = FindJob()) != nullptr; });
+				if (m_bStop)
+					return;
+
+				++pJob->nClaimed;
+				lock.unlock();
+				pJob->pfnRun(pJob->pContext);
+				lock.lock();
+
+				if (++pJob->nFinished == pJob->nClaimed)
+					m_done.notify_all();
+			}
+		}
+
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		std::condition_variable m_done;
+		std::vector<std::thread> m_threads;
+		std::vector<Job*> m_jobs;
+		bool m_bStop = false;
+	};
+
+	namespace detail
+	{
+		//Default chunk: ~256KB of working set, assuming about 64 bytes of input and output per element
+		constexpr size_t DEFAULT_CHUNK_BYTES = 256 * 1024;
+		constexpr size_t BYTES_PER_ELEMENT = 64;
+
+		//Run fnChunk(first, count) over [0, count) in chunks on up to threadCount threads
+		template <typename ChunkFn>
+		inline void ParallelChunks(size_t count, size_t bytesPerElement, const ParallelOptions& options, ChunkFn fnChunk)
+		{
+			unsigned int nThreads = options.threadCount ? options.threadCount : std::thread::hardware_concurrency();
+			size_t nChunkSize = options.chunkSize ? options.chunkSize : DEFAULT_CHUNK_BYTES / (bytesPerElement ? bytesPerElement : 1);
+
+			//Whole bitmap bytes per chunk: at least 8 elements (elements wider than the default
+			//chunk leave 0), and sizes within 7 of SIZE_MAX round down rather than wrap to 0
+			constexpr size_t nMaxChunkSize = SIZE_MAX & ~static_cast<size_t>(7);
+			if (nChunkSize < 8)
+				nChunkSize = 8;
+
+			else if (nChunkSize > nMaxChunkSize)
+				nChunkSize = nMaxChunkSize;
+
+			else
+				nChunkSize = (nChunkSize + 7) & ~static_cast<size_t>(7);
+
+			size_t nChunks = count / nChunkSize + (count % nChunkSize != 0);
+			if (nThreads > nChunks)
+				nThreads = static_cast<unsigned int>(nChunks);
+
+			if (nThreads <= 1 || count < options.serialThreshold)
+			{
+				fnChunk(0, count);
+				return;
+			}
+
+			std::atomic<size_t> nextChunk{ 0 };
+			auto worker = [&]()
+			{
+				for (size_t nChunk = nextChunk.fetch_add(1, std::memory_order_relaxed); nChunk < nChunks;
+					nChunk = nextChunk.fetch_add(1, std::memory_order_relaxed))
+				{
+					size_t nFirst = nChunk * nChunkSize;
+					fnChunk(nFirst, count - nFirst < nChunkSize ? count - nFirst : nChunkSize);
+				}
+			};
+
+			if (options.pool)
+			{
+				options.pool->Run(nThreads - 1, worker);
+				return;
+			}
+
+			//If a helper thread cannot be started the remaining threads, including the caller,
+			//simply take more chunks
+			std::vector<std::thread> helpers;
+			helpers.reserve(nThreads - 1);
+			for (unsigned int i = 1; i < nThreads; ++i)
+			{
+				try
+				{
+					helpers.emplace_back(worker);
+				}
+				catch (const std::system_error&)
+				{
+					break;
+				}
+			}
+
+			worker();
+
+			for (std::thread& helper : helpers)
+				helper.join();
+		}
+	}
+
+	//Parallel parse_batch(). Returns the number of valid elements
+	template <typename CharT, typename ValueT>
+	inline size_t parallel_parse_batch(unsigned int radix, const std::basic_string_view<CharT>* texts, size_t count, ValueT* values,
+		uint8_t* validBits, const ParallelOptions& options = ParallelOptions())
+	{
+		std::atomic<size_t> nValid{ 0 };
+		detail::ParallelChunks(count, detail::BYTES_PER_ELEMENT, options, [&](size_t nFirst, size_t nCount)
+		{
+			size_t nChunkValid = parse_batch(radix, texts + nFirst, nCount, values + nFirst, validBits ? validBits + nFirst / 8 : nullptr);
+			nValid.fetch_add(nChunkValid, std::memory_order_relaxed);
+		});
+
+		return nValid.load();
+	}
+
+	//Parallel format_batch(). Returns the total number of characters written
+	template <typename CharT, typename ValueT>
+	inline size_t parallel_format_batch(unsigned int radix, const ValueT* values, size_t count, CharT* buffer, size_t stride,
+		size_t* lengths, const ParallelOptions& options = ParallelOptions())
+	{
+		std::atomic<size_t> nTotal{ 0 };
+		detail::ParallelChunks(count, sizeof(ValueT) + stride * sizeof(CharT), options, [&](size_t nFirst, size_t nCount)
+		{
+			size_t nChunkTotal = format_batch(radix, values + nFirst, nCount, buffer + nFirst * stride, stride, lengths ? lengths + nFirst : nullptr);
+			nTotal.fetch_add(nChunkTotal, std::memory_order_relaxed);
+		});
+
+		return nTotal.load();
+	}
+}
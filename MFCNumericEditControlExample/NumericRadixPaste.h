@@ -0,0 +1,264 @@
+#pragma once
+
+/*
+	NumericRadixPaste.h
+
+	Multi-value paste for tables copied from Windows Calculator, Excel, CSV files and hex dumps.
+	The text is split into tokens at line breaks, tabs and semicolons, and each token is parsed
+	in the current display radix with the same rules as a single value (see NumericRadix.h), so
+	commas and spaces inside a token are digit grouping, not delimiters. Blank tokens, such as
+	the empty token between CR and LF or after a trailing line break, are skipped.
+
+	parse_paste() with a FixedFormat checks each token against the width and signedness as
+	parse_fixed() does (see NumericRadixSigned.h), and parse_paste_with() takes any parser, such
+	as a control's own, so that a pasted token is accepted exactly when the same text typed into
+	the control would be. Without either, tokens are plain 64-bit unsigned values.
+
+	The text is read once, front to back, directly from the caller's buffer (e.g. the locked
+	clipboard memory) and ends at a NUL or at the buffer capacity. for_each_token() does not
+	allocate. parse_paste() only allocates its result vectors: it counts the delimiters first and
+	reserves for that many tokens, and reads at most maxTokens tokens (DEFAULT_MAX_PASTE_TOKENS
+	unless given), so a huge clipboard cannot grow them without bound.
+
+	MIT License for CNumericEditControl:
+
+	Copyright (c) 2019-2020 Data Synergy UK Ltd
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include <type_traits>
+#include <vector>
+
+#include "NumericRadixSigned.h"
+
+namespace numeric_radix
+{
+	namespace detail
+	{
+		//Bit n set for each delimiter character n, and for NUL in the token end mask
+		constexpr uint64_t DELIMITER_MASK = (uint64_t(1) << '\n') | (uint64_t(1) << '\r') | (uint64_t(1) << '\t') | (uint64_t(1) << ';');
+		constexpr uint64_t TOKEN_END_MASK = DELIMITER_MASK | 1;
+
+		template <typename CharT>
+		constexpr bool InMask(CharT ch, uint64_t mask) noexcept
+		{
+			auto uch = static_cast<std::make_unsigned_t<CharT>>(ch);
+			return uch < 64 && ((mask >> uch) & 1);
+		}
+	}
+
+	//Token delimiters: line breaks, tabs (Excel columns) and semicolons (CSV)
+	template <typename CharT>
+	constexpr bool IsTokenDelimiter(CharT ch) noexcept
+	{
+		return detail::InMask(ch, detail::DELIMITER_MASK);
+	}
+
+	//Tokens parse_paste() reads unless told otherwise: 8MB of values
+	constexpr size_t DEFAULT_MAX_PASTE_TOKENS = 1024 * 1024;
+
+	//A token that did not parse: its index among the non-blank tokens, its position and length
+	//in characters from the start of the buffer, and whether it is Invalid or OutOfRange
+	struct PasteError
+	{
+		size_t index;
+		size_t offset;
+		size_t length;
+		ParseStatus status;
+	};
+
+	//One value per non-blank token, in order. Tokens that did not parse hold all ones (as
+	//parse_batch()) and are listed in errors
+	struct PasteResult
+	{
+		std::vector<uint64_t> values;
+		std::vector<PasteError> errors;
+	};
+
+	namespace detail
+	{
+		template <typename CharT>
+		constexpr bool IsBlank(std::basic_string_view<CharT> text) noexcept
+		{
+			for (CharT ch : text)
+			{
+				if (!IsSpace(ch) && !IsSeparator(ch))
+					return false;
+			}
+
+			return true;
+		}
+
+		//First token end (NUL or delimiter) in [p, pEnd), or pEnd. 8- and 16-bit text is scanned a
+		//lane at a time (see NumericRadixSimd.h)
+		template <typename CharT>
+		inline const CharT* FindTokenEnd(const CharT* p, const CharT* pEnd) noexcept
+		{
+			if constexpr (sizeof(CharT) == 1 || sizeof(CharT) == 2)
+			{
+				using LaneT = std::conditional_t<sizeof(CharT) == 1, uint8_t, uint16_t>;
+				p = reinterpret_cast<const CharT*>(simd::FindTokenEnd(reinterpret_cast<const LaneT*>(p), reinterpret_cast<const LaneT*>(pEnd)));
+			}
+
+			while (p != pEnd && !InMask(*p, TOKEN_END_MASK))
+				++p;
+
+			return p;
+		}
+
+		//Tokens that buffer can hold, up to maxTokens: one more than its delimiters before the end
+		template <typename CharT>
+		inline size_t MaxTokenCount(const CharT* buffer, size_t capacity, size_t maxTokens) noexcept
+		{
+			const CharT* pEnd = buffer + capacity;
+			size_t nTokens = 1;
+			for (const CharT* p = FindTokenEnd(buffer, pEnd); nTokens < maxTokens && p != pEnd && *p != CharT(0); p = FindTokenEnd(p + 1, pEnd))
+				++nTokens;
+
+			return nTokens < maxTokens ? nTokens : maxTokens;
+		}
+
+		//fnParse(token, value) returns the token's ParseStatus; Empty tokens are skipped
+		template <typename CharT, typename ParseFn, typename TokenFn>
+		inline size_t ForEachToken(const CharT* buffer, size_t capacity, size_t maxTokens, ParseFn& fnParse, TokenFn& fnToken)
+		{
+			const CharT* pEnd = buffer + capacity;
+			const CharT* p = buffer;
+			size_t nTokens = 0;
+
+			while (nTokens < maxTokens)
+			{
+				const CharT* pToken = p;
+				p = FindTokenEnd(p, pEnd);
+
+				std::basic_string_view<CharT> token(pToken, static_cast<size_t>(p - pToken));
+				if (!token.empty())
+				{
+					uint64_t value = UINT64_MAX;
+					ParseStatus status = fnParse(token, value);
+					if (status != ParseStatus::Empty)
+						fnToken(nTokens++, static_cast<size_t>(pToken - buffer), token.size(), status, status == ParseStatus::Ok ? value : UINT64_MAX);
+				}
+
+				if (p == pEnd || *p == CharT(0))
+					break;
+
+				++p;
+			}
+
+			return nTokens;
+		}
+
+		//Plain 64-bit parse(). Blank tokens never parse, so they are only looked for among the
+		//failures
+		template <unsigned int Radix, typename CharT, typename TokenFn>
+		inline size_t ForEachToken(const CharT* buffer, size_t capacity, size_t maxTokens, TokenFn& fnToken)
+		{
+			auto fnParse = [](std::basic_string_view<CharT> token, uint64_t& value)
+			{
+				if (parse<Radix>(token, value))
+					return ParseStatus::Ok;
+
+				return IsBlank(token) ? ParseStatus::Empty : ParseStatus::Invalid;
+			};
+
+			auto fnValid = [&](size_t index, size_t offset, size_t length, ParseStatus status, uint64_t value)
+			{
+				fnToken(index, offset, length, status == ParseStatus::Ok, value);
+			};
+
+			return ForEachToken(buffer, capacity, maxTokens, fnParse, fnValid);
+		}
+	}
+
+	//Call fnToken(index, offset, length, valid, value) for each non-blank token of a NUL-terminated
+	//buffer of at most capacity characters, stopping after maxTokens tokens. Returns the number of
+	//tokens. Unsupported radices produce no tokens.
+	template <typename CharT, typename TokenFn>
+	inline size_t for_each_token(unsigned int radix, const CharT* buffer, size_t capacity, TokenFn fnToken, size_t maxTokens = SIZE_MAX)
+	{
+		if (!buffer)
+			return 0;
+
+		switch (radix)
+		{
+			case 2:		return detail::ForEachToken<2>(buffer, capacity, maxTokens, fnToken);
+			case 8:		return detail::ForEachToken<8>(buffer, capacity, maxTokens, fnToken);
+			case 10:	return detail::ForEachToken<10>(buffer, capacity, maxTokens, fnToken);
+			case 16:	return detail::ForEachToken<16>(buffer, capacity, maxTokens, fnToken);
+			default:	return 0;
+		}
+	}
+
+	//Parse every token of a pasted table with fnParse(token, value), which returns a ParseStatus.
+	//Tokens it reports as Empty are skipped
+	template <typename CharT, typename ParseFn>
+	inline PasteResult parse_paste_with(const CharT* buffer, size_t capacity, ParseFn fnParse, size_t maxTokens = DEFAULT_MAX_PASTE_TOKENS)
+	{
+		PasteResult result;
+		if (!buffer)
+			return result;
+
+		result.values.reserve(detail::MaxTokenCount(buffer, capacity, maxTokens));
+
+		auto fnToken = [&](size_t index, size_t offset, size_t length, ParseStatus status, uint64_t value)
+		{
+			result.values.push_back(value);
+			if (status != ParseStatus::Ok)
+				result.errors.push_back(PasteError{ index, offset, length, status });
+		};
+
+		detail::ForEachToken(buffer, capacity, maxTokens, fnParse, fnToken);
+		return result;
+	}
+
+	//Parse every token of a pasted table as a 64-bit unsigned value
+	template <typename CharT>
+	inline PasteResult parse_paste(unsigned int radix, const CharT* buffer, size_t capacity, size_t maxTokens = DEFAULT_MAX_PASTE_TOKENS)
+	{
+		PasteResult result;
+		if (!buffer || !detail::IsSupportedRadix(radix))
+			return result;
+
+		result.values.reserve(detail::MaxTokenCount(buffer, capacity, maxTokens));
+		for_each_token(radix, buffer, capacity, [&](size_t index, size_t offset, size_t length, bool valid, uint64_t value)
+		{
+			result.values.push_back(value);
+			if (!valid)
+				result.errors.push_back(PasteError{ index, offset, length, ParseStatus::Invalid });
+		}, maxTokens);
+
+		return result;
+	}
+
+	//Parse every token of a pasted table as a value of a fixed width and signedness. Tokens that
+	//are numbers but do not fit are OutOfRange
+	template <typename CharT>
+	inline PasteResult parse_paste(unsigned int radix, const CharT* buffer, size_t capacity, FixedFormat fixed, size_t maxTokens = DEFAULT_MAX_PASTE_TOKENS)
+	{
+		if (!detail::IsSupportedRadix(radix))
+			return PasteResult();
+
+		return parse_paste_with(buffer, capacity, [=](std::basic_string_view<CharT> token, uint64_t& value)
+		{
+			return parse_fixed(radix, token, fixed, value);
+		}, maxTokens);
+	}
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+/*
+	NumericRadixPublish.h
+
+	Latest-value-wins slot for values produced faster than they can be displayed, e.g. by a thread
+	polling hardware at several kHz. Any number of threads publish into the slot without locking,
+	waiting or sending window messages; one consumer (the UI thread, once per frame or timer tick)
+	takes the latest value, and every value published in between is coalesced into it.
+
+	The slot is a 64-bit value and a publish counter. A publisher stores the value and then
+	increments the counter with release ordering, so a consumer that sees the new count also sees
+	that value or a later one. The consumer reads the counter again after the value and retries if
+	a publish completed in between, so a value is taken with the count that published it. A
+	publish still in progress, its value stored but not yet counted, cannot be told apart: its
+	value may be taken early and then again once it is counted, and the coalesced count is then
+	one short. The consumer never takes an older value after a newer one.
+
+	MIT License for CNumericEditControl:
+
+	Copyright (c) 2019-2020 Data Synergy UK Ltd
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include <atomic>
+#include <cstdint>
+
+namespace numeric_radix
+{
+	struct ValueSlotStats
+	{
+		uint64_t published;		//Values published
+		uint64_t taken;			//Values taken by the consumer
+		uint64_t coalesced;		//Values overwritten before the consumer took them
+	};
+
+	class ValueSlot
+	{
+	public:
+		ValueSlot() = default;
+		ValueSlot(const ValueSlot&) = delete;
+		ValueSlot& operator=(const ValueSlot&) = delete;
+
+		//Any thread
+		void Publish(uint64_t value) noexcept
+		{
+			m_value.store(value, std::memory_order_relaxed);
+			m_nPublished.fetch_add(1, std::memory_order_release);
+		}
+
+		//Consumer thread only: true if a value was published since the last Take()
+		bool IsPending() const noexcept
+		{
+			return m_nPublished.load(std::memory_order_relaxed) != m_nTakenCount;
+		}
+
+		//Consumer thread only: the latest value, or false if nothing was published since the last
+		//Take()
+		bool Take(uint64_t& value) noexcept
+		{
+			uint64_t nPublished = m_nPublished.load(std::memory_order_acquire);
+			for (;;)
+			{
+				if (nPublished == m_nTakenCount)
+					return false;
+
+				value = m_value.load(std::memory_order_acquire);
+				uint64_t nCheck = m_nPublished.load(std::memory_order_acquire);
+				if (nCheck == nPublished)
+					break;
+
+				nPublished = nCheck;
+			}
+
+			m_nCoalesced += nPublished - m_nTakenCount - 1;
+			m_nTakenCount = nPublished;
+			++m_nTaken;
+			return true;
+		}
+
+		//Consumer thread only
+		ValueSlotStats GetStats() const noexcept
+		{
+			uint64_t nPublished = m_nPublished.load(std::memory_order_relaxed);
+			return ValueSlotStats{ nPublished - m_nStatsBase, m_nTaken, m_nCoalesced };
+		}
+
+		void ResetStats() noexcept
+		{
+			m_nStatsBase = m_nPublished.load(std::memory_order_relaxed);
+			m_nTaken = 0;
+			m_nCoalesced = 0;
+		}
+
+	private:
+		//Publishers write a different cache line from the consumer's state
+		alignas(64) std::atomic<uint64_t> m_value{ 0 };
+		std::atomic<uint64_t> m_nPublished{ 0 };
+
+		alignas(64) uint64_t m_nTakenCount = 0;
+		uint64_t m_nTaken = 0;
+		uint64_t m_nCoalesced = 0;
+		uint64_t m_nStatsBase = 0;
+	};
+}
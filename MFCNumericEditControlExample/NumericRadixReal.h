@@ -0,0 +1,586 @@
+#pragma once
+
+/*
+	NumericRadixReal.h
+
+	Floating-point and fixed-point values for the NumericRadix.h engine: IEEE-754 float and
+	double, and Qm.n fixed-point register values. Values are passed as their bit patterns, so a
+	real value shows in hex, octal and binary with format_fixed() at its width.
+
+	Floats format as the shortest text that reads back as the same value, and parse exactly,
+	correctly rounded. The shortest digits come from std::to_chars() (Ryu in the MSVC library),
+	and parsing takes a Clinger fast path for short decimal input, in which the digits and the
+	power of ten are both exact doubles so one multiply or divide rounds correctly; anything else
+	goes to std::from_chars() (Eisel-Lemire in current libraries). Float text also accepts
+	hex-float input ("0x1.8p3", as C99 "%a" prints it).
+
+	Qm.n is a two's complement or unsigned value of m + n bits with n fraction bits, where m
+	includes the sign bit when signed (Q1.15 and Q16.16 are 16 and 32-bit signed formats). The
+	text is exact: a fraction of n bits has at most n decimal digits, and their number is known
+	from the lowest set bit before anything is written. Parsing rounds to the nearest multiple of
+	2^-n, ties to even.
+
+	Separators are ignored in all real text, as in parse(). Real text is at most
+	REAL_FORMAT_BUFFER_SIZE - 1 characters long; longer input is Invalid.
+
+	MIT License for CNumericEditControl:
+
+	Copyright (c) 2019-2020 Data Synergy UK Ltd
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+#include "NumericRadixSigned.h"
+
+namespace numeric_radix
+{
+	//Longest real text: a Qm.n value with a sign, 20 integer digits, a point and 63 fraction digits
+	constexpr size_t REAL_FORMAT_BUFFER_SIZE = 88;
+
+	//Qm.n fixed point: intBits + fracBits bits, 1 to 64, of which fracBits (up to 63) are fraction
+	struct QFormat
+	{
+		unsigned int intBits = 1;
+		unsigned int fracBits = 15;
+		bool isSigned = true;
+	};
+
+	constexpr unsigned int QWidth(QFormat q) noexcept
+	{
+		return q.intBits + q.fracBits;
+	}
+
+	constexpr bool IsValidQFormat(QFormat q) noexcept
+	{
+		return q.fracBits < 64 && QWidth(q) >= 1 && QWidth(q) <= 64 && (!q.isSigned || q.intBits >= 1);
+	}
+
+	//Bit patterns of floats, zero-extended
+	template <typename T>
+	inline uint64_t FloatBits(T value) noexcept
+	{
+		static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>, "float or double");
+
+		std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t> bits = 0;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	template <typename T>
+	inline T FloatFromBits(uint64_t bits) noexcept
+	{
+		static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>, "float or double");
+
+		std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t> pattern = static_cast<decltype(pattern)>(bits);
+		T value = 0;
+		std::memcpy(&value, &pattern, sizeof(value));
+		return value;
+	}
+
+	//Value of a Qm.n bit pattern
+	inline double QToDouble(uint64_t raw, QFormat q) noexcept
+	{
+		uint64_t nPattern = raw & WidthMask(QWidth(q));
+		double dValue = q.isSigned ? static_cast<double>(static_cast<int64_t>(SignExtend(nPattern, QWidth(q)))) : static_cast<double>(nPattern);
+		return std::ldexp(dValue, -static_cast<int>(q.fracBits));
+	}
+
+	//Nearest Qm.n bit pattern to value (ties to even), sign-extended when signed. Returns false
+	//if the value is NaN or out of range
+	inline bool DoubleToQ(double value, QFormat q, uint64_t& raw) noexcept
+	{
+		if (!IsValidQFormat(q))
+			return false;
+
+		double dScaled = std::nearbyint(std::ldexp(value, static_cast<int>(q.fracBits)));
+		unsigned int nWidth = QWidth(q);
+		double dLow = q.isSigned ? -std::ldexp(1.0, nWidth - 1) : 0.0;
+		double dHigh = std::ldexp(1.0, q.isSigned ? nWidth - 1 : nWidth);
+		if (!(dScaled >= dLow && dScaled < dHigh))
+			return false;
+
+		raw = q.isSigned ? static_cast<uint64_t>(static_cast<int64_t>(dScaled)) : static_cast<uint64_t>(dScaled);
+		return true;
+	}
+
+	namespace detail
+	{
+		constexpr unsigned int CountTrailingZeros(uint64_t value) noexcept
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return value ? static_cast<unsigned int>(__builtin_ctzll(value)) : 64;
+#else
+			unsigned int nZeros = 0;
+			for (; nZeros < 64 && !(value & 1); ++nZeros)
+				value >>= 1;
+
+			return nZeros;
+#endif
+		}
+
+		//Narrow real text into a char buffer with separators removed, up to a NUL or the end of the
+		//view. Returns the length, or SIZE_MAX if the text is too long or not ASCII
+		template <typename CharT>
+		constexpr size_t NarrowRealText(std::basic_string_view<CharT> text, char* buffer, size_t bufferSize) noexcept
+		{
+			size_t nLength = 0;
+			for (CharT ch : text)
+			{
+				if (ch == CharT(0))
+					break;
+
+				if (IsSeparator(ch))
+					continue;
+
+				if (nLength + 1 >= bufferSize || CharCode(ch) > 0x7F)
+					return SIZE_MAX;
+
+				buffer[nLength++] = static_cast<char>(ch);
+			}
+
+			buffer[nLength] = 0;
+			return nLength;
+		}
+
+		//Powers of ten exact in a double (up to 10^22, 5^22 < 2^53)
+		constexpr double EXACT_POW10[23] =
+		{
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+		};
+
+		//Powers of five up to the largest below 2^64
+		constexpr std::array<uint64_t, 28> MakePow5() noexcept
+		{
+			std::array<uint64_t, 28> table = {};
+			uint64_t nPower = 1;
+			for (uint64_t& nEntry : table)
+			{
+				nEntry = nPower;
+				nPower *= 5;
+			}
+
+			return table;
+		}
+
+		constexpr std::array<uint64_t, 28> POW5 = MakePow5();
+
+		//The first nFracBits bits of the fraction D / 10^k, as D * 2^(n - k) / 5^k when the numerator
+		//and denominator both fit in 64 bits (typically up to 19 digits), and the remainder against
+		//one half: negative, zero or positive. Returns false if they do not fit
+		constexpr bool DivideFraction(const uint8_t* pDigits, size_t nDigits, unsigned int nFracBits, uint64_t& nBits, int& nHalf) noexcept
+		{
+			if (nDigits > 19)
+				return false;
+
+			uint64_t nNumerator = 0;
+			for (size_t i = 0; i < nDigits; ++i)
+				nNumerator = nNumerator * 10 + pDigits[i];
+
+			uint64_t nDenominator = POW5[nDigits];
+			if (nFracBits >= nDigits)
+			{
+				unsigned int nShift = nFracBits - static_cast<unsigned int>(nDigits);
+				if (BitLength(nNumerator) + nShift > 64)
+					return false;
+
+				nNumerator <<= nShift;
+			}
+			else
+			{
+				unsigned int nShift = static_cast<unsigned int>(nDigits) - nFracBits;
+				if (BitLength(nDenominator) + nShift > 64)
+					return false;
+
+				nDenominator <<= nShift;
+			}
+
+			nBits = nNumerator / nDenominator;
+			uint64_t nRemainder = nNumerator - nBits * nDenominator;
+			nHalf = nRemainder < nDenominator - nRemainder ? -1 : (nRemainder > nDenominator - nRemainder ? 1 : 0);
+			return true;
+		}
+
+		//Clinger's fast path: digits[.digits][e[sign]digits] whose significand and power of ten are
+		//both exact in T. Returns false, leaving value unchanged, for anything else
+		template <typename T>
+		inline bool ParseFloatFast(const char* p, const char* pEnd, T& value) noexcept
+		{
+			constexpr uint64_t nMaxSignificand = std::is_same_v<T, float> ? (1ull << 24) : (1ull << 53);
+			constexpr int nMaxPower = std::is_same_v<T, float> ? 10 : 22;
+
+			uint64_t nSignificand = 0;
+			int nDigits = 0;
+			int nExponent = 0;
+			bool bAnyDigits = false;
+			bool bPoint = false;
+			for (; p != pEnd; ++p)
+			{
+				if (*p == '.' && !bPoint)
+				{
+					bPoint = true;
+					continue;
+				}
+
+				unsigned int nDigit = static_cast<unsigned int>(*p - '0');
+				if (nDigit > 9)
+					break;
+
+				bAnyDigits = true;
+				if (nSignificand || nDigit)
+				{
+					if (++nDigits > 19)
+						return false;
+
+					nSignificand = nSignificand * 10 + nDigit;
+				}
+
+				nExponent -= bPoint;
+			}
+
+			if (!bAnyDigits)
+				return false;
+
+			if (p != pEnd && (*p == 'e' || *p == 'E'))
+			{
+				++p;
+				bool bNegative = p != pEnd && *p == '-';
+				if (p != pEnd && (*p == '-' || *p == '+'))
+					++p;
+
+				if (p == pEnd)
+					return false;
+
+				int nPower = 0;
+				for (; p != pEnd && static_cast<unsigned int>(*p - '0') <= 9; ++p)
+				{
+					if (nPower > 1000)
+						return false;
+
+					nPower = nPower * 10 + (*p - '0');
+				}
+
+				nExponent += bNegative ? -nPower : nPower;
+			}
+
+			if (p != pEnd || nSignificand > nMaxSignificand)
+				return false;
+
+			if (nSignificand == 0)
+			{
+				value = 0;
+				return true;
+			}
+
+			if (nExponent < -nMaxPower || nExponent > nMaxPower)
+				return false;
+
+			T fValue = static_cast<T>(nSignificand);
+			T fPower = static_cast<T>(EXACT_POW10[nExponent < 0 ? -nExponent : nExponent]);
+			value = nExponent < 0 ? fValue / fPower : fValue * fPower;
+			return true;
+		}
+
+		//Fraction digits of a Qm.n value after the point: the fraction is multiplied by 10 and the
+		//bits above the fraction are the next digit. The product can need 68 bits, so it is formed
+		//in 32-bit halves
+		template <typename CharT>
+		constexpr void WriteFractionDigits(uint64_t nFraction, unsigned int nFracBits, CharT* p, size_t nDigits) noexcept
+		{
+			for (size_t i = 0; i < nDigits; ++i)
+			{
+				uint64_t nLow = (nFraction & 0xFFFFFFFF) * 10;
+				uint64_t nHigh = (nFraction >> 32) * 10 + (nLow >> 32);
+				nLow &= 0xFFFFFFFF;
+
+				//Below 32 fraction bits the product fits in 64 bits
+				unsigned int nDigit = 0;
+				if (nFracBits >= 32)
+				{
+					unsigned int nShift = nFracBits - 32;
+					nDigit = static_cast<unsigned int>(nHigh >> nShift);
+					nFraction = ((nHigh & ((1ull << nShift) - 1)) << 32) | nLow;
+				}
+				else
+				{
+					uint64_t nProduct = (nHigh << 32) | nLow;
+					nDigit = static_cast<unsigned int>(nProduct >> nFracBits);
+					nFraction = nProduct & ((1ull << nFracBits) - 1);
+				}
+
+				p[i] = CharT('0' + nDigit);
+			}
+		}
+	}
+
+	//Format a float or double as the shortest text that parses back to the same value ("0.1",
+	//"1e+16", "-inf", "nan"). Returns the number of characters written excluding the terminator,
+	//or 0 if the buffer is too small
+	template <typename T, typename CharT>
+	inline size_t format_float(T value, CharT* buffer, size_t bufferSize) noexcept
+	{
+		static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>, "float or double");
+
+		char szText[REAL_FORMAT_BUFFER_SIZE];
+		std::to_chars_result result = std::to_chars(szText, szText + sizeof(szText), value);
+		size_t nLength = static_cast<size_t>(result.ptr - szText);
+		if (result.ec != std::errc() || nLength >= bufferSize)
+			return 0;
+
+		for (size_t i = 0; i < nLength; ++i)
+			buffer[i] = CharT(szText[i]);
+
+		buffer[nLength] = CharT(0);
+		return nLength;
+	}
+
+	//Parse float text: leading white space, an optional sign, then a decimal number with an
+	//optional exponent, a hex float ("0x1.8p3", the exponent optional), "inf", "infinity" or
+	//"nan". value is only written when the status is Ok; magnitudes beyond the range of T are
+	//OutOfRange
+	template <typename T, typename CharT>
+	inline ParseStatus parse_float(std::basic_string_view<CharT> text, T& value) noexcept
+	{
+		static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>, "float or double");
+
+		char szText[REAL_FORMAT_BUFFER_SIZE];
+		size_t nLength = detail::NarrowRealText(text, szText, sizeof(szText));
+		if (nLength == SIZE_MAX)
+			return ParseStatus::Invalid;
+
+		const char* p = szText;
+		const char* pEnd = szText + nLength;
+		while (p != pEnd && IsSpace(*p))
+			++p;
+
+		if (p == pEnd)
+			return ParseStatus::Empty;
+
+		bool bNegative = *p == '-';
+		if (*p == '-' || *p == '+')
+			++p;
+
+		//std::from_chars() takes neither a "0x" prefix nor a '+', and must not see a second sign
+		if (p != pEnd && (*p == '-' || *p == '+'))
+			return ParseStatus::Invalid;
+
+		T fValue = 0;
+		std::from_chars_result result{ p, std::errc() };
+		if (pEnd - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X') && p[2] != '-' && p[2] != '+')
+			result = std::from_chars(p + 2, pEnd, fValue, std::chars_format::hex);
+
+		else if (detail::ParseFloatFast(p, pEnd, fValue))
+			result.ptr = pEnd;
+
+		else
+			result = std::from_chars(p, pEnd, fValue);
+
+		if (result.ec == std::errc::result_out_of_range)
+			return ParseStatus::OutOfRange;
+
+		if (result.ec != std::errc() || result.ptr != pEnd)
+			return ParseStatus::Invalid;
+
+		value = bNegative ? -fValue : fValue;
+		return ParseStatus::Ok;
+	}
+
+	//Format a Qm.n bit pattern (the low m + n bits of raw) as exact decimal text, with no
+	//trailing zeros after the point ("-1.5", "0.000030517578125"). Returns the number of
+	//characters written excluding the terminator, or 0 if the buffer is too small or the format
+	//is not valid
+	template <typename CharT>
+	constexpr size_t format_q(uint64_t raw, QFormat q, CharT* buffer, size_t bufferSize) noexcept
+	{
+		if (!IsValidQFormat(q))
+			return 0;
+
+		unsigned int nWidth = QWidth(q);
+		uint64_t nPattern = raw & WidthMask(nWidth);
+		bool bNegative = q.isSigned && (nPattern >> (nWidth - 1));
+		uint64_t nMagnitude = bNegative ? 0 - SignExtend(nPattern, nWidth) : nPattern;
+
+		uint64_t nInteger = q.fracBits ? nMagnitude >> q.fracBits : nMagnitude;
+		uint64_t nFraction = q.fracBits ? nMagnitude & WidthMask(q.fracBits) : 0;
+
+		//k / 2^n with k odd has exactly n decimal places
+		size_t nIntDigits = detail::FormattedDigits<10>(nInteger);
+		size_t nFracDigits = nFraction ? q.fracBits - detail::CountTrailingZeros(nFraction) : 0;
+		size_t nLength = bNegative + nIntDigits + (nFracDigits ? 1 + nFracDigits : 0);
+		if (nLength >= bufferSize)
+			return 0;
+
+		CharT* p = buffer;
+		if (bNegative)
+			*p++ = CharT('-');
+
+		detail::WriteDigits<10>(nInteger, p + nIntDigits, nIntDigits);
+		p += nIntDigits;
+		if (nFracDigits)
+		{
+			*p++ = CharT('.');
+			detail::WriteFractionDigits(nFraction, q.fracBits, p, nFracDigits);
+		}
+
+		buffer[nLength] = CharT(0);
+		return nLength;
+	}
+
+	//Parse decimal text as a Qm.n value: leading white space, an optional sign, digits with an
+	//optional point (".5" and "2." are accepted), rounded to the nearest multiple of 2^-n with ties
+	//to even. raw is only written when the status is Ok, sign-extended when signed
+	template <typename CharT>
+	constexpr ParseStatus parse_q(std::basic_string_view<CharT> text, QFormat q, uint64_t& raw) noexcept
+	{
+		if (!IsValidQFormat(q))
+			return ParseStatus::Invalid;
+
+		//Fraction digits beyond the exact length of any fraction only decide ties
+		constexpr size_t nMaxFracDigits = 64;
+
+		detail::Cursor<CharT> cursor{ text.data(), text.data() + text.size() };
+		CharT ch = cursor.Peek();
+		while (IsSpace(ch))
+		{
+			cursor.Advance();
+			ch = cursor.Peek();
+		}
+
+		if (ch == CharT(0))
+			return ParseStatus::Empty;
+
+		bool bNegative = ch == CharT('-');
+		if (ch == CharT('-') || ch == CharT('+'))
+		{
+			cursor.Advance();
+			ch = cursor.Peek();
+		}
+
+		uint64_t nInteger = 0;
+		bool bOverflow = false;
+		bool bAnyDigits = false;
+		for (unsigned int nDigit = DigitValue(ch); nDigit < 10; nDigit = DigitValue(ch))
+		{
+			bOverflow |= nInteger > (UINT64_MAX - nDigit) / 10;
+			nInteger = nInteger * 10 + nDigit;
+			bAnyDigits = true;
+			cursor.Advance();
+			ch = cursor.Peek();
+		}
+
+		uint8_t fraction[nMaxFracDigits] = {};
+		size_t nFracDigits = 0;
+		bool bSticky = false;
+		if (ch == CharT('.'))
+		{
+			cursor.Advance();
+			ch = cursor.Peek();
+			for (unsigned int nDigit = DigitValue(ch); nDigit < 10; nDigit = DigitValue(ch))
+			{
+				if (nFracDigits < nMaxFracDigits)
+					fraction[nFracDigits++] = static_cast<uint8_t>(nDigit);
+				else
+					bSticky |= nDigit != 0;
+
+				bAnyDigits = true;
+				cursor.Advance();
+				ch = cursor.Peek();
+			}
+		}
+
+		if (!bAnyDigits || ch != CharT(0))
+			return ParseStatus::Invalid;
+
+		while (nFracDigits && !fraction[nFracDigits - 1])
+			--nFracDigits;
+
+		//Fraction bits by division where it fits in 64 bits, otherwise by doubling the decimal
+		//fraction: each carry out of the first digit is the next bit, and what is left afterwards
+		//decides the rounding
+		uint64_t nFractionBits = 0;
+		int nHalf = -1;
+		if (bSticky || !detail::DivideFraction(fraction, nFracDigits, q.fracBits, nFractionBits, nHalf))
+		{
+			for (unsigned int nBit = 0; nBit < q.fracBits; ++nBit)
+			{
+				unsigned int nCarry = 0;
+				for (size_t i = nFracDigits; i--; )
+				{
+					unsigned int nDoubled = fraction[i] * 2u + nCarry;
+					nCarry = nDoubled >= 10;
+					fraction[i] = static_cast<uint8_t>(nDoubled - nCarry * 10);
+				}
+
+				nFractionBits = (nFractionBits << 1) | nCarry;
+				while (nFracDigits && !fraction[nFracDigits - 1])
+					--nFracDigits;
+			}
+
+			bool bAboveHalf = nFracDigits && (fraction[0] > 5 || (fraction[0] == 5 && (nFracDigits > 1 || bSticky)));
+			bool bHalf = nFracDigits == 1 && fraction[0] == 5 && !bSticky;
+			nHalf = bAboveHalf ? 1 : (bHalf ? 0 : -1);
+		}
+
+		//Magnitude in units of 2^-n, against the largest of the sign
+		unsigned int nWidth = QWidth(q);
+		uint64_t nLimit = q.isSigned ? (1ull << (nWidth - 1)) - !bNegative : WidthMask(nWidth);
+		if (!q.isSigned && bNegative)
+			nLimit = 0;
+
+		if (bOverflow || (q.fracBits && nInteger > (UINT64_MAX >> q.fracBits)))
+			return ParseStatus::OutOfRange;
+
+		uint64_t nMagnitude = (q.fracBits ? nInteger << q.fracBits : nInteger) | nFractionBits;
+
+		bool bRoundUp = nHalf > 0 || (nHalf == 0 && (nMagnitude & 1));
+		if (nMagnitude > nLimit || (bRoundUp && nMagnitude == nLimit))
+			return ParseStatus::OutOfRange;
+
+		nMagnitude += bRoundUp;
+		raw = bNegative ? 0 - nMagnitude : nMagnitude;
+		if (q.isSigned)
+			raw = SignExtend(raw & WidthMask(nWidth), nWidth);
+
+		return ParseStatus::Ok;
+	}
+
+	//Keystroke filter for real text in decimal mode: decimal digits, the point and signs, plus for
+	//floats the exponent, hex-float and inf/nan letters. Position is not checked; the text is
+	//validated when it is parsed
+	template <typename KeyT>
+	constexpr bool IsRealKeystrokeAllowed(KeyT ch, bool bFloat) noexcept
+	{
+		uint32_t chKey = detail::CharCode(ch);
+		if ((chKey >= '0' && chKey <= '9') || chKey == '.' || chKey == '-' || chKey == '+')
+			return true;
+
+		if (!bFloat)
+			return false;
+
+		uint32_t chLower = chKey | 0x20;
+		return (chLower >= 'a' && chLower <= 'f') || chLower == 'x' || chLower == 'p' || chLower == 'i' ||
+			chLower == 'n' || chLower == 't' || chLower == 'y';
+	}
+
+	static_assert(QWidth(QFormat()) == 16 && IsValidQFormat(QFormat{ 32, 32, true }) && !IsValidQFormat(QFormat{ 0, 64, false }), "Q formats");
+}
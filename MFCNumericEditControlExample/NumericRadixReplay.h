@@ -0,0 +1,412 @@
+#pragma once
+
+/*
+	NumericRadixReplay.h
+
+	Replay of recorded keystroke and command traces against NumericEditModel (see
+	NumericRadixModel.h), with a latency histogram per event type. A trace is text, one event per
+	line; blank lines and lines starting with '#' are ignored:
+
+		type 0x1000 + 4*0x40	one Char event per character after "type "
+		char 8					one Char event with the given code (8 is backspace)
+		key left [shift] [ctrl]	KeyDown: left, right, home, end, delete, x, c or v
+		cmd hex					Command: dec, hex, oct, bin, cut, copy or paste
+		clip 1,234				set the clipboard text
+		text 0x10				SetText() (programmatic text)
+		value 4096				SetValue()
+		poll					GetValue(), as a control's owner polling AsValue()
+		blur					KillFocus()
+		width 16				SetBitWidth()
+		signed 1				SetSigned()
+		group hex 4				SetDigitGrouping() for dec, hex, oct or bin
+		expr 1					SetExpressionMode()
+
+	Events are parsed once into a compact array, so replay measures the model rather than the
+	trace. Latencies are in NumericRadixTrace.h ticks.
+
+	MIT License for CNumericEditControl:
+
+	Copyright (c) 2019-2020 Data Synergy UK Ltd
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "NumericRadixModel.h"
+
+namespace numeric_radix
+{
+	enum class EditEventType : uint8_t
+	{
+		Char,
+		KeyDown,
+		Command,
+		Clipboard,
+		Text,
+		Value,
+		Poll,
+		KillFocus,
+		Setting,
+	};
+
+	constexpr size_t EDIT_EVENT_TYPE_COUNT = 9;
+
+	constexpr const char* EditEventName(EditEventType type) noexcept
+	{
+		switch (type)
+		{
+			case EditEventType::Char:		return "Char";
+			case EditEventType::KeyDown:	return "KeyDown";
+			case EditEventType::Command:	return "Command";
+			case EditEventType::Clipboard:	return "Clipboard";
+			case EditEventType::Text:		return "Text";
+			case EditEventType::Value:		return "Value";
+			case EditEventType::Poll:		return "Poll";
+			case EditEventType::KillFocus:	return "KillFocus";
+			case EditEventType::Setting:	return "Setting";
+			default:						return "?";
+		}
+	}
+
+	enum class EditSetting : uint8_t
+	{
+		Width,
+		Signed,
+		GroupDecimal,
+		GroupHex,
+		GroupOctal,
+		GroupBinary,
+		Expression,
+	};
+
+	//One event. code is the character, EditKey, EditCommand or EditSetting, or the index of the
+	//text in EditTrace::strings; value is the value or setting
+	struct EditEvent
+	{
+		static constexpr uint8_t SHIFT = 1;
+		static constexpr uint8_t CONTROL = 2;
+
+		EditEventType type;
+		uint8_t flags;
+		uint32_t code;
+		uint64_t value;
+	};
+
+	template <typename CharT>
+	struct EditTrace
+	{
+		std::vector<EditEvent> events;
+		std::vector<std::basic_string<CharT>> strings;
+	};
+
+	namespace detail
+	{
+		template <typename CharT>
+		std::basic_string<CharT> WidenTraceText(std::string_view text)
+		{
+			std::basic_string<CharT> result;
+			result.reserve(text.size());
+			for (char ch : text)
+				result.push_back(static_cast<CharT>(static_cast<unsigned char>(ch)));
+
+			return result;
+		}
+
+		//Index of word in names, or -1
+		template <size_t N>
+		int FindTraceWord(std::string_view word, const char* const (&names)[N]) noexcept
+		{
+			for (size_t i = 0; i < N; ++i)
+			{
+				if (word == names[i])
+					return static_cast<int>(i);
+			}
+
+			return -1;
+		}
+
+		//Next word of line, skipping spaces and tabs
+		inline std::string_view NextTraceWord(std::string_view& line) noexcept
+		{
+			size_t nStart = line.find_first_not_of(" \t");
+			if (nStart == std::string_view::npos)
+			{
+				line = std::string_view();
+				return line;
+			}
+
+			size_t nEnd = line.find_first_of(" \t", nStart);
+			std::string_view word = line.substr(nStart, nEnd == std::string_view::npos ? std::string_view::npos : nEnd - nStart);
+			line = nEnd == std::string_view::npos ? std::string_view() : line.substr(nEnd);
+			return word;
+		}
+
+		inline bool ParseTraceNumber(std::string_view word, uint64_t& value)
+		{
+			uint64_t nValue = 0;
+			if (word.empty() || !parse<10>(word, nValue))
+				return false;
+
+			value = nValue;
+			return true;
+		}
+	}
+
+	//Parse trace text, appending to trace. Returns 0, or the number of the first line that is not
+	//a valid event
+	template <typename CharT>
+	size_t parse_edit_trace(std::string_view text, EditTrace<CharT>& trace)
+	{
+		static const char* const keys[] = { "left", "right", "home", "end", "delete", "x", "c", "v" };
+		static const char* const commands[] = { "dec", "hex", "oct", "bin", "cut", "copy", "paste" };
+		static const char* const modes[] = { "dec", "hex", "oct", "bin" };
+
+		size_t nLine = 0;
+		while (!text.empty())
+		{
+			++nLine;
+			size_t nEnd = text.find('\n');
+			std::string_view line = text.substr(0, nEnd);
+			text = nEnd == std::string_view::npos ? std::string_view() : text.substr(nEnd + 1);
+			if (!line.empty() && line.back() == '\r')
+				line.remove_suffix(1);
+
+			std::string_view rest = line;
+			std::string_view word = detail::NextTraceWord(rest);
+			if (word.empty() || word[0] == '#')
+				continue;
+
+			//Text arguments run to the end of the line after a single space
+			std::string_view argument = rest.empty() ? rest : rest.substr(1);
+			uint64_t value = 0;
+			EditEvent event = { EditEventType::Char, 0, 0, 0 };
+			if (word == "type")
+			{
+				for (char ch : argument)
+					trace.events.push_back(EditEvent{ EditEventType::Char, 0, static_cast<unsigned char>(ch), 0 });
+
+				continue;
+			}
+
+			else if (word == "char" && detail::ParseTraceNumber(detail::NextTraceWord(rest), value) && value <= UINT32_MAX)
+				event = EditEvent{ EditEventType::Char, 0, static_cast<uint32_t>(value), 0 };
+
+			else if (word == "key")
+			{
+				int nKey = detail::FindTraceWord(detail::NextTraceWord(rest), keys);
+				if (nKey < 0)
+					return nLine;
+
+				event = EditEvent{ EditEventType::KeyDown, 0, static_cast<uint32_t>(nKey), 0 };
+				for (std::string_view modifier = detail::NextTraceWord(rest); !modifier.empty(); modifier = detail::NextTraceWord(rest))
+				{
+					if (modifier == "shift")
+						event.flags |= EditEvent::SHIFT;
+					else if (modifier == "ctrl")
+						event.flags |= EditEvent::CONTROL;
+					else
+						return nLine;
+				}
+			}
+
+			else if (word == "cmd")
+			{
+				int nCommand = detail::FindTraceWord(detail::NextTraceWord(rest), commands);
+				if (nCommand < 0)
+					return nLine;
+
+				event = EditEvent{ EditEventType::Command, 0, static_cast<uint32_t>(nCommand), 0 };
+			}
+
+			else if (word == "clip" || word == "text")
+			{
+				event = EditEvent{ word == "clip" ? EditEventType::Clipboard : EditEventType::Text, 0, static_cast<uint32_t>(trace.strings.size()), 0 };
+				trace.strings.push_back(detail::WidenTraceText<CharT>(argument));
+			}
+
+			else if (word == "value" && detail::ParseTraceNumber(detail::NextTraceWord(rest), value))
+				event = EditEvent{ EditEventType::Value, 0, 0, value };
+
+			else if (word == "poll" || word == "blur")
+				event = EditEvent{ word == "poll" ? EditEventType::Poll : EditEventType::KillFocus, 0, 0, 0 };
+
+			else if ((word == "width" || word == "signed" || word == "expr") && detail::ParseTraceNumber(detail::NextTraceWord(rest), value))
+			{
+				EditSetting setting = word == "width" ? EditSetting::Width : (word == "signed" ? EditSetting::Signed : EditSetting::Expression);
+				event = EditEvent{ EditEventType::Setting, 0, static_cast<uint32_t>(setting), value };
+			}
+
+			else if (word == "group")
+			{
+				int nMode = detail::FindTraceWord(detail::NextTraceWord(rest), modes);
+				if (nMode < 0 || !detail::ParseTraceNumber(detail::NextTraceWord(rest), value))
+					return nLine;
+
+				event = EditEvent{ EditEventType::Setting, 0, static_cast<uint32_t>(EditSetting::GroupDecimal) + static_cast<uint32_t>(nMode), value };
+			}
+
+			else
+				return nLine;
+
+			trace.events.push_back(event);
+		}
+
+		return 0;
+	}
+
+	//Apply one event of trace to model
+	template <typename CharT>
+	void ApplyEditEvent(NumericEditModel<CharT>& model, EditClipboard<CharT>& clipboard, const EditTrace<CharT>& trace, const EditEvent& event)
+	{
+		static constexpr unsigned int radices[] = { 10, 16, 8, 2 };
+
+		uint64_t value = 0;
+		switch (event.type)
+		{
+			case EditEventType::Char:		model.Char(event.code);
+											break;
+
+			case EditEventType::KeyDown:	model.KeyDown(static_cast<EditKey>(event.code), (event.flags & EditEvent::SHIFT) != 0, (event.flags & EditEvent::CONTROL) != 0);
+											break;
+
+			case EditEventType::Command:	model.Command(static_cast<EditCommand>(event.code));
+											break;
+
+			case EditEventType::Clipboard:	clipboard.text = trace.strings[event.code];
+											break;
+
+			case EditEventType::Text:		model.SetText(trace.strings[event.code]);
+											break;
+
+			case EditEventType::Value:		model.SetValue(event.value);
+											break;
+
+			case EditEventType::Poll:		model.GetValue(value);
+											break;
+
+			case EditEventType::KillFocus:	model.KillFocus();
+											break;
+
+			case EditEventType::Setting:	switch (static_cast<EditSetting>(event.code))
+											{
+												case EditSetting::Width:		model.SetBitWidth(static_cast<unsigned int>(event.value));
+																				break;
+
+												case EditSetting::Signed:		model.SetSigned(event.value != 0);
+																				break;
+
+												case EditSetting::Expression:	model.SetExpressionMode(event.value != 0);
+																				break;
+
+												default:						model.SetDigitGrouping(radices[(event.code - static_cast<uint32_t>(EditSetting::GroupDecimal)) & 3], static_cast<unsigned int>(event.value));
+																				break;
+											}
+											break;
+		}
+	}
+
+	//Latency histogram per event type, in ticks
+	struct ReplayStats
+	{
+		trace::ProbeStats events[EDIT_EVENT_TYPE_COUNT] = {};
+
+		const trace::ProbeStats& operator[](EditEventType type) const noexcept { return events[static_cast<size_t>(type)]; }
+		void Reset() noexcept { *this = ReplayStats(); }
+	};
+
+	//Replay every event of trace in order, timing each one
+	template <typename CharT>
+	void replay_edit_trace(NumericEditModel<CharT>& model, EditClipboard<CharT>& clipboard, const EditTrace<CharT>& trace, ReplayStats& stats)
+	{
+		for (const EditEvent& event : trace.events)
+		{
+			uint64_t nStart = trace::ReadCycles();
+			ApplyEditEvent(model, clipboard, trace, event);
+			stats.events[static_cast<size_t>(event.type)].Add(trace::ReadCycles() - nStart);
+		}
+	}
+
+	//Replay without timing, for throughput
+	template <typename CharT>
+	void replay_edit_trace(NumericEditModel<CharT>& model, EditClipboard<CharT>& clipboard, const EditTrace<CharT>& trace)
+	{
+		for (const EditEvent& event : trace.events)
+			ApplyEditEvent(model, clipboard, trace, event);
+	}
+
+	//Synthetic trace of nSessions editing sessions: values typed in each mode with corrections,
+	//caret movement, polls of the value, mode flips, copy and paste, and occasional settings and
+	//expressions. Deterministic for a given seed
+	inline std::string MakeEditSessionTrace(size_t nSessions, uint64_t seed = 0x5EED)
+	{
+		static const char* const modes[] = { "dec", "hex", "oct", "bin" };
+		static const unsigned int radices[] = { 10, 16, 8, 2 };
+
+		std::mt19937_64 rng(seed);
+		std::string text;
+		for (size_t nSession = 0; nSession < nSessions; ++nSession)
+		{
+			size_t nMode = rng() % 4;
+			text += "cmd ";
+			text += modes[nMode];
+			text += "\nkey home\nkey end shift\n";
+
+			uint64_t nRoll = rng() % 16;
+			if (nRoll == 0)
+				text += "width 16\nsigned 1\n";
+			else if (nRoll == 1)
+				text += "width 64\nsigned 0\n";
+			else if (nRoll == 2)
+				text += std::string("group ") + modes[nMode] + (nMode == 0 ? " 3\n" : " 4\n");
+			else if (nRoll == 3)
+				text += "expr 1\ntype 0x1000 + 4*0x40 | 0b101\npoll\nblur\nexpr 0\n";
+
+			//Type a value digit by digit, polling as a live owner would, with a typo corrected
+			uint64_t value = rng() >> (rng() % 64);
+			char szDigits[FORMAT_BUFFER_SIZE];
+			size_t nDigits = format(radices[nMode], value, szDigits, FORMAT_BUFFER_SIZE);
+			for (size_t i = 0; i < nDigits; ++i)
+			{
+				text += "type ";
+				text += szDigits[i];
+				text += "\npoll\n";
+				if (rng() % 8 == 0)
+					text += "type 1\nchar 8\n";
+			}
+
+			text += "key left\nkey left shift\nkey right\nkey home\nkey end\nblur\n";
+
+			//Flip through the other modes, copy, and paste back
+			text += "cmd ";
+			text += modes[(nMode + 1) % 4];
+			text += "\npoll\nkey c ctrl\ncmd ";
+			text += modes[(nMode + 2) % 4];
+			text += "\nkey v ctrl\npoll\n";
+			if (rng() % 4 == 0)
+				text += "clip 1,234,567\nkey v ctrl\nkey x ctrl\n";
+		}
+
+		return text;
+	}
+}
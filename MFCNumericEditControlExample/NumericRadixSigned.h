@@ -0,0 +1,353 @@
+#pragma once
+
+/*
+	NumericRadixSigned.h
+
+	Fixed bit widths (1 to 64, typically 8/16/32/64 for register fields) and signed display for
+	the NumericRadix.h engine. A value of a given width is held in a uint64_t: zero-extended when
+	unsigned and sign-extended when signed, so a signed value can be cast straight to int64_t.
+
+	Signed decimal text has an optional '-' sign ("-128"). Signed hex, octal and binary text is
+	the two's complement bit pattern of the width, written with every digit of the width
+	("0xff" for -1 at 8 bits). A pattern with the top bit set is read back as negative, and a
+	'-' sign is also accepted. Unsigned text is as format(), limited to the width; as with
+	wcstoull(), a '-' sign wraps only at the full 64-bit width. "-0" is 0 at every width.
+
+	Parsing reports a ParseStatus rather than an in-band value, so that every value of the width,
+	including all ones, can be represented. The text rules are otherwise those of parse().
+
+	WidthMask() and SignExtend() are single shifts by 64 - bits. Parsing and formatting still
+	branch on the sign and the radix, and the 8/16/32/64-bit widths are dispatched to
+	instantiations in which the width is a constant.
+
+	MIT License for CNumericEditControl:
+
+	Copyright (c) 2019-2020 Data Synergy UK Ltd
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "NumericRadixGroup.h"
+
+namespace numeric_radix
+{
+	enum class ParseStatus : uint8_t
+	{
+		Ok,
+		Empty,			//Nothing but white space and separators
+		Invalid,		//Not a number in the radix
+		OutOfRange,		//A number, but not representable in the width
+	};
+
+	//Width and signedness of a fixed-width value
+	struct FixedFormat
+	{
+		unsigned int bits = 64;
+		bool isSigned = false;
+	};
+
+	//Longest fixed-width text without grouping: 64 binary digits or a sign and 20 decimal digits
+	//(GROUPED_FORMAT_BUFFER_SIZE holds any grouped text)
+	constexpr size_t FIXED_FORMAT_BUFFER_SIZE = FORMAT_BUFFER_SIZE;
+
+	//All ones in the low bits (1 to 64)
+	constexpr uint64_t WidthMask(unsigned int bits) noexcept
+	{
+		return UINT64_MAX >> (64 - bits);
+	}
+
+	//The low bits of value, sign-extended to 64 bits
+	constexpr uint64_t SignExtend(uint64_t value, unsigned int bits) noexcept
+	{
+		return static_cast<uint64_t>(static_cast<int64_t>(value << (64 - bits)) >> (64 - bits));
+	}
+
+	//value as parse_fixed() reads back the text format_fixed() writes for it
+	constexpr uint64_t FitToWidth(uint64_t value, FixedFormat fixed) noexcept
+	{
+		return fixed.isSigned ? SignExtend(value, fixed.bits) : value & WidthMask(fixed.bits);
+	}
+
+	namespace detail
+	{
+		//First character parse() reads as the sign, if any
+		template <typename CharT>
+		constexpr bool IsNegativeText(std::basic_string_view<CharT> text) noexcept
+		{
+			for (CharT ch : text)
+			{
+				if (!IsSpace(ch) && !IsSeparator(ch))
+					return ch == CharT('-');
+			}
+
+			return false;
+		}
+
+		template <typename CharT>
+		constexpr bool IsBlankText(std::basic_string_view<CharT> text) noexcept
+		{
+			for (CharT ch : text)
+			{
+				if (ch == CharT(0))
+					break;
+
+				if (!IsSpace(ch) && !IsSeparator(ch))
+					return false;
+			}
+
+			return true;
+		}
+
+		//Syntax check for text that parse() rejected: a number that only overflowed 64 bits is
+		//out of range rather than invalid
+		template <unsigned int Radix, typename CharT>
+		constexpr bool IsNumberText(std::basic_string_view<CharT> text) noexcept
+		{
+			Cursor<CharT> cursor{ text.data(), text.data() + text.size() };
+			CharT ch = cursor.Peek();
+			while (IsSpace(ch))
+			{
+				cursor.Advance();
+				ch = cursor.Peek();
+			}
+
+			if (ch == CharT('+') || ch == CharT('-'))
+			{
+				cursor.Advance();
+				ch = cursor.Peek();
+			}
+
+			if (Radix == 16 && ch == CharT('0'))
+			{
+				Cursor<CharT> lookahead = cursor;
+				lookahead.Advance();
+				CharT chX = lookahead.Peek();
+				if (chX == CharT('x') || chX == CharT('X'))
+				{
+					lookahead.Advance();
+					if (DigitValue(lookahead.Peek()) < 16)
+					{
+						cursor = lookahead;
+						ch = cursor.Peek();
+					}
+				}
+			}
+
+			bool bDigits = false;
+			while (DigitValue(ch) < Radix)
+			{
+				bDigits = true;
+				cursor.Advance();
+				ch = cursor.Peek();
+			}
+
+			return bDigits && ch == CharT(0);
+		}
+
+		//BitsT is unsigned int, or an integral_constant for a width known at compile time
+		template <unsigned int Radix, typename CharT, typename BitsT>
+		constexpr ParseStatus ParseFixed(std::basic_string_view<CharT> text, BitsT bits, bool bSigned, uint64_t& value) noexcept
+		{
+			uint64_t ullValue = 0;
+			if (!parse<Radix>(text, ullValue))
+			{
+				if (IsBlankText(text))
+					return ParseStatus::Empty;
+
+				return IsNumberText<Radix>(text) ? ParseStatus::OutOfRange : ParseStatus::Invalid;
+			}
+
+			//parse() returned a negative value in two's complement; the magnitude may be at most
+			//2^(bits - 1) for a signed width. A negative zero is plain 0, at every width
+			uint64_t nMask = WidthMask(bits);
+			if (ullValue != 0 && IsNegativeText(text))
+			{
+				if (!bSigned)
+				{
+					if (bits != 64)
+						return ParseStatus::OutOfRange;
+				}
+				else if (0 - ullValue > (nMask >> 1) + 1)
+					return ParseStatus::OutOfRange;
+
+				value = ullValue;
+				return ParseStatus::Ok;
+			}
+
+			//Signed decimal is limited to the positive range; other signed radices take any bit
+			//pattern of the width
+			uint64_t nLimit = (bSigned && Radix == 10) ? nMask >> 1 : nMask;
+			if (ullValue > nLimit)
+				return ParseStatus::OutOfRange;
+
+			value = bSigned ? SignExtend(ullValue, bits) : ullValue;
+			return ParseStatus::Ok;
+		}
+
+		template <unsigned int Radix, typename CharT, typename BitsT>
+		constexpr size_t FormatFixed(uint64_t value, BitsT bits, bool bSigned, Grouping grouping, CharT* buffer, size_t bufferSize) noexcept
+		{
+			uint64_t nPattern = value & WidthMask(bits);
+			if (!bSigned)
+				return grouping.groupSize ? format_grouped<Radix>(nPattern, grouping, buffer, bufferSize) : format<Radix>(nPattern, buffer, bufferSize);
+
+			if (Radix == 10)
+			{
+				uint64_t nExtended = SignExtend(nPattern, bits);
+				bool bNegative = static_cast<int64_t>(nExtended) < 0;
+				uint64_t nMagnitude = bNegative ? 0 - nExtended : nExtended;
+
+				size_t nDigits = FormattedDigits<10>(nMagnitude);
+				size_t nLength = bNegative + GroupedLength(nDigits, grouping);
+				if (nLength >= bufferSize)
+					return 0;
+
+				if (bNegative)
+					buffer[0] = CharT('-');
+
+				buffer[nLength] = CharT(0);
+				WriteGroupedDigits<10>(nMagnitude, buffer + nLength, nDigits, grouping);
+				return nLength;
+			}
+
+			//Two's complement: every digit of the width, after the usual prefix
+			constexpr size_t nPrefixLength = Radix == 16 ? 2 : (Radix == 8 ? 1 : 0);
+			size_t nDigits = MaxDigits(Radix, bits);
+			size_t nLength = nPrefixLength + GroupedLength(nDigits, grouping);
+			if (nLength >= bufferSize)
+				return 0;
+
+			if (Radix == 16)
+			{
+				buffer[0] = CharT('0');
+				buffer[1] = CharT('x');
+			}
+			else if (Radix == 8)
+				buffer[0] = CharT('0');
+
+			buffer[nLength] = CharT(0);
+			WriteGroupedDigits<Radix>(nPattern, buffer + nLength, nDigits, grouping);
+			return nLength;
+		}
+
+		//Call fn(bits) with the width as a constant for the common register widths
+		template <typename WidthFn>
+		constexpr auto WithWidth(unsigned int bits, WidthFn fn) noexcept
+		{
+			switch (bits)
+			{
+				case 8:		return fn(std::integral_constant<unsigned int, 8>());
+				case 16:	return fn(std::integral_constant<unsigned int, 16>());
+				case 32:	return fn(std::integral_constant<unsigned int, 32>());
+				case 64:	return fn(std::integral_constant<unsigned int, 64>());
+				default:	return fn(bits);
+			}
+		}
+	}
+
+	//Parse text as a value of the given width and signedness. value is only written when the
+	//status is Ok. Widths outside 1 to 64 and unsupported radices are Invalid
+	template <unsigned int Radix, typename CharT>
+	constexpr ParseStatus parse_fixed(std::basic_string_view<CharT> text, FixedFormat fixed, uint64_t& value) noexcept
+	{
+		static_assert(detail::IsSupportedRadix(Radix), "Radix must be 2, 8, 10 or 16");
+
+		if (fixed.bits < 1 || fixed.bits > 64)
+			return ParseStatus::Invalid;
+
+		return detail::WithWidth(fixed.bits, [&](auto bits)
+		{
+			return detail::ParseFixed<Radix>(text, bits, fixed.isSigned, value);
+		});
+	}
+
+	//Format the low bits of value at the given width, optionally with digit grouping (see
+	//NumericRadixGroup.h). Returns the number of characters written excluding the terminator, or 0
+	//if the buffer is too small, the width is not 1 to 64 or the separator is not one parse() ignores
+	template <unsigned int Radix, typename CharT>
+	constexpr size_t format_fixed(uint64_t value, FixedFormat fixed, CharT* buffer, size_t bufferSize, Grouping grouping = Grouping()) noexcept
+	{
+		static_assert(detail::IsSupportedRadix(Radix), "Radix must be 2, 8, 10 or 16");
+
+		if (fixed.bits < 1 || fixed.bits > 64 || !detail::IsValidGrouping(grouping))
+			return 0;
+
+		return detail::WithWidth(fixed.bits, [&](auto bits)
+		{
+			return detail::FormatFixed<Radix>(value, bits, fixed.isSigned, grouping, buffer, bufferSize);
+		});
+	}
+
+	template <typename CharT>
+	constexpr ParseStatus parse_fixed(unsigned int radix, std::basic_string_view<CharT> text, FixedFormat fixed, uint64_t& value) noexcept
+	{
+		switch (radix)
+		{
+			case 2:		return parse_fixed<2>(text, fixed, value);
+			case 8:		return parse_fixed<8>(text, fixed, value);
+			case 10:	return parse_fixed<10>(text, fixed, value);
+			case 16:	return parse_fixed<16>(text, fixed, value);
+			default:	return ParseStatus::Invalid;
+		}
+	}
+
+	template <typename CharT>
+	constexpr size_t format_fixed(unsigned int radix, uint64_t value, FixedFormat fixed, CharT* buffer, size_t bufferSize, Grouping grouping = Grouping()) noexcept
+	{
+		switch (radix)
+		{
+			case 2:		return format_fixed<2>(value, fixed, buffer, bufferSize, grouping);
+			case 8:		return format_fixed<8>(value, fixed, buffer, bufferSize, grouping);
+			case 10:	return format_fixed<10>(value, fixed, buffer, bufferSize, grouping);
+			case 16:	return format_fixed<16>(value, fixed, buffer, bufferSize, grouping);
+			default:	return 0;
+		}
+	}
+
+	//Keystroke filter for signed decimal: as IsKeystrokeAllowed(), plus a '-' typed at the start
+	//of text that does not already have one. Digits are checked against the text after the sign
+	template <typename CharT, typename KeyT>
+	constexpr bool IsSignedKeystrokeAllowed(const KeystrokeContext<CharT>& context, KeyT ch, size_t maxDigits) noexcept
+	{
+		size_t nEnd = context.selEnd < context.length ? context.selEnd : context.length;
+		size_t nStart = context.selStart < nEnd ? context.selStart : nEnd;
+		bool bHasSign = context.length && context.first == CharT('-') && !(nStart == 0 && nEnd > 0);
+
+		if (detail::CharCode(ch) == '-')
+			return nStart == 0 && !bHasSign;
+
+		if (!bHasSign)
+			return IsKeystrokeAllowed<10>(context, ch, maxDigits);
+
+		//Nothing may be typed before the sign
+		if (nStart == 0)
+			return false;
+
+		KeystrokeContext<CharT> digits;
+		digits.length = context.length - 1;
+		digits.selStart = nStart - 1;
+		digits.selEnd = nEnd - 1;
+		//Only the hex and octal rules look at the second character
+		digits.first = context.second;
+		digits.second = CharT(0);
+		return IsKeystrokeAllowed<10>(digits, ch, maxDigits);
+	}
+
+	static_assert(WidthMask(8) == 0xFF && WidthMask(64) == UINT64_MAX && SignExtend(0x80, 8) == UINT64_MAX - 0x7F, "Width helpers");
+}
@@ -0,0 +1,325 @@
+#pragma once
+
+/*
+	NumericRadixSimd.h
+
+	SSE2 digit validation and conversion kernels used by NumericRadix.h. Each kernel takes a block
+	of ASCII digits with separators and prefix already removed, checks every digit in 16-byte lanes
+	and converts the whole block without a per-character multiply loop:
+
+		ConvertHex		1-16 hex digits
+		ConvertDecimal	1-19 decimal digits
+		ConvertBinary	1-64 binary digits
+
+	NarrowChars packs 16-bit text to bytes 8 characters at a time, and HasSeparators checks a block
+	for separators and NUL 16 bytes at a time, so that plain 8- and 16-bit numbers reach the
+	kernels without a per-character loop.
+
+	FindTokenEnd scans 8- or 16-bit text for the next NUL, tab, line break or semicolon, 16 or 8
+	characters at a time, for the multi-value paste tokenizer (see NumericRadixPaste.h).
+
+	These digit counts can never overflow 64 bits. A kernel returns false if any character is not
+	a digit, in which case the caller falls back to the scalar parser. SSE2 is part of the x64
+	baseline, so the kernels are selected at compile time and no runtime CPU detection is needed.
+	Define NUMERIC_RADIX_NO_SIMD to force the scalar parser, e.g. on non-x86 targets or to compare
+	the two implementations.
+
+	MIT License for CNumericEditControl:
+
+	Copyright (c) 2019-2020 Data Synergy UK Ltd
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+//The kernels are not constexpr, so they are only used when the compiler can tell a constant
+//evaluation of the parser from a runtime call
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define NUMERIC_RADIX_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#endif
+
+#if !defined(NUMERIC_RADIX_IS_CONSTANT_EVALUATED) && ((defined(__GNUC__) && __GNUC__ >= 9) || (defined(_MSC_VER) && _MSC_VER >= 1925))
+#define NUMERIC_RADIX_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+
+#if !defined(NUMERIC_RADIX_NO_SIMD) && defined(NUMERIC_RADIX_IS_CONSTANT_EVALUATED) && \
+	(defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define NUMERIC_RADIX_SSE2 1
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace numeric_radix
+{
+	namespace simd
+	{
+#ifdef NUMERIC_RADIX_SSE2
+		constexpr bool AVAILABLE = true;
+
+		namespace detail
+		{
+			//Copy up to 16 digits right-aligned into a lane, padded with leading '0' digits
+			inline __m128i LoadDigits(const uint8_t* pDigits, size_t nDigits) noexcept
+			{
+				alignas(16) uint8_t block[16];
+				memset(block, '0', sizeof(block));
+				memcpy(block + sizeof(block) - nDigits, pDigits, nDigits);
+				return _mm_load_si128(reinterpret_cast<const __m128i*>(block));
+			}
+
+			//0xFF in each byte that is in the range [chFirst, chLast]. Bytes above 0x7F compare as
+			//negative and are never in range
+			inline __m128i InRange(__m128i v, char chFirst, char chLast) noexcept
+			{
+				return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(static_cast<char>(chFirst - 1))),
+					_mm_cmplt_epi8(v, _mm_set1_epi8(static_cast<char>(chLast + 1))));
+			}
+
+			//Value of 16 decimal digits, most significant first, held as byte values 0-9
+			inline uint64_t Decimal16(__m128i digits) noexcept
+			{
+				const __m128i zero = _mm_setzero_si128();
+
+				//Pairs of digits -> 0..99
+				const __m128i m10 = _mm_setr_epi16(10, 1, 10, 1, 10, 1, 10, 1);
+				__m128i pairs = _mm_packs_epi32(_mm_madd_epi16(_mm_unpacklo_epi8(digits, zero), m10),
+					_mm_madd_epi16(_mm_unpackhi_epi8(digits, zero), m10));
+
+				//Pairs of pairs -> 0..9999
+				const __m128i m100 = _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1);
+				__m128i quads = _mm_madd_epi16(pairs, m100);
+				quads = _mm_packs_epi32(quads, quads);
+
+				//Pairs of quads -> 0..99999999
+				const __m128i m10000 = _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1);
+				__m128i octets = _mm_madd_epi16(quads, m10000);
+
+				uint64_t ullHigh = static_cast<uint32_t>(_mm_cvtsi128_si32(octets));
+				uint64_t ullLow = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(octets, 4)));
+				return ullHigh * 100000000 + ullLow;
+			}
+
+			//Index of the lowest set bit of a non-zero movemask result
+			inline unsigned int LowestBit(int nMask) noexcept
+			{
+#ifdef _MSC_VER
+				unsigned long nIndex;
+				_BitScanForward(&nIndex, static_cast<unsigned long>(nMask));
+				return nIndex;
+#else
+				return static_cast<unsigned int>(__builtin_ctz(static_cast<unsigned int>(nMask)));
+#endif
+			}
+
+			//Reverse the order of the 16 bytes in a lane
+			inline __m128i ReverseBytes(__m128i v) noexcept
+			{
+				v = _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+				v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+				v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+				return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+			}
+		}
+
+		inline bool ConvertHex(const uint8_t* pDigits, size_t nDigits, uint64_t& value) noexcept
+		{
+			if (nDigits == 0 || nDigits > 16)
+				return false;
+
+			__m128i v = detail::LoadDigits(pDigits, nDigits);
+			__m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+			__m128i isDigit = detail::InRange(v, '0', '9');
+			__m128i isAlpha = detail::InRange(lower, 'a', 'f');
+			if (_mm_movemask_epi8(_mm_or_si128(isDigit, isAlpha)) != 0xFFFF)
+				return false;
+
+			//Nibble values, most significant first
+			__m128i nibbles = _mm_or_si128(_mm_and_si128(isDigit, _mm_sub_epi8(v, _mm_set1_epi8('0'))),
+				_mm_and_si128(isAlpha, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+
+			//Combine nibble pairs into bytes and narrow to 8 big-endian bytes
+			__m128i bytes = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00FF)), 4),
+				_mm_srli_epi16(nibbles, 8));
+			bytes = _mm_packus_epi16(bytes, bytes);
+
+			uint8_t result[8];
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(result), bytes);
+
+			uint64_t ullValue = 0;
+			for (uint8_t byte : result)
+				ullValue = (ullValue << 8) | byte;
+
+			value = ullValue;
+			return true;
+		}
+
+		inline bool ConvertDecimal(const uint8_t* pDigits, size_t nDigits, uint64_t& value) noexcept
+		{
+			if (nDigits == 0 || nDigits > 19)
+				return false;
+
+			//Up to 3 leading digits beyond the 16 handled by the lane
+			uint64_t ullValue = 0;
+			while (nDigits > 16)
+			{
+				unsigned int nDigit = static_cast<unsigned int>(*pDigits - '0');
+				if (nDigit > 9)
+					return false;
+
+				ullValue = ullValue * 10 + nDigit;
+				++pDigits;
+				--nDigits;
+			}
+
+			__m128i v = detail::LoadDigits(pDigits, nDigits);
+			if (_mm_movemask_epi8(detail::InRange(v, '0', '9')) != 0xFFFF)
+				return false;
+
+			value = ullValue * 10000000000000000ull + detail::Decimal16(_mm_sub_epi8(v, _mm_set1_epi8('0')));
+			return true;
+		}
+
+		inline bool ConvertBinary(const uint8_t* pDigits, size_t nDigits, uint64_t& value) noexcept
+		{
+			if (nDigits == 0 || nDigits > 64)
+				return false;
+
+			alignas(16) uint8_t block[64];
+			memset(block, '0', sizeof(block));
+			memcpy(block + sizeof(block) - nDigits, pDigits, nDigits);
+
+			//Each lane contributes 16 bits, most significant lane first
+			uint64_t ullValue = 0;
+			for (size_t nOffset = 0; nOffset < sizeof(block); nOffset += 16)
+			{
+				__m128i v = _mm_load_si128(reinterpret_cast<const __m128i*>(block + nOffset));
+				if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(v, _mm_set1_epi8(static_cast<char>(0xFE))), _mm_set1_epi8('0'))) != 0xFFFF)
+					return false;
+
+				//Move each digit's low bit to the byte's sign bit, last digit in mask bit 0
+				__m128i bits = _mm_slli_epi64(_mm_sub_epi8(detail::ReverseBytes(v), _mm_set1_epi8('0')), 7);
+				ullValue = (ullValue << 16) | static_cast<uint16_t>(_mm_movemask_epi8(bits));
+			}
+
+			value = ullValue;
+			return true;
+		}
+
+		namespace detail
+		{
+			//Eight 16-bit characters as bytes. Characters above 0xFF become 0xFF, which no kernel
+			//accepts as a digit; clearing the sign bit and setting bit 8 instead keeps 0x8000 and
+			//above from saturating to NUL
+			inline __m128i Narrow8(__m128i v) noexcept
+			{
+				v = _mm_or_si128(_mm_and_si128(v, _mm_set1_epi16(0x7FFF)), _mm_slli_epi16(_mm_srli_epi16(v, 15), 8));
+				return _mm_packus_epi16(v, v);
+			}
+		}
+
+		//Pack nChars 16-bit characters into bytes, writing nChars rounded up to a multiple of 8
+		inline void NarrowChars(const uint16_t* p, size_t nChars, uint8_t* pBytes) noexcept
+		{
+			size_t i = 0;
+			for (; nChars - i >= 8; i += 8)
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(pBytes + i), detail::Narrow8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i))));
+
+			if (i < nChars)
+			{
+				alignas(16) uint16_t tail[8] = {};
+				memcpy(tail, p + i, (nChars - i) * sizeof(uint16_t));
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(pBytes + i), detail::Narrow8(_mm_load_si128(reinterpret_cast<const __m128i*>(tail))));
+			}
+		}
+
+		//True if any of the first nChars bytes of a block is ',', ' ' or NUL. Only whole lanes
+		//of the block are loaded in place; the last partial lane is copied into a lane padded with
+		//'0', so no byte past nChars is read
+		inline bool HasSeparators(const uint8_t* pBlock, size_t nChars) noexcept
+		{
+			auto fnMask = [](__m128i v)
+			{
+				return _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(',')), _mm_cmpeq_epi8(v, _mm_set1_epi8(' '))),
+					_mm_cmpeq_epi8(v, _mm_setzero_si128())));
+			};
+
+			size_t i = 0;
+			for (; nChars - i >= 16; i += 16)
+			{
+				if (fnMask(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pBlock + i))))
+					return true;
+			}
+
+			return i < nChars && fnMask(detail::LoadDigits(pBlock + i, nChars - i));
+		}
+
+		//First NUL, '\t', '\n', '\r' or ';' in [p, pEnd), or the point at which fewer characters
+		//remain than fit in a lane, for the caller to finish with a scalar loop
+		inline const uint8_t* FindTokenEnd(const uint8_t* p, const uint8_t* pEnd) noexcept
+		{
+			for (; pEnd - p >= 16; p += 16)
+			{
+				__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+				__m128i ends = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_setzero_si128()), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+					_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))), _mm_cmpeq_epi8(v, _mm_set1_epi8(';'))));
+
+				int nMask = _mm_movemask_epi8(ends);
+				if (nMask)
+					return p + detail::LowestBit(nMask);
+			}
+
+			return p;
+		}
+
+		inline const uint16_t* FindTokenEnd(const uint16_t* p, const uint16_t* pEnd) noexcept
+		{
+			for (; pEnd - p >= 8; p += 8)
+			{
+				__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+				__m128i ends = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi16(v, _mm_setzero_si128()), _mm_cmpeq_epi16(v, _mm_set1_epi16('\t'))),
+					_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi16(v, _mm_set1_epi16('\n')), _mm_cmpeq_epi16(v, _mm_set1_epi16('\r'))), _mm_cmpeq_epi16(v, _mm_set1_epi16(';'))));
+
+				//Two mask bits per character
+				int nMask = _mm_movemask_epi8(ends);
+				if (nMask)
+					return p + detail::LowestBit(nMask) / 2;
+			}
+
+			return p;
+		}
+#else
+		constexpr bool AVAILABLE = false;
+
+		inline bool ConvertHex(const uint8_t*, size_t, uint64_t&) noexcept { return false; }
+		inline bool ConvertDecimal(const uint8_t*, size_t, uint64_t&) noexcept { return false; }
+		inline bool ConvertBinary(const uint8_t*, size_t, uint64_t&) noexcept { return false; }
+		inline void NarrowChars(const uint16_t*, size_t, uint8_t*) noexcept {}
+		inline bool HasSeparators(const uint8_t*, size_t) noexcept { return true; }
+		inline const uint8_t* FindTokenEnd(const uint8_t* p, const uint8_t*) noexcept { return p; }
+		inline const uint16_t* FindTokenEnd(const uint16_t* p, const uint16_t*) noexcept { return p; }
+#endif
+	}
+}
@@ -0,0 +1,341 @@
+#pragma once
+
+/*
+	NumericRadixTrace.h
+
+	Opt-in instrumentation of the control's hot paths: call counts and latency histograms for each
+	probe (keystrokes, value access, display updates, mode changes and clipboard commands), plus
+	counters for rejected keystrokes, parse failures and overflow rejections. Statistics are kept
+	per control and for the whole process, and each timed call can also be passed to a TraceSink,
+	such as the in-memory RingBufferSink or ChromeTraceSink, which writes a file that can be
+	opened in chrome://tracing or Perfetto.
+
+	Instrumentation is compiled in only when NUMERIC_RADIX_INSTRUMENT is defined. Otherwise the
+	NUMERIC_RADIX_PROBE/COUNT macros expand to nothing and their arguments are not evaluated, so
+	the control carries no statistics and no code. Latencies are read from the CPU's time stamp
+	counter where there is one, and are in counter ticks.
+
+	Statistics are updated without locks and are meant for the UI thread that owns the controls.
+
+	MIT License for CNumericEditControl:
+
+	Copyright (c) 2019-2020 Data Synergy UK Ltd
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define NUMERIC_RADIX_RDTSC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define NUMERIC_RADIX_RDTSC 1
+#endif
+
+#ifdef NUMERIC_RADIX_INSTRUMENT
+#define NUMERIC_RADIX_PROBE(stats, probe) numeric_radix::trace::ScopedProbe numericRadixProbe_(stats, numeric_radix::trace::Probe::probe)
+#define NUMERIC_RADIX_COUNT(stats, counter) numeric_radix::trace::Count(stats, numeric_radix::trace::Counter::counter)
+#define NUMERIC_RADIX_COUNT_IF(stats, counter, condition) do { if (condition) NUMERIC_RADIX_COUNT(stats, counter); } while (0)
+#else
+#define NUMERIC_RADIX_PROBE(stats, probe) ((void)0)
+#define NUMERIC_RADIX_COUNT(stats, counter) ((void)0)
+#define NUMERIC_RADIX_COUNT_IF(stats, counter, condition) ((void)0)
+#endif
+
+namespace numeric_radix
+{
+	namespace trace
+	{
+		//Timed calls
+		enum class Probe : uint8_t
+		{
+			OnChar,
+			OnKeyDown,
+			AsValue,
+			UpdateControl,
+			ChangeMode,
+			Copy,
+			Paste,
+		};
+
+		constexpr size_t PROBE_COUNT = 7;
+
+		constexpr const char* ProbeName(Probe probe) noexcept
+		{
+			switch (probe)
+			{
+				case Probe::OnChar:			return "OnChar";
+				case Probe::OnKeyDown:		return "OnKeyDown";
+				case Probe::AsValue:		return "AsValue";
+				case Probe::UpdateControl:	return "UpdateControl";
+				case Probe::ChangeMode:		return "ChangeMode";
+				case Probe::Copy:			return "Copy";
+				case Probe::Paste:			return "Paste";
+				default:					return "?";
+			}
+		}
+
+		//Counted events
+		enum class Counter : uint8_t
+		{
+			RejectedKeystrokes,
+			ParseFailures,
+			OverflowRejections,
+		};
+
+		constexpr size_t COUNTER_COUNT = 3;
+
+		//Time stamp counter ticks, or nanoseconds where the CPU has no such counter
+		inline uint64_t ReadCycles() noexcept
+		{
+#ifdef NUMERIC_RADIX_RDTSC
+			return __rdtsc();
+#else
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+		}
+
+		//Call count and log2 histogram of latencies: bucket n counts calls of 2^(n-1) to 2^n - 1 ticks
+		struct ProbeStats
+		{
+			static constexpr size_t BUCKETS = 65;
+
+			uint64_t calls;
+			uint64_t totalCycles;
+			uint64_t maxCycles;
+			uint64_t histogram[BUCKETS];
+
+			void Add(uint64_t cycles) noexcept
+			{
+				size_t nBucket = 0;
+				for (uint64_t n = cycles; n; n >>= 1)
+					++nBucket;
+
+				++calls;
+				totalCycles += cycles;
+				if (cycles > maxCycles)
+					maxCycles = cycles;
+
+				++histogram[nBucket];
+			}
+
+			//Upper bound of the bucket holding the given fraction (0 to 1) of calls
+			uint64_t Percentile(double fraction) const noexcept
+			{
+				uint64_t nTarget = static_cast<uint64_t>(fraction * static_cast<double>(calls));
+				uint64_t nSeen = 0;
+				for (size_t nBucket = 0; nBucket < BUCKETS; ++nBucket)
+				{
+					nSeen += histogram[nBucket];
+					if (nSeen > nTarget || nSeen == calls)
+						return nBucket ? (nBucket == 64 ? UINT64_MAX : (uint64_t(1) << nBucket) - 1) : 0;
+				}
+
+				return 0;
+			}
+		};
+
+		struct Stats
+		{
+			ProbeStats probes[PROBE_COUNT];
+			uint64_t counters[COUNTER_COUNT];
+
+			const ProbeStats& operator[](Probe probe) const noexcept { return probes[static_cast<size_t>(probe)]; }
+			uint64_t operator[](Counter counter) const noexcept { return counters[static_cast<size_t>(counter)]; }
+			void Reset() noexcept { *this = Stats(); }
+		};
+
+		//One timed call. source identifies the control (the address of its Stats)
+		struct TraceEvent
+		{
+			Probe probe;
+			const void* source;
+			uint64_t startCycles;
+			uint64_t cycles;
+		};
+
+		class TraceSink
+		{
+		public:
+			virtual ~TraceSink() = default;
+			virtual void OnEvent(const TraceEvent& event) = 0;
+		};
+
+		//Keeps the most recent events, overwriting the oldest
+		class RingBufferSink : public TraceSink
+		{
+		public:
+			explicit RingBufferSink(size_t capacity) : m_events(capacity ? capacity : 1) {}
+
+			void OnEvent(const TraceEvent& event) override
+			{
+				m_events[m_nNext] = event;
+				m_nNext = (m_nNext + 1) % m_events.size();
+				if (m_nSize < m_events.size())
+					++m_nSize;
+				else
+					++m_nOverwritten;
+			}
+
+			size_t Size() const noexcept { return m_nSize; }
+			uint64_t Overwritten() const noexcept { return m_nOverwritten; }
+
+			//Events held, oldest first
+			std::vector<TraceEvent> Snapshot() const
+			{
+				std::vector<TraceEvent> events;
+				events.reserve(m_nSize);
+				size_t nFirst = (m_nNext + m_events.size() - m_nSize) % m_events.size();
+				for (size_t i = 0; i < m_nSize; ++i)
+					events.push_back(m_events[(nFirst + i) % m_events.size()]);
+
+				return events;
+			}
+
+			void Clear() noexcept
+			{
+				m_nNext = 0;
+				m_nSize = 0;
+				m_nOverwritten = 0;
+			}
+
+		private:
+			std::vector<TraceEvent> m_events;
+			size_t m_nNext = 0;
+			size_t m_nSize = 0;
+			uint64_t m_nOverwritten = 0;
+		};
+
+		//Collects events and writes them as Chrome trace event format JSON ("X" complete events, one
+		//thread per control) on Flush() or destruction. Ticks are converted to microseconds with a
+		//rate measured between construction and the write
+		class ChromeTraceSink : public TraceSink
+		{
+		public:
+			explicit ChromeTraceSink(const char* pszPath) : m_sPath(pszPath ? pszPath : "")
+			{
+				m_startTime = std::chrono::steady_clock::now();
+				m_nStartCycles = ReadCycles();
+			}
+
+			~ChromeTraceSink() override { Flush(); }
+
+			void OnEvent(const TraceEvent& event) override { m_events.push_back(event); }
+
+			//Write all events collected so far. Returns false if the file cannot be written
+			bool Flush()
+			{
+				if (m_events.empty() || m_sPath.empty())
+					return true;
+
+				double dTicksPerMicrosecond = TicksPerMicrosecond();
+
+				std::FILE* pFile = std::fopen(m_sPath.c_str(), "w");
+				if (!pFile)
+					return false;
+
+				std::vector<const void*> sources;
+				std::fputs("{\"traceEvents\":[\n", pFile);
+				for (size_t i = 0; i < m_events.size(); ++i)
+				{
+					const TraceEvent& event = m_events[i];
+					size_t nThread = 0;
+					while (nThread < sources.size() && sources[nThread] != event.source)
+						++nThread;
+
+					if (nThread == sources.size())
+						sources.push_back(event.source);
+
+					double dStart = static_cast<double>(static_cast<int64_t>(event.startCycles - m_nStartCycles)) / dTicksPerMicrosecond;
+					std::fprintf(pFile, "%s{\"name\":\"%s\",\"cat\":\"CNumericEditControl\",\"ph\":\"X\",\"pid\":1,\"tid\":%zu,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"ticks\":%llu}}",
+						i ? ",\n" : "", ProbeName(event.probe), nThread + 1, dStart, static_cast<double>(event.cycles) / dTicksPerMicrosecond,
+						static_cast<unsigned long long>(event.cycles));
+				}
+
+				std::fputs("\n]}\n", pFile);
+				return std::fclose(pFile) == 0;
+			}
+
+		private:
+			double TicksPerMicrosecond() const
+			{
+				double dMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - m_startTime).count();
+				uint64_t nCycles = ReadCycles() - m_nStartCycles;
+				if (dMicroseconds <= 0 || !nCycles)
+					return 1000.0;
+
+				return static_cast<double>(nCycles) / dMicroseconds;
+			}
+
+			std::string m_sPath;
+			std::chrono::steady_clock::time_point m_startTime;
+			uint64_t m_nStartCycles;
+			std::vector<TraceEvent> m_events;
+		};
+
+		namespace detail
+		{
+			inline Stats s_globalStats = {};
+			inline TraceSink* s_pSink = nullptr;
+		}
+
+		//Totals over all controls
+		inline Stats& GlobalStats() noexcept { return detail::s_globalStats; }
+
+		//Sink for every timed call, or null. The sink is not owned
+		inline void SetSink(TraceSink* pSink) noexcept { detail::s_pSink = pSink; }
+		inline TraceSink* GetSink() noexcept { return detail::s_pSink; }
+
+		inline void Count(Stats& stats, Counter counter) noexcept
+		{
+			++stats.counters[static_cast<size_t>(counter)];
+			++detail::s_globalStats.counters[static_cast<size_t>(counter)];
+		}
+
+		//Times the enclosing scope
+		class ScopedProbe
+		{
+		public:
+			ScopedProbe(Stats& stats, Probe probe) noexcept : m_stats(stats), m_probe(probe), m_nStart(ReadCycles()) {}
+
+			~ScopedProbe()
+			{
+				uint64_t nCycles = ReadCycles() - m_nStart;
+				m_stats.probes[static_cast<size_t>(m_probe)].Add(nCycles);
+				detail::s_globalStats.probes[static_cast<size_t>(m_probe)].Add(nCycles);
+				if (detail::s_pSink)
+					detail::s_pSink->OnEvent(TraceEvent{ m_probe, &m_stats, m_nStart, nCycles });
+			}
+
+			ScopedProbe(const ScopedProbe&) = delete;
+			ScopedProbe& operator=(const ScopedProbe&) = delete;
+
+		private:
+			Stats& m_stats;
+			Probe m_probe;
+			uint64_t m_nStart;
+		};
+	}
+}
@@ -0,0 +1,496 @@
+#pragma once
+
+/*
+	NumericRadixWide.h
+
+	Wide integer support for the NumericRadix.h engine: 128-bit GUID fields, 256-bit hashes and
+	any other width that is a multiple of 64 bits, up to e.g. 4096 bits. Values are held in a
+	fixed array of 64-bit limbs, so wide conversions are allocation-free like the 64-bit ones.
+
+	Text follows exactly the same rules as numeric_radix::parse() and format(): separators,
+	white space, sign and "0x"/leading 0 prefixes behave identically and values that do not fit
+	in the chosen width are rejected. Given a bit count, parse_wide() reads text at any width up
+	to Bits, and a negative value wraps to that width as parse() wraps it to 64 bits.
+
+	Hex, octal and binary are converted in linear time by placing each digit's bits directly.
+	Decimal is converted in base 10^19 chunks with one 64-bit multiply or divide per limb per
+	chunk; a 4096-bit value formats in about 15 microseconds, well below the size where
+	divide-and-conquer conversion would pay off.
+
+	MIT License for CNumericEditControl:
+
+	Copyright (c) 2019-2020 Data Synergy UK Ltd
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "NumericRadix.h"
+
+#if defined(_MSC_VER) && defined(_M_X64) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace numeric_radix
+{
+	//Widest value supported by the control's wide mode
+	constexpr size_t MAX_WIDE_BITS = 4096;
+
+	//Unsigned integer of Bits bits, least significant limb first
+	template <size_t Bits>
+	struct WideUInt
+	{
+		static_assert(Bits >= 64 && Bits % 64 == 0, "Bits must be a non-zero multiple of 64");
+
+		static constexpr size_t BITS = Bits;
+		static constexpr size_t LIMBS = Bits / 64;
+
+		//Buffer size (including terminator) sufficient for any formatted value: Bits binary digits
+		static constexpr size_t FORMAT_BUFFER_SIZE = Bits + 1;
+
+		uint64_t limbs[LIMBS] = {};
+
+		constexpr WideUInt() noexcept = default;
+
+		constexpr WideUInt(uint64_t value) noexcept
+		{
+			limbs[0] = value;
+		}
+
+		//Number of significant bits (0 for zero), from the top non-zero limb
+		size_t BitLength() const noexcept
+		{
+			for (size_t nLimb = LIMBS; nLimb--;)
+			{
+				if (limbs[nLimb])
+					return nLimb * 64 + detail::BitLength(limbs[nLimb]);
+			}
+
+			return 0;
+		}
+
+		bool IsZero() const noexcept
+		{
+			uint64_t nBits = 0;
+			for (size_t i = 0; i < LIMBS; ++i)
+				nBits |= limbs[i];
+
+			return nBits == 0;
+		}
+
+		//Clear every bit from bit nBits up
+		void Truncate(size_t nBits) noexcept
+		{
+			for (size_t i = 0; i < LIMBS; ++i)
+			{
+				if (nBits <= i * 64)
+					limbs[i] = 0;
+
+				else if (nBits < (i + 1) * 64)
+					limbs[i] &= (uint64_t(1) << (nBits - i * 64)) - 1;
+			}
+		}
+
+		friend bool operator==(const WideUInt& a, const WideUInt& b) noexcept
+		{
+			for (size_t i = 0; i < LIMBS; ++i)
+			{
+				if (a.limbs[i] != b.limbs[i])
+					return false;
+			}
+
+			return true;
+		}
+
+		friend bool operator!=(const WideUInt& a, const WideUInt& b) noexcept
+		{
+			return !(a == b);
+		}
+	};
+
+	namespace detail
+	{
+		constexpr uint64_t POW10_19 = 10000000000000000000ull;
+
+#if defined(__SIZEOF_INT128__)
+		//GCC and Clang extension; __extension__ keeps -Wpedantic quiet about it
+		__extension__ typedef unsigned __int128 UInt128;
+#endif
+
+		//Returns the low 64 bits of a * b + c and stores the high 64 bits in hi
+		inline uint64_t MulAdd(uint64_t a, uint64_t b, uint64_t c, uint64_t& hi) noexcept
+		{
+#if defined(__SIZEOF_INT128__)
+			UInt128 product = static_cast<UInt128>(a) * b + c;
+			hi = static_cast<uint64_t>(product >> 64);
+			return static_cast<uint64_t>(product);
+#elif defined(_MSC_VER) && defined(_M_X64)
+			uint64_t lo = _umul128(a, b, &hi);
+			lo += c;
+			hi += (lo < c);
+			return lo;
+#else
+			uint64_t aLo = a & 0xFFFFFFFF, aHi = a >> 32, bLo = b & 0xFFFFFFFF, bHi = b >> 32;
+			uint64_t ll = aLo * bLo, lh = aLo * bHi, hl = aHi * bLo, hh = aHi * bHi;
+			uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFF) + (hl & 0xFFFFFFFF);
+			uint64_t lo = (ll & 0xFFFFFFFF) | (mid << 32);
+			hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+			lo += c;
+			hi += (lo < c);
+			return lo;
+#endif
+		}
+
+		//Returns (hi:lo) / d and stores the remainder in rem. Requires hi < d
+		inline uint64_t Div128(uint64_t hi, uint64_t lo, uint64_t d, uint64_t& rem) noexcept
+		{
+#if defined(__SIZEOF_INT128__)
+			UInt128 dividend = (static_cast<UInt128>(hi) << 64) | lo;
+			rem = static_cast<uint64_t>(dividend % d);
+			return static_cast<uint64_t>(dividend / d);
+#elif defined(_MSC_VER) && defined(_M_X64) && _MSC_VER >= 1920
+			return _udiv128(hi, lo, d, &rem);
+#else
+			//Restoring division, one quotient bit at a time
+			uint64_t quotient = 0;
+			for (int nBit = 63; nBit >= 0; --nBit)
+			{
+				bool bCarry = (hi >> 63) != 0;
+				hi = (hi << 1) | (lo >> 63);
+				lo <<= 1;
+				if (bCarry || hi >= d)
+				{
+					hi -= d;
+					quotient |= uint64_t(1) << nBit;
+				}
+			}
+
+			rem = hi;
+			return quotient;
+#endif
+		}
+
+		//Bits per digit for power-of-two radices
+		constexpr unsigned int BitsPerDigit(unsigned int radix) noexcept
+		{
+			return radix == 16 ? 4 : (radix == 8 ? 3 : 1);
+		}
+	}
+
+	namespace detail
+	{
+		//Two's complement negation in place
+		template <size_t Bits>
+		inline void Negate(WideUInt<Bits>& value) noexcept
+		{
+			uint64_t carry = 1;
+			for (uint64_t& limb : value.limbs)
+			{
+				limb = ~limb + carry;
+				carry = carry && !limb;
+			}
+		}
+
+		//parse_wide() without applying the sign: magnitude is the digits' value and bNegative
+		//says whether a '-' sign came before them
+		template <unsigned int Radix, size_t Bits, typename CharT>
+		inline bool ParseWide(std::basic_string_view<CharT> text, WideUInt<Bits>& magnitude, bool& bNegative) noexcept
+		{
+			Cursor<CharT> cursor{ text.data(), text.data() + text.size() };
+			CharT ch = cursor.Peek();
+
+			//Leading white space, optional sign and optional "0x" prefix exactly as parse()
+			while (IsSpace(ch))
+			{
+				cursor.Advance();
+				ch = cursor.Peek();
+			}
+
+			bNegative = false;
+			if (ch == CharT('+') || ch == CharT('-'))
+			{
+				bNegative = (ch == CharT('-'));
+				cursor.Advance();
+				ch = cursor.Peek();
+			}
+
+			if (Radix == 16 && ch == CharT('0'))
+			{
+				Cursor<CharT> lookahead = cursor;
+				lookahead.Advance();
+
+				CharT chX = lookahead.Peek();
+				if (chX == CharT('x') || chX == CharT('X'))
+				{
+					lookahead.Advance();
+					if (DigitValue(lookahead.Peek()) < 16)
+					{
+						cursor = lookahead;
+						ch = cursor.Peek();
+					}
+				}
+			}
+
+			//First pass: find the digit span. It contains only digits and separators. More significant
+			//digits than the largest Bits-wide value has cannot fit, so reading stops there
+			const CharT* pFirst = cursor.p;
+			size_t nDigits = 0, nSignificant = 0;
+			for (unsigned int nDigit = DigitValue(ch); nDigit < Radix; nDigit = DigitValue(ch))
+			{
+				if ((nSignificant || nDigit) && ++nSignificant > MaxDigits(Radix, Bits))
+					return false;
+
+				++nDigits;
+				cursor.Advance();
+				ch = cursor.Peek();
+			}
+
+			const CharT* pLast = cursor.p;
+			if (!nDigits || ch != CharT(0))
+				return false;
+
+			//Second pass: convert
+			WideUInt<Bits> result;
+			if (Radix != 10)
+			{
+				//Place each digit's bits directly, least significant digit first
+				constexpr unsigned int nDigitBits = detail::BitsPerDigit(Radix);
+				size_t nBit = 0;
+				for (const CharT* p = pLast; p != pFirst;)
+				{
+					if (IsSeparator(*--p))
+						continue;
+
+					uint64_t digit = DigitValue(*p);
+					if (digit)
+					{
+						if (nBit >= Bits || (nBit + nDigitBits > Bits && (digit >> (Bits - nBit))))
+							return false;
+
+						size_t nLimb = nBit / 64, nShift = nBit % 64;
+						result.limbs[nLimb] |= digit << nShift;
+						if (nShift + nDigitBits > 64 && nLimb + 1 < WideUInt<Bits>::LIMBS)
+							result.limbs[nLimb + 1] |= digit >> (64 - nShift);
+					}
+
+					nBit += nDigitBits;
+				}
+			}
+			else
+			{
+				//Multiply-accumulate chunks of up to 19 digits, most significant first, over the
+				//limbs in use so far
+				size_t nUsed = 0;
+				size_t nChunkDigits = nDigits % 19 ? nDigits % 19 : 19;
+				uint64_t chunk = 0, scale = 1;
+				for (const CharT* p = pFirst; p != pLast; ++p)
+				{
+					if (IsSeparator(*p))
+						continue;
+
+					chunk = chunk * 10 + DigitValue(*p);
+					scale *= 10;
+					if (--nChunkDigits)
+						continue;
+
+					uint64_t carry = chunk;
+					for (size_t i = 0; i < nUsed; ++i)
+						result.limbs[i] = detail::MulAdd(result.limbs[i], scale, carry, carry);
+
+					if (carry)
+					{
+						if (nUsed == WideUInt<Bits>::LIMBS)
+							return false;
+
+						result.limbs[nUsed++] = carry;
+					}
+
+					chunk = 0;
+					scale = 1;
+					nChunkDigits = 19;
+				}
+			}
+
+			magnitude = result;
+			return true;
+		}
+	}
+
+	//Parse a complete number in the given radix into a Bits-wide value, with the same rules as
+	//parse(). Returns false if the text is not a valid number or the value needs more than Bits
+	//bits, in which case value is left unchanged.
+	template <unsigned int Radix, size_t Bits, typename CharT>
+	inline bool parse_wide(std::basic_string_view<CharT> text, WideUInt<Bits>& value) noexcept
+	{
+		static_assert(detail::IsSupportedRadix(Radix), "Radix must be 2, 8, 10 or 16");
+
+		WideUInt<Bits> result;
+		bool bNegative = false;
+		if (!detail::ParseWide<Radix>(text, result, bNegative))
+			return false;
+
+		//As with parse(), a negative value is returned in two's complement
+		if (bNegative)
+			detail::Negate(result);
+
+		value = result;
+		return true;
+	}
+
+	//parse_wide() at a width of nBits bits (1 to Bits), as parse_fixed() reads unsigned text: the
+	//value must fit nBits bits, and a negative value wraps to the two's complement of nBits bits
+	//("-1" is nBits ones) as parse() wraps it at 64 bits. The bits above nBits are zero.
+	template <unsigned int Radix, size_t Bits, typename CharT>
+	inline bool parse_wide(std::basic_string_view<CharT> text, WideUInt<Bits>& value, size_t nBits) noexcept
+	{
+		static_assert(detail::IsSupportedRadix(Radix), "Radix must be 2, 8, 10 or 16");
+
+		WideUInt<Bits> result;
+		bool bNegative = false;
+		if (!detail::ParseWide<Radix>(text, result, bNegative) || result.BitLength() > nBits)
+			return false;
+
+		if (bNegative)
+		{
+			detail::Negate(result);
+			result.Truncate(nBits);
+		}
+
+		value = result;
+		return true;
+	}
+
+	//Format a Bits-wide value in the control's display format. Returns the number of characters
+	//written excluding the terminator, or 0 if the buffer is too small.
+	template <unsigned int Radix, size_t Bits, typename CharT>
+	inline size_t format_wide(const WideUInt<Bits>& value, CharT* buffer, size_t bufferSize) noexcept
+	{
+		static_assert(detail::IsSupportedRadix(Radix), "Radix must be 2, 8, 10 or 16");
+
+		constexpr char szDigits[] = "0123456789abcdef";
+		constexpr size_t nPrefixLength = numeric_radix::Radix<Radix>::PREFIX_LENGTH;
+
+		if (Radix != 10)
+		{
+			constexpr unsigned int nDigitBits = detail::BitsPerDigit(Radix);
+			size_t nBits = value.BitLength();
+			size_t nDigits = nBits ? (nBits + nDigitBits - 1) / nDigitBits : 1;
+			if (nPrefixLength + nDigits >= bufferSize)
+				return 0;
+
+			CharT* pOut = buffer;
+			if (Radix == 16)
+			{
+				*pOut++ = CharT('0');
+				*pOut++ = CharT('x');
+			}
+			else if (Radix == 8)
+				*pOut++ = CharT('0');
+
+			//Extract digits most significant first
+			for (size_t nDigit = nDigits; nDigit--;)
+			{
+				size_t nBit = nDigit * nDigitBits, nLimb = nBit / 64, nShift = nBit % 64;
+				uint64_t digit = value.limbs[nLimb] >> nShift;
+				if (nShift + nDigitBits > 64 && nLimb + 1 < WideUInt<Bits>::LIMBS)
+					digit |= value.limbs[nLimb + 1] << (64 - nShift);
+
+				*pOut++ = CharT(szDigits[digit & ((1u << nDigitBits) - 1)]);
+			}
+
+			*pOut = CharT(0);
+			return nPrefixLength + nDigits;
+		}
+
+		//Decimal: divide by 10^19 repeatedly, collecting chunks least significant first
+		WideUInt<Bits> quotient = value;
+		uint64_t chunks[Bits / 63 + 1];
+		size_t nChunks = 0;
+		size_t nUsed = WideUInt<Bits>::LIMBS;
+		while (nUsed && !quotient.limbs[nUsed - 1])
+			--nUsed;
+
+		do
+		{
+			uint64_t rem = 0;
+			for (size_t i = nUsed; i--;)
+				quotient.limbs[i] = detail::Div128(rem, quotient.limbs[i], detail::POW10_19, rem);
+
+			chunks[nChunks++] = rem;
+			while (nUsed && !quotient.limbs[nUsed - 1])
+				--nUsed;
+		} while (nUsed);
+
+		//Most significant chunk unpadded, the rest padded to 19 digits
+		size_t nLeadingDigits = detail::FormattedDigits<10>(chunks[nChunks - 1]);
+		size_t nLength = nLeadingDigits + (nChunks - 1) * 19;
+		if (nLength >= bufferSize)
+			return 0;
+
+		CharT* pEnd = buffer + nLength;
+		*pEnd = CharT(0);
+		for (size_t nChunk = 0; nChunk < nChunks; ++nChunk)
+		{
+			size_t nDigits = nChunk + 1 < nChunks ? 19 : nLeadingDigits;
+			detail::WriteDigits<10>(chunks[nChunk], pEnd, nDigits);
+			pEnd -= nDigits;
+		}
+
+		return nLength;
+	}
+
+	//Runtime radix dispatch
+	template <size_t Bits, typename CharT>
+	inline bool parse_wide(unsigned int radix, std::basic_string_view<CharT> text, WideUInt<Bits>& value) noexcept
+	{
+		switch (radix)
+		{
+			case 2:		return parse_wide<2>(text, value);
+			case 8:		return parse_wide<8>(text, value);
+			case 10:	return parse_wide<10>(text, value);
+			case 16:	return parse_wide<16>(text, value);
+			default:	return false;
+		}
+	}
+
+	template <size_t Bits, typename CharT>
+	inline bool parse_wide(unsigned int radix, std::basic_string_view<CharT> text, WideUInt<Bits>& value, size_t nBits) noexcept
+	{
+		switch (radix)
+		{
+			case 2:		return parse_wide<2>(text, value, nBits);
+			case 8:		return parse_wide<8>(text, value, nBits);
+			case 10:	return parse_wide<10>(text, value, nBits);
+			case 16:	return parse_wide<16>(text, value, nBits);
+			default:	return false;
+		}
+	}
+
+	template <size_t Bits, typename CharT>
+	inline size_t format_wide(unsigned int radix, const WideUInt<Bits>& value, CharT* buffer, size_t bufferSize) noexcept
+	{
+		switch (radix)
+		{
+			case 2:		return format_wide<2>(value, buffer, bufferSize);
+			case 8:		return format_wide<8>(value, buffer, bufferSize);
+			case 10:	return format_wide<10>(value, buffer, bufferSize);
+			case 16:	return format_wide<16>(value, buffer, bufferSize);
+			default:	return 0;
+		}
+	}
+}
@@ -0,0 +1,1033 @@
+/*
+	NumericRadixBenchmark.cpp
+
+	Google Benchmark suite for the CNumericEditControl conversion core. Each benchmark reports
+	time per operation and a "bytes/op" counter (characters of input or output, in bytes) so
+	that regressions in either throughput or work done per call are visible.
+
+		Parse/<radix>				ParseValueInternal()-equivalent parse of plain numbers
+		ParseSeparators/<radix>		As above with Calculator-style comma/space digit grouping
+		Format/<radix>				UpdateControl()-equivalent formatting
+		FormatGrouped/<radix>		As above with the default digit grouping (thousands, nibbles)
+		Encoding/<op>/<radix>/<type>	Parse and format with each character type, and parsing ASCII text widened to UTF-16 first
+		ParseFixed/FormatFixed		Signed 32-bit values: signed decimal and two's complement hex/binary
+		FloatFormat/<case>			Shortest round-trip double formatting, against printf("%.17g")
+		FloatParse/<input>/<case>	Double parsing of short decimals and of shortest text of random doubles, against strtod()
+		FixedPoint/<case>			Q16.16 formatting and parsing
+		Expr/<case>					Expression compile and evaluate, cached re-evaluation, evaluation alone, and every prefix as typed
+		ChangeMode					ChangeMode() step: parse in one mode, format in the next
+		FormatCache/<case>			Cycling a set of values through all four modes, formatting or using a FormatCache
+		Publish/<case>				ValueSlot publish from 1 and 4 threads, and a consumer tick against a flat-out publisher thread
+		Keystroke/<radix>			OnChar()-equivalent filtering of every character of a value
+		EditReplay/<case>			Synthetic editing sessions replayed against NumericEditModel, untimed and with per-event timing
+		ParseBatch, ParallelParseBatch	Bulk conversion of a column of values
+		PasteBuffer/<case>			WM_PASTE-equivalent in-place parse of a multi-megabyte clipboard buffer
+		PasteTable					Multi-value paste of a 10MB tab/CRLF-delimited table
+		GridScroll					CNumericGridControl repaint: scroll a 64K x 16 hex grid one row at a time
+		WideParse/WideFormat		128/256/4096-bit values in each radix
+		TraceProbe/<case>			Cost of one NumericRadixTrace.h probe when instrumentation is compiled in
+
+	Text is UTF-16 (char16_t), as WCHAR text in the control, except for the float benchmarks,
+	which use char text on both sides of the comparison with the C library.
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "NumericRadixCache.h"
+#include "NumericRadixExpr.h"
+#include "NumericRadixGrid.h"
+#include "NumericRadixGroup.h"
+#include "NumericRadixParallel.h"
+#include "NumericRadixPaste.h"
+#include "NumericRadixPublish.h"
+#include "NumericRadixReplay.h"
+#include "NumericRadixReal.h"
+#include "NumericRadixSigned.h"
+#include "NumericRadixTrace.h"
+#include "NumericRadixWide.h"
+
+namespace
+{
+	using WString = std::u16string;
+	using WStringView = std::u16string_view;
+
+	constexpr size_t SAMPLE_COUNT = 4096;
+
+	//Values with uniformly distributed bit lengths, so every digit count is exercised
+	std::vector<uint64_t> MakeValues(size_t nCount)
+	{
+		std::mt19937_64 rng(0x5EED);
+		std::vector<uint64_t> values(nCount);
+		for (uint64_t& value : values)
+		{
+			unsigned int nBits = 1 + static_cast<unsigned int>(rng() % 64);
+			value = nBits == 64 ? rng() : rng() & ((uint64_t(1) << nBits) - 1);
+		}
+
+		return values;
+	}
+
+	WString FormatValue(unsigned int radix, uint64_t value)
+	{
+		char16_t szBuffer[numeric_radix::FORMAT_BUFFER_SIZE];
+		size_t nLength = numeric_radix::format(radix, value, szBuffer, numeric_radix::FORMAT_BUFFER_SIZE);
+		return WString(szBuffer, nLength);
+	}
+
+	//Group digits from the right as Windows Calculator does: commas every 3 decimal digits,
+	//spaces every 4 hex/binary digits and every 3 octal digits
+	WString GroupDigits(unsigned int radix, const WString& sText)
+	{
+		size_t nPrefix = radix == 16 ? 2 : (radix == 8 ? 1 : 0);
+		size_t nGroup = (radix == 10 || radix == 8) ? 3 : 4;
+		char16_t chSeparator = radix == 10 ? u',' : u' ';
+
+		WString sDigits = sText.substr(nPrefix);
+		WString sGrouped;
+		for (size_t i = 0; i < sDigits.size(); ++i)
+		{
+			if (i && (sDigits.size() - i) % nGroup == 0)
+				sGrouped += chSeparator;
+
+			sGrouped += sDigits[i];
+		}
+
+		return sText.substr(0, nPrefix) + sGrouped;
+	}
+
+	std::vector<WString> MakeStrings(unsigned int radix, bool bGrouped, size_t nCount = SAMPLE_COUNT)
+	{
+		std::vector<WString> strings;
+		strings.reserve(nCount);
+		for (uint64_t value : MakeValues(nCount))
+		{
+			WString sText = FormatValue(radix, value);
+			strings.push_back(bGrouped ? GroupDigits(radix, sText) : sText);
+		}
+
+		return strings;
+	}
+
+	void SetBytesPerOp(benchmark::State& state, size_t nBytes, size_t nOps)
+	{
+		state.counters["bytes/op"] = benchmark::Counter(static_cast<double>(nBytes) / static_cast<double>(nOps));
+		state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * nBytes / nOps));
+		state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+	}
+
+	size_t TotalBytes(const std::vector<WString>& strings)
+	{
+		size_t nBytes = 0;
+		for (const WString& sText : strings)
+			nBytes += sText.size() * sizeof(char16_t);
+
+		return nBytes;
+	}
+
+	template <unsigned int Radix>
+	void ParseBenchmark(benchmark::State& state, bool bGrouped)
+	{
+		std::vector<WString> strings = MakeStrings(Radix, bGrouped);
+		size_t i = 0;
+		for (auto _ : state)
+		{
+			uint64_t value = 0;
+			bool bValid = numeric_radix::parse<Radix>(WStringView(strings[i]), value);
+			benchmark::DoNotOptimize(bValid);
+			benchmark::DoNotOptimize(value);
+			i = (i + 1) % strings.size();
+		}
+
+		SetBytesPerOp(state, TotalBytes(strings), strings.size());
+	}
+
+	template <unsigned int Radix>
+	void BM_Parse(benchmark::State& state)
+	{
+		ParseBenchmark<Radix>(state, false);
+	}
+
+	template <unsigned int Radix>
+	void BM_ParseSeparators(benchmark::State& state)
+	{
+		ParseBenchmark<Radix>(state, true);
+	}
+
+	template <unsigned int Radix>
+	void BM_Format(benchmark::State& state)
+	{
+		std::vector<uint64_t> values = MakeValues(SAMPLE_COUNT);
+		char16_t szBuffer[numeric_radix::FORMAT_BUFFER_SIZE];
+		size_t nBytes = 0;
+		for (uint64_t value : values)
+			nBytes += FormatValue(Radix, value).size() * sizeof(char16_t);
+
+		size_t i = 0;
+		for (auto _ : state)
+		{
+			size_t nLength = numeric_radix::format<Radix>(values[i], szBuffer, numeric_radix::FORMAT_BUFFER_SIZE);
+			benchmark::DoNotOptimize(nLength);
+			benchmark::ClobberMemory();
+			i = (i + 1) % values.size();
+		}
+
+		SetBytesPerOp(state, nBytes, values.size());
+	}
+
+	template <unsigned int Radix>
+	void BM_FormatGrouped(benchmark::State& state)
+	{
+		constexpr numeric_radix::Grouping grouping = numeric_radix::DefaultGrouping(Radix);
+
+		std::vector<uint64_t> values = MakeValues(SAMPLE_COUNT);
+		char16_t szBuffer[numeric_radix::GROUPED_FORMAT_BUFFER_SIZE];
+		size_t nBytes = 0;
+		for (uint64_t value : values)
+			nBytes += numeric_radix::format_grouped<Radix>(value, grouping, szBuffer, numeric_radix::GROUPED_FORMAT_BUFFER_SIZE) * sizeof(char16_t);
+
+		size_t i = 0;
+		for (auto _ : state)
+		{
+			size_t nLength = numeric_radix::format_grouped<Radix>(values[i], grouping, szBuffer, numeric_radix::GROUPED_FORMAT_BUFFER_SIZE);
+			benchmark::DoNotOptimize(nLength);
+			benchmark::DoNotOptimize(szBuffer);
+			benchmark::ClobberMemory();
+			i = (i + 1) % values.size();
+		}
+
+		SetBytesPerOp(state, nBytes, values.size());
+	}
+
+	//Parse and format with text of another character type. "Widened" copies char text to UTF-16
+	//before parsing it, as a UTF-8 consumer of a UTF-16-only parser would
+	template <typename CharT>
+	std::vector<std::basic_string<CharT>> ConvertStrings(const std::vector<WString>& strings)
+	{
+		std::vector<std::basic_string<CharT>> converted;
+		converted.reserve(strings.size());
+		for (const WString& sText : strings)
+			converted.emplace_back(sText.begin(), sText.end());
+
+		return converted;
+	}
+
+	template <unsigned int Radix, typename CharT, bool Widened = false>
+	void BM_ParseEncoding(benchmark::State& state)
+	{
+		std::vector<std::basic_string<CharT>> strings = ConvertStrings<CharT>(MakeStrings(Radix, false));
+		size_t nBytes = 0;
+		for (const std::basic_string<CharT>& sText : strings)
+			nBytes += sText.size() * sizeof(CharT);
+
+		size_t i = 0;
+		for (auto _ : state)
+		{
+			uint64_t value = 0;
+			bool bValid;
+			if (Widened)
+			{
+				char16_t szWide[numeric_radix::FORMAT_BUFFER_SIZE + 2];
+				const std::basic_string<CharT>& sText = strings[i];
+				size_t nLength = std::min(sText.size(), sizeof(szWide) / sizeof(szWide[0]));
+				for (size_t nChar = 0; nChar < nLength; ++nChar)
+					szWide[nChar] = static_cast<char16_t>(static_cast<unsigned char>(sText[nChar]));
+
+				bValid = numeric_radix::parse<Radix>(WStringView(szWide, nLength), value);
+			}
+
+			else
+				bValid = numeric_radix::parse<Radix>(std::basic_string_view<CharT>(strings[i]), value);
+
+			benchmark::DoNotOptimize(bValid);
+			benchmark::DoNotOptimize(value);
+			i = (i + 1) % strings.size();
+		}
+
+		SetBytesPerOp(state, nBytes, strings.size());
+	}
+
+	template <unsigned int Radix, typename CharT>
+	void BM_FormatEncoding(benchmark::State& state)
+	{
+		std::vector<uint64_t> values = MakeValues(SAMPLE_COUNT);
+		CharT szBuffer[numeric_radix::FORMAT_BUFFER_SIZE];
+		size_t nBytes = 0;
+		for (uint64_t value : values)
+			nBytes += numeric_radix::format<Radix>(value, szBuffer, numeric_radix::FORMAT_BUFFER_SIZE) * sizeof(CharT);
+
+		size_t i = 0;
+		for (auto _ : state)
+		{
+			size_t nLength = numeric_radix::format<Radix>(values[i], szBuffer, numeric_radix::FORMAT_BUFFER_SIZE);
+			benchmark::DoNotOptimize(nLength);
+			benchmark::ClobberMemory();
+			i = (i + 1) % values.size();
+		}
+
+		SetBytesPerOp(state, nBytes, values.size());
+	}
+
+	//Finite doubles with random bit patterns (17 significant digits, most exponents), or short
+	//decimals as typed (up to 6 digits and a small exponent)
+	std::vector<double> MakeDoubles(bool bShort)
+	{
+		std::mt19937_64 rng(0x5EED);
+		std::vector<double> values;
+		while (values.size() < SAMPLE_COUNT)
+		{
+			double dValue = bShort ? static_cast<double>(rng() % 1000000) * numeric_radix::detail::EXACT_POW10[rng() % 8] / 1e6 :
+				numeric_radix::FloatFromBits<double>(rng());
+
+			if (std::isfinite(dValue))
+				values.push_back(dValue);
+		}
+
+		return values;
+	}
+
+	std::vector<std::string> MakeDoubleStrings(bool bShort)
+	{
+		std::vector<std::string> texts;
+		for (double dValue : MakeDoubles(bShort))
+		{
+			char szBuffer[numeric_radix::REAL_FORMAT_BUFFER_SIZE];
+			texts.emplace_back(szBuffer, numeric_radix::format_float(dValue, szBuffer, sizeof(szBuffer)));
+		}
+
+		return texts;
+	}
+
+	//Arg: 0 for format_float(), 1 for snprintf("%.17g"), the shortest printf format that always
+	//round-trips
+	void BM_FloatFormat(benchmark::State& state)
+	{
+		std::vector<double> values = MakeDoubles(false);
+		bool bPrintf = state.range(0) != 0;
+		char szBuffer[numeric_radix::REAL_FORMAT_BUFFER_SIZE];
+		size_t nBytes = 0;
+		size_t i = 0;
+		for (auto _ : state)
+		{
+			size_t nLength = bPrintf ? static_cast<size_t>(std::snprintf(szBuffer, sizeof(szBuffer), "%.17g", values[i])) :
+				numeric_radix::format_float(values[i], szBuffer, sizeof(szBuffer));
+
+			benchmark::DoNotOptimize(szBuffer);
+			nBytes += nLength;
+			i = (i + 1) % values.size();
+		}
+
+		state.counters["bytes/op"] = benchmark::Counter(static_cast<double>(nBytes) / static_cast<double>(state.iterations()));
+		state.SetBytesProcessed(static_cast<int64_t>(nBytes));
+		state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+	}
+
+	//Args: input (0 short decimals, 1 random doubles), then 0 for parse_float(), 1 for strtod()
+	void BM_FloatParse(benchmark::State& state)
+	{
+		std::vector<std::string> texts = MakeDoubleStrings(state.range(0) == 0);
+		bool bStrtod = state.range(1) != 0;
+		size_t nBytes = 0;
+		size_t i = 0;
+		for (auto _ : state)
+		{
+			double dValue = 0;
+			if (bStrtod)
+				dValue = std::strtod(texts[i].c_str(), nullptr);
+			else
+				numeric_radix::parse_float(std::string_view(texts[i]), dValue);
+
+			benchmark::DoNotOptimize(dValue);
+			nBytes += texts[i].size();
+			i = (i + 1) % texts.size();
+		}
+
+		state.counters["bytes/op"] = benchmark::Counter(static_cast<double>(nBytes) / static_cast<double>(state.iterations()));
+		state.SetBytesProcessed(static_cast<int64_t>(nBytes));
+		state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+	}
+
+	constexpr numeric_radix::QFormat Q16_16 = { 16, 16, true };
+
+	void BM_FixedPointFormat(benchmark::State& state)
+	{
+		std::vector<uint64_t> values = MakeValues(SAMPLE_COUNT);
+		char16_t szBuffer[numeric_radix::REAL_FORMAT_BUFFER_SIZE];
+		size_t nBytes = 0;
+		for (uint64_t value : values)
+			nBytes += numeric_radix::format_q(value, Q16_16, szBuffer, numeric_radix::REAL_FORMAT_BUFFER_SIZE) * sizeof(char16_t);
+
+		size_t i = 0;
+		for (auto _ : state)
+		{
+			size_t nLength = numeric_radix::format_q(values[i], Q16_16, szBuffer, numeric_radix::REAL_FORMAT_BUFFER_SIZE);
+			benchmark::DoNotOptimize(nLength);
+			benchmark::DoNotOptimize(szBuffer);
+			i = (i + 1) % values.size();
+		}
+
+		SetBytesPerOp(state, nBytes, values.size());
+	}
+
+	void BM_FixedPointParse(benchmark::State& state)
+	{
+		std::vector<WString> texts;
+		for (uint64_t value : MakeValues(SAMPLE_COUNT))
+		{
+			char16_t szBuffer[numeric_radix::REAL_FORMAT_BUFFER_SIZE];
+			texts.emplace_back(szBuffer, numeric_radix::format_q(value, Q16_16, szBuffer, numeric_radix::REAL_FORMAT_BUFFER_SIZE));
+		}
+
+		size_t nBytes = 0;
+		size_t i = 0;
+		for (auto _ : state)
+		{
+			uint64_t value = 0;
+			numeric_radix::ParseStatus status = numeric_radix::parse_q(WStringView(texts[i]), Q16_16, value);
+			benchmark::DoNotOptimize(status);
+			benchmark::DoNotOptimize(value);
+			nBytes += texts[i].size() * sizeof(char16_t);
+			i = (i + 1) % texts.size();
+		}
+
+		state.counters["bytes/op"] = benchmark::Counter(static_cast<double>(nBytes) / static_cast<double>(state.iterations()));
+		state.SetBytesProcessed(static_cast<int64_t>(nBytes));
+		state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+	}
+
+	//Register-style expressions in mixed radices, with and without a variable
+	const std::vector<WString>& ExprTexts()
+	{
+		static const std::vector<WString> texts =
+		{
+			u"0x1000 + 4*0x40",
+			u"1 << 12 | 0b101",
+			u"~0xFF & mask",
+			u"(base + 0x200) >> 4",
+			u"65,536 * 3 - 1",
+			u"0x8000,0000 / 16",
+			u"(1 << 31) - 1 ^ 0x5555",
+			u"base + (index * 8) % 0x100",
+		};
+
+		return texts;
+	}
+
+	numeric_radix::ExprEvaluator<char16_t> MakeExprEvaluator(size_t nCacheEntries)
+	{
+		numeric_radix::ExprEvaluator<char16_t> evaluator(nCacheEntries);
+		evaluator.SetVariable(u"mask", 0xF0F0F0F0);
+		evaluator.SetVariable(u"base", 0x40000000);
+		evaluator.SetVariable(u"index", 12);
+		return evaluator;
+	}
+
+	//Arg 0: 0 = no cache (compile every time), 1 = cached, re-evaluating the same texts
+	void BM_ExprEvaluate(benchmark::State& state)
+	{
+		const std::vector<WString>& texts = ExprTexts();
+		numeric_radix::ExprEvaluator<char16_t> evaluator = MakeExprEvaluator(state.range(0) ? 64 : 0);
+
+		size_t nBytes = 0;
+		size_t i = 0;
+		for (auto _ : state)
+		{
+			numeric_radix::ExprResult result = evaluator.Evaluate(WStringView(texts[i]), numeric_radix::ExprOptions());
+			benchmark::DoNotOptimize(result);
+			nBytes += texts[i].size() * sizeof(char16_t);
+			i = (i + 1) % texts.size();
+		}
+
+		SetBytesPerOp(state, nBytes, static_cast<size_t>(state.iterations()));
+	}
+
+	//A compiled program run against changing variable values, without the text lookup
+	void BM_ExprProgram(benchmark::State& state)
+	{
+		std::vector<numeric_radix::ExprProgram> programs(ExprTexts().size());
+		numeric_radix::ExprSymbols<char16_t> symbols;
+		symbols.Set(u"mask", 0xF0F0F0F0);
+		symbols.Set(u"base", 0x40000000);
+		symbols.Set(u"index", 12);
+		for (size_t i = 0; i < programs.size(); ++i)
+			numeric_radix::compile_expr(WStringView(ExprTexts()[i]), numeric_radix::ExprOptions(), symbols, programs[i]);
+
+		uint64_t variables[3] = { 0xF0F0F0F0, 0x40000000, 12 };
+		size_t i = 0;
+		for (auto _ : state)
+		{
+			numeric_radix::ExprResult result = numeric_radix::evaluate_expr(programs[i], variables);
+			benchmark::DoNotOptimize(result);
+			variables[2] = (variables[2] + 1) & 0xFF;
+			i = (i + 1) % programs.size();
+		}
+
+		state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+	}
+
+	//Live preview: evaluate each prefix of each text as it is typed, then poll the whole text
+	//repeatedly as an idle preview would. One op is one keystroke or poll
+	void BM_ExprKeystroke(benchmark::State& state)
+	{
+		constexpr size_t POLLS_PER_TEXT = 8;
+
+		const std::vector<WString>& texts = ExprTexts();
+		numeric_radix::ExprEvaluator<char16_t> evaluator = MakeExprEvaluator(64);
+
+		size_t nOps = 0;
+		for (auto _ : state)
+		{
+			for (const WString& text : texts)
+			{
+				for (size_t nLength = 1; nLength <= text.size(); ++nLength)
+					benchmark::DoNotOptimize(evaluator.Evaluate(WStringView(text).substr(0, nLength), numeric_radix::ExprOptions()));
+
+				for (size_t nPoll = 0; nPoll < POLLS_PER_TEXT; ++nPoll)
+					benchmark::DoNotOptimize(evaluator.Evaluate(WStringView(text), numeric_radix::ExprOptions()));
+
+				nOps += text.size() + POLLS_PER_TEXT;
+			}
+		}
+
+		numeric_radix::ExprCacheStats stats = evaluator.GetStats();
+		state.counters["hit%"] = benchmark::Counter(100.0 * static_cast<double>(stats.hits) / static_cast<double>(stats.hits + stats.misses));
+		state.SetItemsProcessed(static_cast<int64_t>(nOps));
+	}
+
+	//One op is a replay of a trace of 1000 editing sessions (about 50K events). Arg 0: 1 to time
+	//each event, reporting the median and 99th percentile over all events in ticks
+	void BM_EditReplay(benchmark::State& state)
+	{
+		numeric_radix::EditTrace<char16_t> trace;
+		numeric_radix::parse_edit_trace(numeric_radix::MakeEditSessionTrace(1000), trace);
+
+		numeric_radix::EditClipboard<char16_t> clipboard;
+		numeric_radix::NumericEditModel<char16_t> model(clipboard);
+		numeric_radix::ReplayStats stats;
+		for (auto _ : state)
+		{
+			if (state.range(0))
+				numeric_radix::replay_edit_trace(model, clipboard, trace, stats);
+			else
+				numeric_radix::replay_edit_trace(model, clipboard, trace);
+		}
+
+		if (state.range(0))
+		{
+			numeric_radix::trace::ProbeStats all = {};
+			for (const numeric_radix::trace::ProbeStats& events : stats.events)
+			{
+				all.calls += events.calls;
+				for (size_t i = 0; i < numeric_radix::trace::ProbeStats::BUCKETS; ++i)
+					all.histogram[i] += events.histogram[i];
+			}
+
+			state.counters["p50_ticks"] = benchmark::Counter(static_cast<double>(all.Percentile(0.5)));
+			state.counters["p99_ticks"] = benchmark::Counter(static_cast<double>(all.Percentile(0.99)));
+		}
+
+		state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * trace.events.size()));
+	}
+
+	//Each value cycles Decimal -> Hex -> Octal -> Binary -> Decimal, one mode change per iteration
+	void BM_ChangeMode(benchmark::State& state)
+	{
+		constexpr unsigned int radices[] = { 10, 16, 8, 2 };
+
+		std::vector<WString> texts = MakeStrings(10, false);
+		std::vector<uint8_t> modes(texts.size(), 0);
+		size_t nBytes = 0;
+		size_t i = 0;
+		for (auto _ : state)
+		{
+			WString& sText = texts[i];
+			uint8_t nNextMode = static_cast<uint8_t>((modes[i] + 1) % 4);
+
+			uint64_t value = 0;
+			char16_t szBuffer[numeric_radix::FORMAT_BUFFER_SIZE];
+			size_t nLength = 0;
+			if (numeric_radix::parse(radices[modes[i]], WStringView(sText), value))
+				nLength = numeric_radix::format(radices[nNextMode], value, szBuffer, numeric_radix::FORMAT_BUFFER_SIZE);
+
+			nBytes += (sText.size() + nLength) * sizeof(char16_t);
+			sText.assign(szBuffer, nLength);
+			modes[i] = nNextMode;
+			i = (i + 1) % texts.size();
+		}
+
+		state.counters["bytes/op"] = benchmark::Counter(static_cast<double>(nBytes) / static_cast<double>(state.iterations()));
+		state.SetBytesProcessed(static_cast<int64_t>(nBytes));
+		state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+	}
+
+	constexpr numeric_radix::FixedFormat SIGNED_32 = { 32, true };
+
+	template <unsigned int Radix>
+	void BM_FormatFixed(benchmark::State& state)
+	{
+		std::vector<uint64_t> values = MakeValues(SAMPLE_COUNT);
+		char16_t szBuffer[numeric_radix::FIXED_FORMAT_BUFFER_SIZE];
+		size_t nBytes = 0;
+		for (uint64_t value : values)
+			nBytes += numeric_radix::format_fixed<Radix>(value, SIGNED_32, szBuffer, numeric_radix::FIXED_FORMAT_BUFFER_SIZE) * sizeof(char16_t);
+
+		size_t i = 0;
+		for (auto _ : state)
+		{
+			size_t nLength = numeric_radix::format_fixed<Radix>(values[i], SIGNED_32, szBuffer, numeric_radix::FIXED_FORMAT_BUFFER_SIZE);
+			benchmark::DoNotOptimize(nLength);
+			benchmark::DoNotOptimize(szBuffer);
+			benchmark::ClobberMemory();
+			i = (i + 1) % values.size();
+		}
+
+		SetBytesPerOp(state, nBytes, values.size());
+	}
+
+	template <unsigned int Radix>
+	void BM_ParseFixed(benchmark::State& state)
+	{
+		std::vector<WString> strings;
+		for (uint64_t value : MakeValues(SAMPLE_COUNT))
+		{
+			char16_t szBuffer[numeric_radix::FIXED_FORMAT_BUFFER_SIZE];
+			strings.emplace_back(szBuffer, numeric_radix::format_fixed<Radix>(value, SIGNED_32, szBuffer, numeric_radix::FIXED_FORMAT_BUFFER_SIZE));
+		}
+
+		size_t i = 0;
+		for (auto _ : state)
+		{
+			uint64_t value = 0;
+			numeric_radix::ParseStatus status = numeric_radix::parse_fixed<Radix>(WStringView(strings[i]), SIGNED_32, value);
+			benchmark::DoNotOptimize(status);
+			benchmark::DoNotOptimize(value);
+			i = (i + 1) % strings.size();
+		}
+
+		SetBytesPerOp(state, TotalBytes(strings), strings.size());
+	}
+
+	//Args: number of values, cache size in bytes (0: format every time)
+	void BM_FormatCache(benchmark::State& state)
+	{
+		constexpr unsigned int radices[] = { 10, 16, 8, 2 };
+
+		std::vector<uint64_t> values = MakeValues(static_cast<size_t>(state.range(0)));
+		numeric_radix::FormatCache<char16_t> cache(static_cast<size_t>(state.range(1)));
+		size_t i = 0;
+		for (auto _ : state)
+		{
+			char16_t szBuffer[numeric_radix::FORMAT_BUFFER_SIZE];
+			unsigned int nRadix = radices[(i / values.size()) % 4];
+			size_t nLength = state.range(1) ? cache.Format(nRadix, values[i % values.size()], szBuffer, numeric_radix::FORMAT_BUFFER_SIZE)
+				: numeric_radix::format(nRadix, values[i % values.size()], szBuffer, numeric_radix::FORMAT_BUFFER_SIZE);
+
+			benchmark::DoNotOptimize(nLength);
+			benchmark::DoNotOptimize(szBuffer);
+			++i;
+		}
+
+		numeric_radix::FormatCacheStats stats = cache.GetStats();
+		if (stats.hits + stats.misses)
+			state.counters["hit%"] = benchmark::Counter(100.0 * static_cast<double>(stats.hits) / static_cast<double>(stats.hits + stats.misses));
+
+		state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+	}
+
+	//PublishValue() from every benchmark thread into one slot, as polling threads would
+	void BM_Publish(benchmark::State& state)
+	{
+		static numeric_radix::ValueSlot s_slot;
+		uint64_t value = static_cast<uint64_t>(state.thread_index()) << 32;
+		for (auto _ : state)
+			s_slot.Publish(++value);
+
+		state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+	}
+
+	//The UI thread's tick while another thread publishes as fast as it can: each iteration takes
+	//the latest value. "coalesced%" is the share of published values that were never taken
+	void BM_PublishTick(benchmark::State& state)
+	{
+		numeric_radix::ValueSlot slot;
+		std::atomic<bool> bStop{ false };
+		std::thread publisher([&]()
+		{
+			uint64_t value = 0;
+			while (!bStop.load(std::memory_order_relaxed))
+				slot.Publish(++value);
+		});
+
+		uint64_t nTaken = 0;
+		for (auto _ : state)
+		{
+			uint64_t value = 0;
+			if (slot.Take(value))
+				++nTaken;
+
+			benchmark::DoNotOptimize(value);
+		}
+
+		bStop.store(true, std::memory_order_relaxed);
+		publisher.join();
+
+		numeric_radix::ValueSlotStats stats = slot.GetStats();
+		if (stats.published)
+			state.counters["coalesced%"] = benchmark::Counter(100.0 * static_cast<double>(stats.coalesced) / static_cast<double>(stats.published));
+
+		state.counters["taken"] = benchmark::Counter(static_cast<double>(nTaken));
+		state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+	}
+
+	//Type each value one character at a time, filtering every keystroke against the text so far
+	template <unsigned int Radix>
+	void BM_Keystroke(benchmark::State& state)
+	{
+		std::vector<WString> strings = MakeStrings(Radix, false);
+		size_t nKeystrokes = 0;
+		for (const WString& sText : strings)
+			nKeystrokes += sText.size();
+
+		size_t i = 0;
+		for (auto _ : state)
+		{
+			const WString& sText = strings[i];
+			bool bAllowed = true;
+			for (size_t nChar = 0; nChar < sText.size(); ++nChar)
+				bAllowed &= numeric_radix::IsKeystrokeAllowed<Radix>(WStringView(sText.data(), nChar), sText[nChar]);
+
+			benchmark::DoNotOptimize(bAllowed);
+			i = (i + 1) % strings.size();
+		}
+
+		SetBytesPerOp(state, TotalBytes(strings), strings.size());
+		state.counters["keys/op"] = benchmark::Counter(static_cast<double>(nKeystrokes) / static_cast<double>(strings.size()));
+	}
+
+	std::vector<WStringView> MakeViews(const std::vector<WString>& strings)
+	{
+		return std::vector<WStringView>(strings.begin(), strings.end());
+	}
+
+	template <size_t Bits>
+	numeric_radix::WideUInt<Bits> MakeWideValue()
+	{
+		std::mt19937_64 rng(0x5EED);
+		numeric_radix::WideUInt<Bits> value;
+		for (uint64_t& limb : value.limbs)
+			limb = rng();
+
+		return value;
+	}
+
+	template <unsigned int Radix, size_t Bits>
+	void BM_WideFormat(benchmark::State& state)
+	{
+		numeric_radix::WideUInt<Bits> value = MakeWideValue<Bits>();
+		std::vector<char16_t> buffer(numeric_radix::WideUInt<Bits>::FORMAT_BUFFER_SIZE);
+		size_t nLength = 0;
+		for (auto _ : state)
+		{
+			nLength = numeric_radix::format_wide<Radix>(value, buffer.data(), buffer.size());
+			benchmark::DoNotOptimize(nLength);
+			benchmark::ClobberMemory();
+		}
+
+		SetBytesPerOp(state, nLength * sizeof(char16_t), 1);
+	}
+
+	template <unsigned int Radix, size_t Bits>
+	void BM_WideParse(benchmark::State& state)
+	{
+		std::vector<char16_t> buffer(numeric_radix::WideUInt<Bits>::FORMAT_BUFFER_SIZE);
+		size_t nLength = numeric_radix::format_wide<Radix>(MakeWideValue<Bits>(), buffer.data(), buffer.size());
+		WStringView text(buffer.data(), nLength);
+		for (auto _ : state)
+		{
+			numeric_radix::WideUInt<Bits> value;
+			bool bValid = numeric_radix::parse_wide<Radix>(text, value);
+			benchmark::DoNotOptimize(bValid);
+			benchmark::DoNotOptimize(value);
+		}
+
+		SetBytesPerOp(state, nLength * sizeof(char16_t), 1);
+	}
+
+	//Clipboard memory of state.range(0) characters holding either a single value followed by the
+	//terminator and slack (Value), or a whole CRLF-separated column of values pasted into a
+	//single-value control (Table). Parsing stops at the terminator or the first line break, so
+	//the time per paste is independent of the buffer size
+	void BM_PasteBuffer(benchmark::State& state)
+	{
+		std::vector<char16_t> buffer(static_cast<size_t>(state.range(0)), u'\0');
+		if (state.range(1))
+		{
+			std::vector<WString> strings = MakeStrings(16, false);
+			for (size_t nPos = 0, i = 0; nPos + numeric_radix::FORMAT_BUFFER_SIZE + 2 < buffer.size(); i = (i + 1) % strings.size())
+			{
+				WString sLine = strings[i] + u"\r\n";
+				std::copy(sLine.begin(), sLine.end(), buffer.begin() + nPos);
+				nPos += sLine.size();
+			}
+		}
+		else
+		{
+			WString sValue = FormatValue(16, 0x0123456789ABCDEFull);
+			std::copy(sValue.begin(), sValue.end(), buffer.begin());
+		}
+
+		for (auto _ : state)
+		{
+			uint64_t value = 0;
+			bool bValid = numeric_radix::parse_buffer(16, buffer.data(), buffer.size(), value);
+			benchmark::DoNotOptimize(bValid);
+			benchmark::DoNotOptimize(value);
+		}
+
+		state.counters["buffer bytes"] = benchmark::Counter(static_cast<double>(buffer.size() * sizeof(char16_t)));
+		state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+	}
+
+	//Rows of 8 grouped hex values, tab-separated with CRLF line ends, as copied from Excel
+	void BM_PasteTable(benchmark::State& state)
+	{
+		std::vector<WString> strings = MakeStrings(16, true);
+		WString sTable;
+		for (size_t i = 0; sTable.size() * sizeof(char16_t) < static_cast<size_t>(state.range(0)); i = (i + 1) % strings.size())
+			sTable += strings[i] + ((i % 8) == 7 ? u"\r\n" : u"\t");
+
+		size_t nValues = 0;
+		for (auto _ : state)
+		{
+			numeric_radix::PasteResult result = numeric_radix::parse_paste(16, sTable.c_str(), sTable.size() + 1);
+			nValues = result.values.size();
+			benchmark::DoNotOptimize(result.values.data());
+		}
+
+		state.counters["values"] = benchmark::Counter(static_cast<double>(nValues));
+		state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * sTable.size() * sizeof(char16_t)));
+		state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * nValues));
+	}
+
+	//Each step asks for the text of every visible cell, as LVN_GETDISPINFO does on a repaint
+	void BM_GridScroll(benchmark::State& state)
+	{
+		const size_t nRows = static_cast<size_t>(state.range(0));
+		const size_t nColumns = 16;
+		const size_t nVisible = 40;
+
+		numeric_radix::GridModel<char16_t> grid(nRows, nColumns, numeric_radix::DisplayMode::Hex);
+		std::mt19937_64 rng(42);
+		for (size_t nRow = 0; nRow < nRows; ++nRow)
+		{
+			for (size_t nColumn = 0; nColumn < nColumns; ++nColumn)
+				grid.SetValue(nRow, nColumn, rng());
+		}
+
+		grid.SetVisibleRows(nVisible + 1);
+
+		size_t nTop = 0;
+		for (auto _ : state)
+		{
+			for (size_t nRow = nTop; nRow < nTop + nVisible; ++nRow)
+			{
+				for (size_t nColumn = 0; nColumn < nColumns; ++nColumn)
+					benchmark::DoNotOptimize(grid.GetText(nRow, nColumn).data());
+			}
+
+			nTop = (nTop + 1) % (nRows - nVisible);
+		}
+
+		numeric_radix::GridModel<char16_t>::CacheStats stats = grid.GetCacheStats();
+		state.counters["hit%"] = benchmark::Counter(100.0 * static_cast<double>(stats.hits) / static_cast<double>(stats.hits + stats.misses));
+		state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * nVisible * nColumns));
+	}
+
+	void BM_ParseBatch(benchmark::State& state)
+	{
+		std::vector<WString> strings = MakeStrings(16, false, static_cast<size_t>(state.range(0)));
+		std::vector<WStringView> views = MakeViews(strings);
+		std::vector<uint64_t> values(views.size());
+		std::vector<uint8_t> validBits((views.size() + 7) / 8);
+
+		for (auto _ : state)
+		{
+			size_t nValid = numeric_radix::parse_batch(16, views.data(), views.size(), values.data(), validBits.data());
+			benchmark::DoNotOptimize(nValid);
+		}
+
+		state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * views.size()));
+		state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * TotalBytes(strings)));
+	}
+
+	void BM_ParallelParseBatch(benchmark::State& state)
+	{
+		std::vector<WString> strings = MakeStrings(16, false, static_cast<size_t>(state.range(0)));
+		std::vector<WStringView> views = MakeViews(strings);
+		std::vector<uint64_t> values(views.size());
+		std::vector<uint8_t> validBits((views.size() + 7) / 8);
+
+		//The pool is started outside the timed loop, as an application would keep one
+		unsigned int nThreads = static_cast<unsigned int>(state.range(1));
+		numeric_radix::ParallelPool pool(nThreads ? nThreads - 1 : 0);
+		numeric_radix::ParallelOptions options;
+		options.threadCount = nThreads;
+		options.pool = &pool;
+
+		for (auto _ : state)
+		{
+			size_t nValid = numeric_radix::parallel_parse_batch(16, views.data(), views.size(), values.data(), validBits.data(), options);
+			benchmark::DoNotOptimize(nValid);
+		}
+
+		state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * views.size()));
+		state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * TotalBytes(strings)));
+	}
+
+	//Arg: 1 to pass each event to a ring buffer sink
+	void BM_TraceProbe(benchmark::State& state)
+	{
+		numeric_radix::trace::Stats stats = {};
+		numeric_radix::trace::RingBufferSink sink(4096);
+		numeric_radix::trace::SetSink(state.range(0) ? &sink : nullptr);
+
+		for (auto _ : state)
+		{
+			numeric_radix::trace::ScopedProbe probe(stats, numeric_radix::trace::Probe::AsValue);
+			benchmark::ClobberMemory();
+		}
+
+		numeric_radix::trace::SetSink(nullptr);
+		state.counters["p99 ticks"] = benchmark::Counter(static_cast<double>(stats[numeric_radix::trace::Probe::AsValue].Percentile(0.99)));
+		state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+	}
+}
+
+BENCHMARK_TEMPLATE(BM_Parse, 10)->Name("Parse/Decimal");
+BENCHMARK_TEMPLATE(BM_Parse, 16)->Name("Parse/Hex");
+BENCHMARK_TEMPLATE(BM_Parse, 8)->Name("Parse/Octal");
+BENCHMARK_TEMPLATE(BM_Parse, 2)->Name("Parse/Binary");
+
+BENCHMARK_TEMPLATE(BM_ParseSeparators, 10)->Name("ParseSeparators/Decimal");
+BENCHMARK_TEMPLATE(BM_ParseSeparators, 16)->Name("ParseSeparators/Hex");
+BENCHMARK_TEMPLATE(BM_ParseSeparators, 8)->Name("ParseSeparators/Octal");
+BENCHMARK_TEMPLATE(BM_ParseSeparators, 2)->Name("ParseSeparators/Binary");
+
+BENCHMARK_TEMPLATE(BM_Format, 10)->Name("Format/Decimal");
+BENCHMARK_TEMPLATE(BM_Format, 16)->Name("Format/Hex");
+BENCHMARK_TEMPLATE(BM_Format, 8)->Name("Format/Octal");
+BENCHMARK_TEMPLATE(BM_Format, 2)->Name("Format/Binary");
+
+BENCHMARK_TEMPLATE(BM_FormatGrouped, 10)->Name("FormatGrouped/Decimal");
+BENCHMARK_TEMPLATE(BM_FormatGrouped, 16)->Name("FormatGrouped/Hex");
+BENCHMARK_TEMPLATE(BM_FormatGrouped, 8)->Name("FormatGrouped/Octal");
+BENCHMARK_TEMPLATE(BM_FormatGrouped, 2)->Name("FormatGrouped/Binary");
+
+BENCHMARK_TEMPLATE(BM_ParseEncoding, 10, char)->Name("Encoding/Parse/Decimal/char");
+BENCHMARK_TEMPLATE(BM_ParseEncoding, 10, char16_t)->Name("Encoding/Parse/Decimal/char16_t");
+BENCHMARK_TEMPLATE(BM_ParseEncoding, 10, char32_t)->Name("Encoding/Parse/Decimal/char32_t");
+BENCHMARK_TEMPLATE(BM_ParseEncoding, 10, wchar_t)->Name("Encoding/Parse/Decimal/wchar_t");
+#ifdef __cpp_char8_t
+BENCHMARK_TEMPLATE(BM_ParseEncoding, 10, char8_t)->Name("Encoding/Parse/Decimal/char8_t");
+#endif
+BENCHMARK_TEMPLATE(BM_ParseEncoding, 10, char, true)->Name("Encoding/Parse/Decimal/Widened");
+BENCHMARK_TEMPLATE(BM_ParseEncoding, 16, char)->Name("Encoding/Parse/Hex/char");
+BENCHMARK_TEMPLATE(BM_ParseEncoding, 16, char16_t)->Name("Encoding/Parse/Hex/char16_t");
+BENCHMARK_TEMPLATE(BM_ParseEncoding, 16, char32_t)->Name("Encoding/Parse/Hex/char32_t");
+BENCHMARK_TEMPLATE(BM_ParseEncoding, 16, wchar_t)->Name("Encoding/Parse/Hex/wchar_t");
+#ifdef __cpp_char8_t
+BENCHMARK_TEMPLATE(BM_ParseEncoding, 16, char8_t)->Name("Encoding/Parse/Hex/char8_t");
+#endif
+BENCHMARK_TEMPLATE(BM_ParseEncoding, 16, char, true)->Name("Encoding/Parse/Hex/Widened");
+BENCHMARK_TEMPLATE(BM_ParseEncoding, 2, char)->Name("Encoding/Parse/Binary/char");
+BENCHMARK_TEMPLATE(BM_ParseEncoding, 2, char16_t)->Name("Encoding/Parse/Binary/char16_t");
+BENCHMARK_TEMPLATE(BM_ParseEncoding, 2, char32_t)->Name("Encoding/Parse/Binary/char32_t");
+BENCHMARK_TEMPLATE(BM_ParseEncoding, 2, wchar_t)->Name("Encoding/Parse/Binary/wchar_t");
+#ifdef __cpp_char8_t
+BENCHMARK_TEMPLATE(BM_ParseEncoding, 2, char8_t)->Name("Encoding/Parse/Binary/char8_t");
+#endif
+BENCHMARK_TEMPLATE(BM_ParseEncoding, 2, char, true)->Name("Encoding/Parse/Binary/Widened");
+BENCHMARK_TEMPLATE(BM_FormatEncoding, 10, char)->Name("Encoding/Format/Decimal/char");
+BENCHMARK_TEMPLATE(BM_FormatEncoding, 10, char16_t)->Name("Encoding/Format/Decimal/char16_t");
+BENCHMARK_TEMPLATE(BM_FormatEncoding, 10, char32_t)->Name("Encoding/Format/Decimal/char32_t");
+BENCHMARK_TEMPLATE(BM_FormatEncoding, 16, char)->Name("Encoding/Format/Hex/char");
+BENCHMARK_TEMPLATE(BM_FormatEncoding, 16, char16_t)->Name("Encoding/Format/Hex/char16_t");
+BENCHMARK_TEMPLATE(BM_FormatEncoding, 16, char32_t)->Name("Encoding/Format/Hex/char32_t");
+BENCHMARK_TEMPLATE(BM_FormatEncoding, 2, char)->Name("Encoding/Format/Binary/char");
+BENCHMARK_TEMPLATE(BM_FormatEncoding, 2, char16_t)->Name("Encoding/Format/Binary/char16_t");
+BENCHMARK_TEMPLATE(BM_FormatEncoding, 2, char32_t)->Name("Encoding/Format/Binary/char32_t");
+
+BENCHMARK_TEMPLATE(BM_ParseFixed, 10)->Name("ParseFixed/SignedDecimal32");
+BENCHMARK_TEMPLATE(BM_ParseFixed, 16)->Name("ParseFixed/Hex32");
+BENCHMARK_TEMPLATE(BM_ParseFixed, 2)->Name("ParseFixed/Binary32");
+BENCHMARK_TEMPLATE(BM_FormatFixed, 10)->Name("FormatFixed/SignedDecimal32");
+BENCHMARK_TEMPLATE(BM_FormatFixed, 16)->Name("FormatFixed/Hex32");
+BENCHMARK_TEMPLATE(BM_FormatFixed, 2)->Name("FormatFixed/Binary32");
+
+BENCHMARK(BM_FloatFormat)->Name("FloatFormat/Shortest")->Arg(0);
+BENCHMARK(BM_FloatFormat)->Name("FloatFormat/Printf17")->Arg(1);
+BENCHMARK(BM_FloatParse)->Name("FloatParse/Short/Core")->Args({ 0, 0 });
+BENCHMARK(BM_FloatParse)->Name("FloatParse/Short/Strtod")->Args({ 0, 1 });
+BENCHMARK(BM_FloatParse)->Name("FloatParse/Random/Core")->Args({ 1, 0 });
+BENCHMARK(BM_FloatParse)->Name("FloatParse/Random/Strtod")->Args({ 1, 1 });
+BENCHMARK(BM_FixedPointFormat)->Name("FixedPoint/Format/Q16.16");
+BENCHMARK(BM_FixedPointParse)->Name("FixedPoint/Parse/Q16.16");
+
+BENCHMARK(BM_ExprEvaluate)->Name("Expr/Compile")->Arg(0);
+BENCHMARK(BM_ExprEvaluate)->Name("Expr/Cached")->Arg(1);
+BENCHMARK(BM_ExprProgram)->Name("Expr/Program");
+BENCHMARK(BM_ExprKeystroke)->Name("Expr/Keystroke");
+
+BENCHMARK(BM_ChangeMode)->Name("ChangeMode");
+
+BENCHMARK(BM_FormatCache)->Name("FormatCache/Uncached")->Args({ 1024, 0 });
+BENCHMARK(BM_FormatCache)->Name("FormatCache/1MB")->Args({ 1024, 1 << 20 });
+BENCHMARK(BM_FormatCache)->Name("FormatCache/Small")->Args({ 64, 1 << 20 });
+BENCHMARK(BM_FormatCache)->Name("FormatCache/Thrashing")->Args({ 64 * 1024, 1 << 20 });
+
+BENCHMARK(BM_Publish)->Name("Publish/Store")->Threads(1)->Threads(4);
+BENCHMARK(BM_PublishTick)->Name("Publish/Tick")->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_Keystroke, 10)->Name("Keystroke/Decimal");
+BENCHMARK_TEMPLATE(BM_Keystroke, 16)->Name("Keystroke/Hex");
+BENCHMARK_TEMPLATE(BM_Keystroke, 8)->Name("Keystroke/Octal");
+BENCHMARK_TEMPLATE(BM_Keystroke, 2)->Name("Keystroke/Binary");
+
+BENCHMARK(BM_EditReplay)->Name("EditReplay/Untimed")->Arg(0);
+BENCHMARK(BM_EditReplay)->Name("EditReplay/Timed")->Arg(1);
+
+BENCHMARK(BM_PasteBuffer)->Name("PasteBuffer/Value")->Args({ 1 << 22, 0 });
+BENCHMARK(BM_PasteBuffer)->Name("PasteBuffer/Table")->Args({ 1 << 22, 1 });
+BENCHMARK(BM_PasteTable)->Name("PasteTable")->Arg(10 << 20)->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_GridScroll)->Name("GridScroll")->Arg(1 << 16);
+
+BENCHMARK(BM_ParseBatch)->Name("ParseBatch")->Arg(1 << 16)->Arg(1 << 20);
+BENCHMARK(BM_ParallelParseBatch)->Name("ParallelParseBatch")->Args({ 1 << 20, 1 })->Args({ 1 << 20, 4 })->Args({ 1 << 20, 0 })->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_WideFormat, 10, 128)->Name("WideFormat/Decimal/128");
+BENCHMARK_TEMPLATE(BM_WideFormat, 16, 128)->Name("WideFormat/Hex/128");
+BENCHMARK_TEMPLATE(BM_WideFormat, 10, 256)->Name("WideFormat/Decimal/256");
+BENCHMARK_TEMPLATE(BM_WideFormat, 16, 256)->Name("WideFormat/Hex/256");
+BENCHMARK_TEMPLATE(BM_WideFormat, 10, 4096)->Name("WideFormat/Decimal/4096");
+BENCHMARK_TEMPLATE(BM_WideFormat, 16, 4096)->Name("WideFormat/Hex/4096");
+BENCHMARK_TEMPLATE(BM_WideFormat, 2, 4096)->Name("WideFormat/Binary/4096");
+
+BENCHMARK_TEMPLATE(BM_WideParse, 10, 128)->Name("WideParse/Decimal/128");
+BENCHMARK_TEMPLATE(BM_WideParse, 16, 128)->Name("WideParse/Hex/128");
+BENCHMARK_TEMPLATE(BM_WideParse, 10, 4096)->Name("WideParse/Decimal/4096");
+BENCHMARK_TEMPLATE(BM_WideParse, 16, 4096)->Name("WideParse/Hex/4096");
+
+BENCHMARK(BM_TraceProbe)->Name("TraceProbe/Stats")->Arg(0);
+BENCHMARK(BM_TraceProbe)->Name("TraceProbe/RingBuffer")->Arg(1);
+
+BENCHMARK_MAIN();
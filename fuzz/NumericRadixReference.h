@@ -0,0 +1,296 @@
+#pragma once
+
+/*
+	NumericRadixReference.h
+
+	Reference model of CNumericEditControl's original conversions, for differential checks of the
+	optimized engine in NumericRadix*.h:
+
+		ParseValueInternal()	commas and spaces are removed, then wcstoull() in the mode's radix
+								must consume all of the rest, and ERANGE is rejected
+		AsValue()				the parsed value, or VALUEINVALID (-1) for empty or invalid text
+		UpdateControl()			"%I64u", "0x%I64x", "0%I64o" or _ui64tow() in base 2, and empty
+								text for negative values
+
+	The reference is deliberately simple and slow; it uses the C library in the "C" locale. The
+	Check functions run a text or a value through every fast path the control uses (the parsers
+	with their SIMD kernels, parse_fixed(), batch conversion, 8-, 16- and 32-bit text, and a
+	FormatCache) and describe the first difference from the reference.
+
+	MIT License for CNumericEditControl:
+
+	Copyright (c) 2019-2020 Data Synergy UK Ltd
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <cwchar>
+#include <string>
+
+#include "NumericRadixCache.h"
+#include "NumericRadixSigned.h"
+
+namespace numeric_radix
+{
+	namespace reference
+	{
+		constexpr long long VALUEINVALID = -1;
+
+		//Radices in EDisplayMode order
+		constexpr unsigned int RADICES[] = { 10, 16, 8, 2 };
+
+		constexpr const char* ModeName(unsigned int radix) noexcept
+		{
+			switch (radix)
+			{
+				case 16:	return "hex";
+				case 8:		return "octal";
+				case 2:		return "binary";
+				default:	return "decimal";
+			}
+		}
+
+		//ParseValueInternal(). Text ends at a NUL, as a CString made from it would
+		inline bool Parse(unsigned int radix, std::u16string_view text, uint64_t& value)
+		{
+			thread_local std::wstring sCooked;
+			sCooked.clear();
+			for (char16_t ch : text)
+			{
+				if (ch == u'\0')
+					break;
+
+				if (ch != u',' && ch != u' ')
+					sCooked.push_back(static_cast<wchar_t>(ch));
+			}
+
+			errno = 0;
+			wchar_t* pEnd = nullptr;
+			unsigned long long ullValue = wcstoull(sCooked.c_str(), &pEnd, static_cast<int>(radix));
+
+			if (pEnd == sCooked.c_str() || *pEnd != L'\0')
+				return false;
+
+			if ((static_cast<long long>(ullValue) == LLONG_MIN || ullValue == ULLONG_MAX) && errno == ERANGE)
+				return false;
+
+			value = ullValue;
+			return true;
+		}
+
+		inline long long AsValue(unsigned int radix, std::u16string_view text)
+		{
+			uint64_t value = 0;
+			return Parse(radix, text, value) ? static_cast<long long>(value) : VALUEINVALID;
+		}
+
+		//Text of an unsigned value as UpdateControl() formats it
+		inline std::u16string Text(unsigned int radix, uint64_t value)
+		{
+			unsigned long long ullValue = value;
+			char szText[80] = "";
+			switch (radix)
+			{
+				case 16:	snprintf(szText, sizeof(szText), "0x%llx", ullValue);
+							break;
+
+				case 8:		snprintf(szText, sizeof(szText), "0%llo", ullValue);
+							break;
+
+				case 2:		{
+								char* p = szText + sizeof(szText) - 1;
+								*p = '\0';
+								do
+								{
+									*--p = static_cast<char>('0' + (ullValue & 1));
+									ullValue >>= 1;
+								} while (ullValue);
+
+								memmove(szText, p, strlen(p) + 1);
+							}
+							break;
+
+				default:	snprintf(szText, sizeof(szText), "%llu", ullValue);
+							break;
+			}
+
+			return std::u16string(szText, szText + strlen(szText));
+		}
+
+		//UpdateControl()
+		inline std::u16string Display(unsigned int radix, long long llValue)
+		{
+			return llValue < 0 ? std::u16string() : Text(radix, static_cast<uint64_t>(llValue));
+		}
+
+		namespace detail
+		{
+			inline std::string Printable(std::u16string_view text)
+			{
+				std::string sText;
+				for (char16_t ch : text)
+				{
+					if (ch >= 0x20 && ch < 0x7F && ch != u'\\')
+						sText.push_back(static_cast<char>(ch));
+
+					else
+					{
+						char szEscape[8];
+						snprintf(szEscape, sizeof(szEscape), "\\u%04x", static_cast<unsigned int>(ch));
+						sText += szEscape;
+					}
+				}
+
+				return sText;
+			}
+
+			inline void Describe(std::string* pDetail, const char* pszPath, unsigned int radix, std::u16string_view text, const char* pszExpected, const char* pszActual)
+			{
+				if (!pDetail)
+					return;
+
+				char szLine[160];
+				snprintf(szLine, sizeof(szLine), "%s %s \"", pszPath, ModeName(radix));
+				*pDetail = szLine;
+				*pDetail += Printable(text);
+				snprintf(szLine, sizeof(szLine), "\": expected %s, got %s", pszExpected, pszActual);
+				*pDetail += szLine;
+			}
+
+			inline std::string ParseResult(bool bValid, uint64_t value)
+			{
+				char szText[32] = "invalid";
+				if (bValid)
+					snprintf(szText, sizeof(szText), "%llu", static_cast<unsigned long long>(value));
+
+				return szText;
+			}
+		}
+
+		//Parse text with every fast path; false (with a description) on the first difference
+		inline bool CheckText(unsigned int radix, std::u16string_view text, std::string* pDetail = nullptr)
+		{
+			uint64_t expected = 0;
+			bool bExpected = Parse(radix, text, expected);
+
+			auto fnCompare = [&](const char* pszPath, bool bValid, uint64_t value)
+			{
+				if (bValid == bExpected && (!bValid || value == expected))
+					return true;
+
+				detail::Describe(pDetail, pszPath, radix, text, detail::ParseResult(bExpected, expected).c_str(), detail::ParseResult(bValid, value).c_str());
+				return false;
+			};
+
+			uint64_t value = 0;
+			bool bValid = parse(radix, text, value);
+			if (!fnCompare("parse", bValid, value))
+				return false;
+
+			value = 0;
+			bValid = parse_fixed(radix, text, FixedFormat(), value) == ParseStatus::Ok;
+			if (!fnCompare("parse_fixed", bValid, value))
+				return false;
+
+			long long llValue = 0;
+			uint8_t validBits = 0;
+			parse_batch(radix, &text, 1, &llValue, &validBits);
+			if (!fnCompare("parse_batch", (validBits & 1) != 0, static_cast<uint64_t>(llValue)))
+				return false;
+
+			//Narrow text takes the same paths with 8-bit characters where the text is ASCII
+			char szNarrow[256];
+			if (text.size() <= sizeof(szNarrow))
+			{
+				size_t nLength = 0;
+				for (; nLength < text.size() && text[nLength] < 0x80; ++nLength)
+					szNarrow[nLength] = static_cast<char>(text[nLength]);
+
+				if (nLength == text.size())
+				{
+					value = 0;
+					bValid = parse(radix, std::string_view(szNarrow, nLength), value);
+					if (!fnCompare("parse(char)", bValid, value))
+						return false;
+				}
+			}
+
+			//UTF-32 text takes the character-at-a-time path
+			std::u32string sWide(text.begin(), text.end());
+			value = 0;
+			bValid = parse(radix, std::u32string_view(sWide), value);
+			if (!fnCompare("parse(char32_t)", bValid, value))
+				return false;
+
+			return true;
+		}
+
+		//Display a value with every fast path and parse the result back; false (with a
+		//description) on the first difference. pCache, if not null, is also checked
+		inline bool CheckValue(unsigned int radix, long long llValue, FormatCache<char16_t>* pCache = nullptr, std::string* pDetail = nullptr)
+		{
+			std::u16string sExpected = Display(radix, llValue);
+
+			auto fnCompare = [&](const char* pszPath, const char16_t* pszText, size_t nLength)
+			{
+				if (std::u16string_view(pszText, nLength) == sExpected && pszText[nLength] == u'\0')
+					return true;
+
+				char szValue[32];
+				snprintf(szValue, sizeof(szValue), "%lld", llValue);
+				detail::Describe(pDetail, pszPath, radix, std::u16string_view(pszText, nLength), detail::Printable(sExpected).c_str(), szValue);
+				return false;
+			};
+
+			char16_t szText[FORMAT_BUFFER_SIZE];
+			size_t nLength = 0;
+			format_batch(radix, &llValue, 1, szText, FORMAT_BUFFER_SIZE, &nLength);
+			if (!fnCompare("format_batch", szText, nLength))
+				return false;
+
+			//Negative values are not displayed, so the other paths are not asked to
+			if (llValue < 0)
+				return true;
+
+			uint64_t value = static_cast<uint64_t>(llValue);
+			if (!fnCompare("format", szText, format(radix, value, szText, FORMAT_BUFFER_SIZE)))
+				return false;
+
+			if (!fnCompare("format_fixed", szText, format_fixed(radix, value, FixedFormat(), szText, FORMAT_BUFFER_SIZE)))
+				return false;
+
+			if (pCache && !fnCompare("FormatCache", szText, pCache->Format(radix, value, szText, FORMAT_BUFFER_SIZE)))
+				return false;
+
+			//The displayed text reads back as the value
+			uint64_t parsed = 0;
+			if (!parse(radix, std::u16string_view(sExpected), parsed) || parsed != value)
+			{
+				detail::Describe(pDetail, "round trip", radix, sExpected, detail::ParseResult(true, value).c_str(), "a different value");
+				return false;
+			}
+
+			return CheckText(radix, sExpected, pDetail);
+		}
+	}
+}
@@ -0,0 +1,256 @@
+/*
+	fuzz_parse.cpp
+
+	Differential fuzz target for the conversion engine: every input is parsed with each fast path
+	and with the wcstoull() reference in NumericRadixReference.h, and every value is displayed both
+	ways and read back. Any difference is printed and aborts, so the fuzzer keeps the input.
+
+	Input layout: the first byte selects the display mode (bits 0-1, in EDisplayMode order) and
+	how the rest is read (bit 2 set: UTF-16LE code units, clear: one character per byte, which
+	finds ASCII cases faster). The first 8 bytes after it are also checked as a value.
+
+	With Clang this builds as a libFuzzer target:
+
+		fuzz_parse -max_len=96 corpus/
+
+	AFL++ uses the same entry point when built with CXX=afl-clang-fast++. Other compilers build a
+	standalone driver that replays files given on the command line, or with -r COUNT runs COUNT
+	random inputs drawn from number-like text:
+
+		fuzz_parse -r 1000000 [-s SEED]
+		fuzz_parse crash-1234
+
+	Exit status: 0 if every input matched the reference, 2 on usage or I/O errors. A mismatch aborts.
+
+	MIT License for CNumericEditControl:
+
+	Copyright (c) 2019-2020 Data Synergy UK Ltd
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "NumericRadixReference.h"
+
+namespace
+{
+	using namespace numeric_radix;
+
+	FormatCache<char16_t>& SharedCache()
+	{
+		static FormatCache<char16_t> s_cache(64 * 1024);
+		return s_cache;
+	}
+
+	[[noreturn]] void Fail(const std::string& sDetail)
+	{
+		fprintf(stderr, "MISMATCH %s\n", sDetail.c_str());
+		fflush(stderr);
+		abort();
+	}
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* pData, size_t nSize)
+{
+	if (!nSize)
+		return 0;
+
+	unsigned int radix = reference::RADICES[pData[0] & 3];
+	bool bUtf16 = (pData[0] & 4) != 0;
+	++pData;
+	--nSize;
+
+	std::u16string sText;
+	if (bUtf16)
+	{
+		for (size_t i = 0; i + 1 < nSize; i += 2)
+			sText.push_back(static_cast<char16_t>(pData[i] | (pData[i + 1] << 8)));
+	}
+
+	else
+		sText.assign(pData, pData + nSize);
+
+	std::string sDetail;
+	if (!reference::CheckText(radix, sText, &sDetail))
+		Fail(sDetail);
+
+	//Whatever the text reads as is displayed and read back as well
+	uint64_t value = 0;
+	if (reference::Parse(radix, sText, value) && !reference::CheckValue(radix, static_cast<long long>(value), &SharedCache(), &sDetail))
+		Fail(sDetail);
+
+	if (nSize >= 8)
+	{
+		uint64_t bits = 0;
+		memcpy(&bits, pData, sizeof(bits));
+		if (!reference::CheckValue(radix, static_cast<long long>(bits), &SharedCache(), &sDetail))
+			Fail(sDetail);
+	}
+
+	return 0;
+}
+
+#ifndef NUMERIC_RADIX_LIBFUZZER
+
+namespace
+{
+	//Mostly characters the parsers treat specially, so random inputs reach the interesting paths
+	const char ALPHABET[] = "0123456789abcdefABCDEFxX+-, \t\n\r\v\f_.g";
+
+	void PrintUsage(FILE* pFile)
+	{
+		fprintf(pFile,
+			"Usage: fuzz_parse [-r COUNT] [-s SEED] [FILE...]\n"
+			"  -r COUNT  run COUNT random inputs\n"
+			"  -s SEED   random seed (default 1)\n"
+			"  FILE      replay an input file, e.g. a crash found by libFuzzer\n");
+	}
+
+	void MakeInput(std::mt19937_64& random, std::vector<uint8_t>& input)
+	{
+		input.clear();
+		uint64_t bits = random();
+		input.push_back(static_cast<uint8_t>(bits & 7));
+
+		//Lengths around the 64-bit digit counts: 20 decimal, 16 hex, 22 octal, 64 binary digits
+		size_t nLength = static_cast<size_t>((bits >> 8) % 72);
+		bool bUtf16 = (bits & 4) != 0;
+		for (size_t i = 0; i < nLength; ++i)
+		{
+			uint64_t r = random();
+			uint16_t ch;
+			if (r % 16 == 0)
+				ch = static_cast<uint16_t>(r >> 8);
+
+			else if (i == 0 && r % 4 == 1)
+				ch = '0';
+
+			else
+				ch = static_cast<uint8_t>(ALPHABET[(r >> 8) % (sizeof(ALPHABET) - 1)]);
+
+			if (bUtf16)
+			{
+				input.push_back(static_cast<uint8_t>(ch));
+				input.push_back(static_cast<uint8_t>(ch >> 8));
+			}
+
+			else
+				input.push_back(static_cast<uint8_t>(ch));
+		}
+	}
+
+	bool ReadFile(const char* pszPath, std::vector<uint8_t>& data)
+	{
+		FILE* pFile = fopen(pszPath, "rb");
+		if (!pFile)
+			return false;
+
+		data.clear();
+		uint8_t buffer[4096];
+		size_t nRead;
+		while ((nRead = fread(buffer, 1, sizeof(buffer), pFile)) != 0)
+			data.insert(data.end(), buffer, buffer + nRead);
+
+		bool bOk = !ferror(pFile);
+		fclose(pFile);
+		return bOk;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	unsigned long long nCount = 0;
+	unsigned long long nSeed = 1;
+	std::vector<const char*> files;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if ((!strcmp(argv[i], "-r") || !strcmp(argv[i], "-s")) && i + 1 < argc)
+		{
+			char* pEnd = nullptr;
+			unsigned long long n = strtoull(argv[i + 1], &pEnd, 10);
+			if (pEnd == argv[i + 1] || *pEnd)
+			{
+				PrintUsage(stderr);
+				return 2;
+			}
+
+			(argv[i][1] == 'r' ? nCount : nSeed) = n;
+			++i;
+		}
+
+		else if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help"))
+		{
+			PrintUsage(stdout);
+			return 0;
+		}
+
+		else if (argv[i][0] == '-')
+		{
+			PrintUsage(stderr);
+			return 2;
+		}
+
+		else
+			files.push_back(argv[i]);
+	}
+
+	if (!nCount && files.empty())
+	{
+		PrintUsage(stderr);
+		return 2;
+	}
+
+	std::vector<uint8_t> input;
+	for (const char* pszPath : files)
+	{
+		if (!ReadFile(pszPath, input))
+		{
+			fprintf(stderr, "fuzz_parse: cannot read %s\n", pszPath);
+			return 2;
+		}
+
+		LLVMFuzzerTestOneInput(input.data(), input.size());
+	}
+
+	if (nCount)
+	{
+		std::mt19937_64 random(nSeed);
+		auto start = std::chrono::steady_clock::now();
+		for (unsigned long long n = 0; n < nCount; ++n)
+		{
+			MakeInput(random, input);
+			LLVMFuzzerTestOneInput(input.data(), input.size());
+		}
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		fprintf(stderr, "%llu inputs in %.2fs (%.0f inputs/s), no mismatches\n", nCount, seconds, seconds > 0 ? static_cast<double>(nCount) / seconds : 0.0);
+	}
+
+	return 0;
+}
+
+#endif
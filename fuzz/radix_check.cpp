@@ -0,0 +1,406 @@
+/*
+	radix_check.cpp
+
+	Differential check of the conversion engine against the wcstoull() reference in
+	NumericRadixReference.h, in every display mode:
+
+		radix_check [-j THREADS] [-x | -b BITS] [-w WIDTH] [-n SAMPLES] [-s SEED] [-m dec|hex|oct|bin]
+
+	Each value checked is displayed with each fast path and compared with the reference display,
+	the text is read back, and one variant of it is parsed both ways. The variant is picked from
+	the value: digit separators, upper case, leading white space and signs, leading zeros, a
+	missing or bare prefix, a trailing invalid digit, an embedded NUL, or enough extra digits to
+	overflow 64 bits (the ERANGE rejection).
+
+	By default the sweep is bounded: every value below 2^BITS (default 16), the WIDTH values
+	(default 1024) either side of each power of two and of the radix, where digit counts and
+	fast paths change, and SAMPLES values (default 2^20) drawn from the whole 64-bit range at
+	every digit count. That takes a few CPU seconds and suits a per-commit CI step. -x checks
+	every 32-bit value instead of the first 2^16, which takes a few CPU hours and suits a
+	nightly one.
+
+	Work is shared between THREADS threads (default: one per core) in blocks of 64K values, and
+	all threads use one FormatCache, so its concurrent paths are checked too. Throughput is
+	reported for each mode.
+
+	Exit status: 0 if everything matched the reference, 1 on any mismatch (the first few are
+	printed), 2 on usage errors.
+
+	MIT License for CNumericEditControl:
+
+	Copyright (c) 2019-2020 Data Synergy UK Ltd
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "NumericRadixReference.h"
+
+namespace
+{
+	using namespace numeric_radix;
+
+	constexpr uint64_t BLOCK_SIZE = 64 * 1024;
+	constexpr size_t MAX_REPORTED = 10;
+
+	struct Options
+	{
+		unsigned int nThreads = 0;
+		unsigned int nBits = 16;
+		uint64_t nBandWidth = 1024;
+		uint64_t nSamples = uint64_t(1) << 20;
+		uint64_t nSeed = 1;
+		unsigned int radix = 0;		//0: every mode
+	};
+
+	void PrintUsage(FILE* pFile)
+	{
+		fprintf(pFile,
+			"Usage: radix_check [-j THREADS] [-x | -b BITS] [-w WIDTH] [-n SAMPLES] [-s SEED] [-m dec|hex|oct|bin]\n"
+			"  -j THREADS  worker threads (default: one per core)\n"
+			"  -x          exhaustive: check every 32-bit value (a few CPU hours)\n"
+			"  -b BITS     check every value below 2^BITS, 0 to 32 (default 16)\n"
+			"  -w WIDTH    values checked either side of each power of two and of the radix (default 1024)\n"
+			"  -n SAMPLES  sampled values from the whole 64-bit range (default 1048576)\n"
+			"  -s SEED     seed for the samples (default 1)\n"
+			"  -m MODE     check one display mode only\n");
+	}
+
+	class Checker
+	{
+	public:
+		Checker() : m_cache(1024 * 1024) {}
+
+		void Check(unsigned int radix, uint64_t value)
+		{
+			std::string sDetail;
+			if (!reference::CheckValue(radix, static_cast<long long>(value), &m_cache, &sDetail))
+				Report(sDetail);
+
+			std::u16string sText = reference::Text(radix, value);
+			if (static_cast<long long>(value) < 0 && !reference::CheckText(radix, sText, &sDetail))
+				Report(sDetail);
+
+			Decorate(radix, value, sText);
+			if (!reference::CheckText(radix, sText, &sDetail))
+				Report(sDetail);
+		}
+
+		uint64_t GetMismatches() const noexcept
+		{
+			return m_nMismatches.load(std::memory_order_relaxed);
+		}
+
+		void PrintMismatches() const
+		{
+			for (const std::string& sDetail : m_reported)
+				fprintf(stderr, "MISMATCH %s\n", sDetail.c_str());
+		}
+
+	private:
+		//Rewrite the reference text of value into one of the forms a user can type or paste,
+		//chosen by a hash of the value so that neighbouring values take different forms
+		static void Decorate(unsigned int radix, uint64_t value, std::u16string& sText)
+		{
+			size_t nPrefix = (radix == 16) ? 2 : (radix == 8) ? 1 : 0;
+			uint64_t nHash = (value + radix) * 0x9E3779B97F4A7C15ull;
+			unsigned int nVariant = static_cast<unsigned int>(nHash >> 60);
+			switch (nVariant)
+			{
+				case 0:		//Separators between digits, and around them
+				case 1:		for (size_t i = sText.size() - 1; i > nPrefix; --i)
+							{
+								if ((nHash >> (i % 48)) & 1)
+									sText.insert(i, 1, (nHash >> ((i + 7) % 48)) & 1 ? u',' : u' ');
+							}
+
+							if (nVariant == 1)
+								sText = u" ," + sText + u", ";
+
+							break;
+
+				case 2:		//Upper case digits and prefix
+							for (char16_t& ch : sText)
+							{
+								if (ch >= u'a' && ch <= u'z')
+									ch = static_cast<char16_t>(ch - u'a' + u'A');
+							}
+
+							break;
+
+				case 3:		//Leading white space other than a space
+							sText = std::u16string(1 + (nHash >> 40) % 3, u"\t\n\v\f\r"[(nHash >> 32) % 5]) + sText;
+							break;
+
+				case 4:		sText = u"+" + sText;
+							break;
+
+				case 5:		//Negative values wrap around, as in wcstoull()
+							sText = u"-" + sText;
+							break;
+
+				case 6:		//Leading zeros after the prefix
+							sText.insert(nPrefix, std::u16string(1 + (nHash >> 40) % 24, u'0'));
+							break;
+
+				case 7:		//Hex without its prefix, octal without its leading zero, or a bare prefix
+							if (nPrefix && (nHash & 0x100))
+								sText.erase(0, nPrefix);
+
+							else if (nPrefix)
+								sText.erase(nPrefix);
+
+							else
+								sText = u"0x" + sText;
+
+							break;
+
+				case 8:		//A digit outside the radix, or other trailing junk
+							sText.push_back(radix == 2 ? u'2' : radix == 8 ? u'8' : radix == 10 ? u'a' : u'g');
+							break;
+
+				case 9:		sText.push_back(u"_.xX+-"[(nHash >> 32) % 6]);
+							break;
+
+				case 10:	//Everything from an embedded NUL on is ignored
+							sText.insert(nPrefix + (nHash >> 32) % (sText.size() - nPrefix + 1), 1, u'\0');
+							break;
+
+				case 11:	//Extra digits: these overflow 64 bits unless the value is small
+				case 12:	sText.append(1 + (nHash >> 32) % 8 + (nVariant == 12 ? 64 : 0), radix == 2 ? u'1' : u'7');
+							break;
+
+				case 13:	//A sign after the prefix, or a prefix after the sign
+							if (nPrefix == 2)
+								sText.insert(2, 1, u'-');
+
+							else
+								sText = u"-0x" + sText;
+
+							break;
+
+				default:	//As displayed
+							break;
+			}
+		}
+
+		void Report(const std::string& sDetail)
+		{
+			if (m_nMismatches.fetch_add(1, std::memory_order_relaxed) < MAX_REPORTED)
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_reported.push_back(sDetail);
+			}
+		}
+
+		FormatCache<char16_t> m_cache;
+		std::atomic<uint64_t> m_nMismatches{ 0 };
+		std::mutex m_mutex;
+		std::vector<std::string> m_reported;
+	};
+
+	//Add [centre - nWidth, centre + nWidth], clamped to 64 bits, leaving out values below nFloor
+	//(the exhaustive range already covers them)
+	void AddBand(std::vector<uint64_t>& values, uint64_t centre, uint64_t nWidth, uint64_t nFloor)
+	{
+		uint64_t nFirst = centre > nWidth ? centre - nWidth : 0;
+		uint64_t nLast = centre < UINT64_MAX - nWidth ? centre + nWidth : UINT64_MAX;
+		if (nFirst < nFloor)
+			nFirst = nFloor;
+
+		//value >= nFirst ends the loop when ++value wraps past UINT64_MAX
+		for (uint64_t value = nFirst; value <= nLast && value >= nFirst; ++value)
+			values.push_back(value);
+	}
+
+	//Bands around every power of two (2^63 covers INT64_MAX and INT64_MIN), below 2^64 and around
+	//every power of the radix, the complement of each power of two, then samples of every bit length
+	std::vector<uint64_t> MakeSamples(unsigned int radix, const Options& options)
+	{
+		uint64_t nFloor = uint64_t(1) << options.nBits;
+		std::vector<uint64_t> values;
+		for (unsigned int nBit = 0; nBit < 64; ++nBit)
+		{
+			uint64_t power = uint64_t(1) << nBit;
+			AddBand(values, power, options.nBandWidth, nFloor);
+			values.push_back(~power);
+		}
+
+		AddBand(values, UINT64_MAX, options.nBandWidth, nFloor);
+		for (uint64_t power = radix; ; power *= radix)
+		{
+			AddBand(values, power, options.nBandWidth, nFloor);
+			if (power > UINT64_MAX / radix)
+				break;
+		}
+
+		std::sort(values.begin(), values.end());
+		values.erase(std::unique(values.begin(), values.end()), values.end());
+
+		std::mt19937_64 random(options.nSeed ^ radix);
+		for (uint64_t n = 0; n < options.nSamples; ++n)
+		{
+			uint64_t value = random();
+			values.push_back(value >> (random() % 64));
+		}
+
+		return values;
+	}
+
+	template <typename Fn>
+	void RunBlocks(unsigned int nThreads, uint64_t nCount, Fn fnCheck)
+	{
+		std::atomic<uint64_t> nNext{ 0 };
+		auto fnWorker = [&]()
+		{
+			for (;;)
+			{
+				uint64_t nStart = nNext.fetch_add(BLOCK_SIZE, std::memory_order_relaxed);
+				if (nStart >= nCount)
+					break;
+
+				uint64_t nEnd = (nCount - nStart < BLOCK_SIZE) ? nCount : nStart + BLOCK_SIZE;
+				for (uint64_t n = nStart; n < nEnd; ++n)
+					fnCheck(n);
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for (unsigned int i = 1; i < nThreads; ++i)
+			threads.emplace_back(fnWorker);
+
+		fnWorker();
+		for (std::thread& thread : threads)
+			thread.join();
+	}
+
+	bool ParseNumber(const char* pszText, uint64_t& value)
+	{
+		char* pEnd = nullptr;
+		value = strtoull(pszText, &pEnd, 10);
+		return pEnd != pszText && !*pEnd;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+	for (int i = 1; i < argc; ++i)
+	{
+		uint64_t value = 0;
+		if (!strcmp(argv[i], "-m") && i + 1 < argc)
+		{
+			const char* pszMode = argv[++i];
+			options.radix = !strcmp(pszMode, "dec") ? 10 : !strcmp(pszMode, "hex") ? 16 : !strcmp(pszMode, "oct") ? 8 : !strcmp(pszMode, "bin") ? 2 : 1;
+			if (options.radix == 1)
+			{
+				PrintUsage(stderr);
+				return 2;
+			}
+		}
+
+		else if (!strcmp(argv[i], "-x"))
+			options.nBits = 32;
+
+		else if ((!strcmp(argv[i], "-j") || !strcmp(argv[i], "-b") || !strcmp(argv[i], "-w") || !strcmp(argv[i], "-n") || !strcmp(argv[i], "-s")) && i + 1 < argc && ParseNumber(argv[i + 1], value))
+		{
+			switch (argv[i][1])
+			{
+				case 'j':	options.nThreads = static_cast<unsigned int>(value);
+							break;
+
+				case 'b':	if (value > 32)
+							{
+								PrintUsage(stderr);
+								return 2;
+							}
+
+							options.nBits = static_cast<unsigned int>(value);
+							break;
+
+				case 'w':	options.nBandWidth = value;
+							break;
+
+				case 'n':	options.nSamples = value;
+							break;
+
+				default:	options.nSeed = value;
+							break;
+			}
+
+			++i;
+		}
+
+		else if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help"))
+		{
+			PrintUsage(stdout);
+			return 0;
+		}
+
+		else
+		{
+			PrintUsage(stderr);
+			return 2;
+		}
+	}
+
+	if (!options.nThreads)
+		options.nThreads = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+
+	Checker checker;
+	uint64_t nTotal = 0;
+	double totalSeconds = 0;
+	for (unsigned int radix : reference::RADICES)
+	{
+		if (options.radix && radix != options.radix)
+			continue;
+
+		auto start = std::chrono::steady_clock::now();
+		uint64_t nExhaustive = uint64_t(1) << options.nBits;
+		RunBlocks(options.nThreads, nExhaustive, [&](uint64_t value) { checker.Check(radix, value); });
+
+		std::vector<uint64_t> samples = MakeSamples(radix, options);
+		RunBlocks(options.nThreads, samples.size(), [&](uint64_t n) { checker.Check(radix, samples[n]); });
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		uint64_t nValues = nExhaustive + samples.size();
+		fprintf(stderr, "%-8s %12llu values  %8.2fs  %6.2fM values/s\n", reference::ModeName(radix),
+			static_cast<unsigned long long>(nValues), seconds, seconds > 0 ? static_cast<double>(nValues) / seconds / 1e6 : 0.0);
+
+		nTotal += nValues;
+		totalSeconds += seconds;
+	}
+
+	checker.PrintMismatches();
+	fprintf(stderr, "%llu values on %u threads in %.2fs, %llu mismatches\n", static_cast<unsigned long long>(nTotal),
+		options.nThreads, totalSeconds, static_cast<unsigned long long>(checker.GetMismatches()));
+
+	return checker.GetMismatches() ? 1 : 0;
+}
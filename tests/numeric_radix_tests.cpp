@@ -0,0 +1,1311 @@
+/*
+	numeric_radix_tests.cpp
+
+	Round-trip and edge-case checks for the NumericRadix*.h headers, run by ctest one suite at a
+	time:
+
+		numeric_radix_tests [SUITE...]
+
+	With no arguments every suite is run. Each failed check is printed with its file and line.
+	The conversions of plain 64-bit values are also checked against the original wcstoull() code
+	by radix_check (see fuzz/); these suites cover what that reference does not model.
+
+	Exit status: 0 if every check passed, 1 on any failure, 2 for an unknown suite.
+
+	MIT License for CNumericEditControl:
+
+	Copyright (c) 2019-2020 Data Synergy UK Ltd
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "NumericRadixCache.h"
+#include "NumericRadixGrid.h"
+#include "NumericRadixGroup.h"
+#include "NumericRadixModel.h"
+#include "NumericRadixParallel.h"
+#include "NumericRadixPaste.h"
+#include "NumericRadixPublish.h"
+#include "NumericRadixReal.h"
+#include "NumericRadixReplay.h"
+#include "NumericRadixSigned.h"
+#include "NumericRadixWide.h"
+
+namespace
+{
+	using namespace numeric_radix;
+
+	//Radices in EDisplayMode order
+	constexpr unsigned int RADICES[] = { 10, 16, 8, 2 };
+
+	unsigned int g_nChecks = 0;
+	unsigned int g_nFailures = 0;
+
+	bool Check(bool bPassed, const char* pszExpression, const char* pszFile, int nLine)
+	{
+		++g_nChecks;
+		if (!bPassed)
+		{
+			++g_nFailures;
+			fprintf(stderr, "%s:%d: FAILED %s\n", pszFile, nLine, pszExpression);
+		}
+
+		return bPassed;
+	}
+
+	#define CHECK(expression) Check((expression), #expression, __FILE__, __LINE__)
+
+	//Values around every power of two and of each radix
+	template <typename Fn>
+	void ForEdgeValues(unsigned int radix, Fn fn)
+	{
+		for (unsigned int nBit = 0; nBit < 64; ++nBit)
+		{
+			uint64_t power = uint64_t(1) << nBit;
+			for (uint64_t value : { power - 1, power, power + 1, ~power })
+				fn(value);
+		}
+
+		for (uint64_t power = radix; ; power *= radix)
+		{
+			for (uint64_t value : { power - 1, power, power + 1 })
+				fn(value);
+
+			if (power > UINT64_MAX / radix)
+				break;
+		}
+
+		fn(UINT64_MAX);
+	}
+
+	template <typename CharT>
+	uint64_t ParsedValue(unsigned int radix, std::basic_string_view<CharT> text, bool& bValid)
+	{
+		uint64_t value = 0;
+		bValid = parse(radix, text, value);
+		return value;
+	}
+
+	//parse() and format() in every radix
+	void TestCore()
+	{
+		for (unsigned int radix : RADICES)
+		{
+			ForEdgeValues(radix, [&](uint64_t value)
+			{
+				char szText[FORMAT_BUFFER_SIZE];
+				size_t nLength = format(radix, value, szText, sizeof(szText));
+				bool bValid = false;
+				CHECK(nLength != 0 && nLength == strlen(szText));
+				CHECK(ParsedValue(radix, std::string_view(szText, nLength), bValid) == value && bValid);
+			});
+
+			bool bValid = true;
+			ParsedValue(radix, std::string_view(""), bValid);
+			CHECK(!bValid);
+
+			ParsedValue(radix, std::string_view(" , "), bValid);
+			CHECK(!bValid);
+		}
+
+		//Separators anywhere in the digits, and 64-bit overflow
+		bool bValid = false;
+		CHECK(ParsedValue(10, std::string_view("18,446,744,073,709,551,615"), bValid) == UINT64_MAX && bValid);
+		ParsedValue(10, std::string_view("18446744073709551616"), bValid);
+		CHECK(!bValid);
+		CHECK(ParsedValue(16, std::u16string_view(u"0xdead beef"), bValid) == 0xDEADBEEF && bValid);
+		CHECK(ParsedValue(2, std::u32string_view(U"1010 0101"), bValid) == 0xA5 && bValid);
+
+		//A buffer one character short of the text and its terminator
+		char szText[4];
+		CHECK(format(10, 1000, szText, sizeof(szText)) == 0);
+		CHECK(format(10, 999, szText, sizeof(szText)) == 3);
+	}
+
+	std::string Grouped(unsigned int radix, uint64_t value, Grouping grouping)
+	{
+		char szText[GROUPED_FORMAT_BUFFER_SIZE];
+		return std::string(szText, format_grouped(radix, value, grouping, szText, sizeof(szText)));
+	}
+
+	//parse_fixed() and format_fixed() round trips, and the sign rules at every width
+	void TestSigned()
+	{
+		for (unsigned int radix : RADICES)
+		{
+			for (unsigned int nBits = 1; nBits <= 64; ++nBits)
+			{
+				for (bool bSigned : { false, true })
+				{
+					FixedFormat fixed{ nBits, bSigned };
+					unsigned int nShift = 64 - nBits;
+					ForEdgeValues(radix, [&](uint64_t value)
+					{
+						uint64_t expected = bSigned ? static_cast<uint64_t>(static_cast<int64_t>(value << nShift) >> nShift) : value << nShift >> nShift;
+						char szText[FORMAT_BUFFER_SIZE];
+						size_t nLength = format_fixed(radix, value, fixed, szText, sizeof(szText));
+						uint64_t parsed = ~expected;
+						CHECK(nLength != 0 && parse_fixed(radix, std::string_view(szText, nLength), fixed, parsed) == ParseStatus::Ok && parsed == expected);
+					});
+
+					//"-0" is 0 whatever the width and signedness
+					for (const char* pszZero : { "-0", " -0", "-00", "-0x0" })
+					{
+						if (radix != 16 && strchr(pszZero, 'x'))
+							continue;
+
+						uint64_t value = 1;
+						CHECK(parse_fixed(radix, std::string_view(pszZero), fixed, value) == ParseStatus::Ok && value == 0);
+					}
+				}
+			}
+		}
+
+		//A '-' sign on a nonzero value wraps only at the full unsigned width
+		uint64_t value = 0;
+		CHECK(parse_fixed(10, std::string_view("-1"), FixedFormat{ 8, false }, value) == ParseStatus::OutOfRange);
+		CHECK(parse_fixed(10, std::string_view("-1"), FixedFormat{ 64, false }, value) == ParseStatus::Ok && value == UINT64_MAX);
+		CHECK(parse_fixed(10, std::string_view("-128"), FixedFormat{ 8, true }, value) == ParseStatus::Ok && value == uint64_t(-128));
+		CHECK(parse_fixed(10, std::string_view("-129"), FixedFormat{ 8, true }, value) == ParseStatus::OutOfRange);
+		CHECK(parse_fixed(10, std::string_view("128"), FixedFormat{ 8, true }, value) == ParseStatus::OutOfRange);
+		CHECK(parse_fixed(16, std::string_view("0x80"), FixedFormat{ 8, true }, value) == ParseStatus::Ok && value == uint64_t(-128));
+		CHECK(parse_fixed(16, std::string_view("0x100"), FixedFormat{ 8, false }, value) == ParseStatus::OutOfRange);
+		CHECK(parse_fixed(2, std::string_view("-"), FixedFormat{ 8, true }, value) == ParseStatus::Invalid);
+		CHECK(parse_fixed(2, std::string_view(" "), FixedFormat{ 8, true }, value) == ParseStatus::Empty);
+	}
+
+	//format_grouped(), grouped format_fixed() and MakeDigitContext()
+	void TestGroup()
+	{
+		CHECK(Grouped(10, UINT64_MAX, DefaultGrouping(10)) == "18,446,744,073,709,551,615");
+		CHECK(Grouped(10, 999, DefaultGrouping(10)) == "999");
+		CHECK(Grouped(10, 1000, DefaultGrouping(10)) == "1,000");
+		CHECK(Grouped(16, 0xDEADBEEF, DefaultGrouping(16)) == "0xdead beef");
+		CHECK(Grouped(16, 0x12345, DefaultGrouping(16)) == "0x1 2345");
+		CHECK(Grouped(8, 0777777, DefaultGrouping(8)) == "0777 777");
+		CHECK(Grouped(2, 0x1A5, DefaultGrouping(2)) == "1 1010 0101");
+		CHECK(Grouped(2, 0, DefaultGrouping(2)) == "0");
+		CHECK(Grouped(10, 1234567, Grouping{ 0, ',' }) == "1234567");
+		CHECK(Grouped(10, 1234567, Grouping{ 2, ' ' }) == "1 23 45 67");
+
+		//Only separators that parse() ignores, and a buffer that holds the text and terminator
+		char szText[GROUPED_FORMAT_BUFFER_SIZE];
+		CHECK(format_grouped(10, 1000, Grouping{ 3, '.' }, szText, sizeof(szText)) == 0);
+		CHECK(format_grouped(10, 1000, Grouping{ 3, ',' }, szText, 5) == 0);
+		CHECK(format_grouped(10, 1000, Grouping{ 3, ',' }, szText, 6) == 5);
+		CHECK(format_grouped(7, 1000, Grouping{ 3, ',' }, szText, sizeof(szText)) == 0);
+
+		//Every group size: only the leading group is short, the prefix is never split, and the
+		//text reads back
+		for (unsigned int radix : RADICES)
+		{
+			size_t nPrefix = radix == 16 ? 2 : (radix == 8 ? 1 : 0);
+			for (unsigned int nGroup = 1; nGroup <= 8; ++nGroup)
+			{
+				Grouping grouping = DefaultGrouping(radix);
+				grouping.groupSize = nGroup;
+				ForEdgeValues(radix, [&](uint64_t value)
+				{
+					std::string sGrouped = Grouped(radix, value, grouping);
+					char szPlain[FORMAT_BUFFER_SIZE];
+					size_t nPlain = format(radix, value, szPlain, sizeof(szPlain));
+
+					//Groups after the prefix: the first has 1 to nGroup digits, the rest nGroup
+					std::string sDigits = sGrouped.substr(0, nPrefix);
+					bool bShape = sGrouped.size() > nPrefix;
+					size_t nStart = nPrefix;
+					while (bShape)
+					{
+						size_t nEnd = sGrouped.find(grouping.separator, nStart);
+						size_t nLength = (nEnd == std::string::npos ? sGrouped.size() : nEnd) - nStart;
+						bShape = nLength == nGroup || (nStart == nPrefix && nLength && nLength < nGroup);
+						sDigits += sGrouped.substr(nStart, nLength);
+						if (nEnd == std::string::npos)
+							break;
+
+						nStart = nEnd + 1;
+					}
+
+					bool bValid = false;
+					CHECK(bShape);
+					CHECK(sDigits == std::string(szPlain, nPlain));
+					CHECK(sGrouped.size() == nPrefix + detail::GroupedLength(nPlain - nPrefix, grouping));
+					CHECK(ParsedValue(radix, std::string_view(sGrouped), bValid) == value && bValid);
+				});
+			}
+		}
+
+		//Fixed widths: signed decimal groups the magnitude, two's complement groups every digit
+		CHECK(format_fixed(10, uint64_t(-1234567), FixedFormat{ 64, true }, szText, sizeof(szText), DefaultGrouping(10)) == 10);
+		CHECK(!strcmp(szText, "-1,234,567"));
+		CHECK(format_fixed(16, uint64_t(-2), FixedFormat{ 16, true }, szText, sizeof(szText), Grouping{ 2, ' ' }) == 7);
+		CHECK(!strcmp(szText, "0xff fe"));
+		CHECK(format_fixed(2, 5, FixedFormat{ 8, true }, szText, sizeof(szText), DefaultGrouping(2)) == 9);
+		CHECK(!strcmp(szText, "0000 0101"));
+
+		//Separators are not counted as digits, and the selection maps onto the digits
+		KeystrokeContext<char> context = MakeDigitContext<char>("1,234", 2, 3);
+		CHECK(context.length == 4 && context.selStart == 1 && context.selEnd == 2 && context.first == '1' && context.second == '2');
+		context = MakeDigitContext<char>("0x12 3456", 9, 9);
+		CHECK(context.length == 8 && context.selStart == 8 && context.first == '0' && context.second == 'x');
+		context = MakeDigitContext<char>(", 7", 0, 3);
+		CHECK(context.length == 1 && context.selStart == 0 && context.selEnd == 1 && context.first == '7');
+	}
+
+	ExprStatus Evaluate(const char* pszText, uint64_t& value, unsigned int radix = 10, bool bSigned = false)
+	{
+		static ExprEvaluator<char> evaluator;
+		ExprResult result = evaluator.Evaluate(std::string_view(pszText), ExprOptions{ radix, bSigned });
+		value = result.value;
+		return result.status;
+	}
+
+	//compile_expr() and ExprEvaluator, including grouped display text read back as an expression
+	void TestExpr()
+	{
+		uint64_t value = 0;
+		CHECK(Evaluate("1 + 2 * 3", value) == ExprStatus::Ok && value == 7);
+		CHECK(Evaluate("(1 + 2) * 3", value) == ExprStatus::Ok && value == 9);
+		CHECK(Evaluate("0x1000 + 4*0x40", value) == ExprStatus::Ok && value == 0x1100);
+		CHECK(Evaluate("1 << 12 | 0b101", value) == ExprStatus::Ok && value == 0x1005);
+		CHECK(Evaluate("~0", value) == ExprStatus::Ok && value == UINT64_MAX);
+		CHECK(Evaluate("010", value) == ExprStatus::Ok && value == 10);
+		CHECK(Evaluate("010", value, 8) == ExprStatus::Ok && value == 8);
+		CHECK(Evaluate("ff & 0b11", value, 16) == ExprStatus::Ok && value == 0x11);
+		CHECK(Evaluate("1,000 - 1", value) == ExprStatus::Ok && value == 999);
+		CHECK(Evaluate("1 - 2", value) == ExprStatus::Overflow);
+		CHECK(Evaluate("1 - 2", value, 10, true) == ExprStatus::Ok && value == UINT64_MAX);
+		CHECK(Evaluate("-5", value) == ExprStatus::Ok && value == uint64_t(-5));
+		CHECK(Evaluate("-0", value) == ExprStatus::Ok && value == 0);
+		CHECK(FitExprResult(ExprResult{ ExprStatus::Ok, uint64_t(-5), 0 }, FixedFormat{ 8, false }, 10).status == ExprStatus::OutOfRange);
+		CHECK(Evaluate("-8 >> 1", value, 10, true) == ExprStatus::Ok && static_cast<int64_t>(value) == -4);
+		CHECK(Evaluate("-9223372036854775807 - 1", value, 10, true) == ExprStatus::Ok && value == uint64_t(INT64_MIN));
+		CHECK(Evaluate("-9223372036854775807 - 2", value, 10, true) == ExprStatus::Overflow);
+		CHECK(Evaluate("18446744073709551616", value) == ExprStatus::OutOfRange);
+		CHECK(Evaluate("1 / 0", value) == ExprStatus::DivideByZero);
+		CHECK(Evaluate("1 << 64", value) == ExprStatus::BadShift);
+		CHECK(Evaluate("  , ", value) == ExprStatus::Empty);
+		CHECK(Evaluate("1 +", value) == ExprStatus::Syntax);
+		CHECK(Evaluate("12ab", value) == ExprStatus::Syntax);
+		CHECK(Evaluate("019", value) == ExprStatus::Ok && value == 19);
+		CHECK(Evaluate("019", value, 8) == ExprStatus::Syntax);
+		CHECK(Evaluate("(1", value) == ExprStatus::Syntax);
+		CHECK(Evaluate("mask", value) == ExprStatus::UnknownName);
+
+		//A space joins digits of one literal, and only digits
+		CHECK(Evaluate("1 000", value) == ExprStatus::Ok && value == 1000);
+		CHECK(Evaluate("0x1234 5678", value, 16) == ExprStatus::Ok && value == 0x12345678);
+		CHECK(Evaluate("0777 777", value, 8) == ExprStatus::Ok && value == 0777777);
+		CHECK(Evaluate("1010 0101", value, 2) == ExprStatus::Ok && value == 0xA5);
+		CHECK(Evaluate("1 0 + 1", value) == ExprStatus::Ok && value == 11);
+		CHECK(Evaluate("0x10 - 1", value) == ExprStatus::Ok && value == 15);
+		CHECK(Evaluate("1 a", value) == ExprStatus::Syntax);
+		CHECK(Evaluate("0x12 g", value) == ExprStatus::Syntax);
+
+		//Variables, and the cache across a new definition
+		ExprEvaluator<char> evaluator;
+		ExprOptions options{ 16, false };
+		CHECK(evaluator.Evaluate("~0xFF & mask", options).status == ExprStatus::UnknownName);
+		CHECK(evaluator.SetVariable("mask", 0xFFFF));
+		CHECK(evaluator.Evaluate("~0xFF & mask", options).value == 0xFF00);
+		CHECK(evaluator.SetVariable("mask", 0xF0F0));
+		CHECK(evaluator.Evaluate("~0xFF & mask", options).value == 0xF000);
+		CHECK(!evaluator.SetVariable("1st", 0));
+
+		//Program size limits are errors, not overruns
+		std::string sLong = "x";
+		for (int i = 0; i < 100; ++i)
+			sLong += "+x";
+
+		CHECK(evaluator.SetVariable("x", 1));
+		CHECK(evaluator.Evaluate(sLong, options).status == ExprStatus::TooComplex);
+		CHECK(evaluator.Evaluate(std::string(40, '(') + "1" + std::string(40, ')'), options).status == ExprStatus::TooComplex);
+
+		//Grouped display text of every radix reads back as an expression
+		for (unsigned int radix : RADICES)
+		{
+			for (unsigned int nGroup : { 0u, 1u, 2u, 3u, 4u, 8u })
+			{
+				Grouping grouping = DefaultGrouping(radix);
+				grouping.groupSize = nGroup;
+				ForEdgeValues(radix, [&](uint64_t expected)
+				{
+					char szText[GROUPED_FORMAT_BUFFER_SIZE];
+					size_t nLength = format_grouped(radix, expected, grouping, szText, sizeof(szText));
+					ExprResult result = evaluator.Evaluate(std::string_view(szText, nLength), ExprOptions{ radix, false });
+					if (!CHECK(result.status == ExprStatus::Ok && result.value == expected))
+						fprintf(stderr, "  radix %u: \"%s\"\n", radix, szText);
+				});
+			}
+		}
+
+		//The model's own display text parses back in expression mode after the cache is dropped
+		EditClipboard<char> clipboard;
+		NumericEditModel<char> model(clipboard);
+		model.SetExpressionMode(true);
+		for (unsigned int radix : RADICES)
+		{
+			model.ChangeMode(radix);
+			model.SetDigitGrouping(radix, radix == 10 || radix == 8 ? 3 : 4);
+			model.SetValue(0x12345678);
+			model.SetBitWidth(64);
+			CHECK(model.GetValue(value) == ParseStatus::Ok && value == 0x12345678);
+
+			std::string sText(model.GetText());
+			model.KillFocus();
+			CHECK(model.GetText() == sText);
+		}
+	}
+
+	//Parallel conversion matches the serial batch functions, with and without a shared pool
+	void TestParallel()
+	{
+		constexpr size_t nCount = 100003;
+		std::mt19937_64 random(4);
+		std::vector<unsigned long long> values(nCount);
+		for (unsigned long long& ullValue : values)
+			ullValue = random() >> (random() % 64);
+
+		constexpr size_t nStride = FORMAT_BUFFER_SIZE;
+		std::vector<char> serialText(nCount * nStride);
+		std::vector<size_t> serialLengths(nCount);
+		size_t nSerialTotal = format_batch(16, values.data(), nCount, serialText.data(), nStride, serialLengths.data());
+
+		std::vector<std::string_view> views(nCount);
+		for (size_t i = 0; i < nCount; ++i)
+			views[i] = std::string_view(serialText.data() + i * nStride, serialLengths[i]);
+
+		views[77] = "0xg";
+
+		auto fnConvert = [&](ParallelPool* pPool, unsigned int nThreads, size_t nChunkSize)
+		{
+			ParallelOptions options;
+			options.threadCount = nThreads;
+			options.chunkSize = nChunkSize;
+			options.serialThreshold = 0;
+			options.pool = pPool;
+
+			std::vector<char> text(nCount * nStride);
+			std::vector<size_t> lengths(nCount);
+			bool bOk = parallel_format_batch(16, values.data(), nCount, text.data(), nStride, lengths.data(), options) == nSerialTotal;
+			bOk = bOk && lengths == serialLengths && text == serialText;
+
+			std::vector<unsigned long long> parsed(nCount);
+			std::vector<uint8_t> validBits((nCount + 7) / 8);
+			bOk = bOk && parallel_parse_batch(16, views.data(), nCount, parsed.data(), validBits.data(), options) == nCount - 1;
+			bOk = bOk && !(validBits[77 / 8] & (1 << (77 % 8))) && parsed[76] == values[76] && parsed[nCount - 1] == values[nCount - 1];
+			return bOk;
+		};
+
+		ParallelPool pool(3);
+		CHECK(pool.GetThreadCount() == 3);
+
+		//Repeated calls with every thread count, with the pool and with threads per call
+		for (int nRepeat = 0; nRepeat < 3; ++nRepeat)
+		{
+			for (unsigned int nThreads : { 1u, 2u, 3u, 8u, 0u })
+			{
+				CHECK(fnConvert(&pool, nThreads, nRepeat == 1 ? 8 : 0));
+				CHECK(nRepeat || fnConvert(nullptr, nThreads, 0));
+			}
+		}
+
+		//Concurrent callers share the helpers
+		bool bConcurrent[4] = {};
+		std::vector<std::thread> callers;
+		for (bool& bOk : bConcurrent)
+			callers.emplace_back([&]() { bOk = fnConvert(&pool, 4, 1024); });
+
+		for (std::thread& caller : callers)
+			caller.join();
+
+		for (bool bOk : bConcurrent)
+			CHECK(bOk);
+
+		//While one call is running, a second call still gets a helper. Each chunk waits (up to a
+		//few seconds) until a chunk of the second call has run off its caller
+		ParallelOptions options;
+		options.threadCount = 2;
+		options.chunkSize = 8;
+		options.serialThreshold = 0;
+		options.pool = &pool;
+
+		std::atomic<bool> bShared{ false };
+		auto fnWait = [&]()
+		{
+			auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+			while (!bShared && std::chrono::steady_clock::now() < deadline)
+				std::this_thread::yield();
+		};
+
+		std::atomic<bool> bHolding{ false };
+		std::thread holder([&]()
+		{
+			detail::ParallelChunks(4 * 8, 1, options, [&](size_t, size_t)
+			{
+				bHolding = true;
+				fnWait();
+			});
+		});
+
+		while (!bHolding)
+			std::this_thread::yield();
+
+		std::thread::id second = std::this_thread::get_id();
+		detail::ParallelChunks(4 * 8, 1, options, [&](size_t, size_t)
+		{
+			if (std::this_thread::get_id() != second)
+				bShared = true;
+
+			fnWait();
+		});
+
+		holder.join();
+		CHECK(bShared);
+
+		//A conversion started from inside a chunk shares the pool too
+		options.threadCount = 4;
+		std::atomic<int> nNestedOk{ 0 };
+		detail::ParallelChunks(4 * 8, 1, options, [&](size_t, size_t)
+		{
+			nNestedOk += fnConvert(&pool, 4, 4096);
+		});
+
+		CHECK(nNestedOk == 4);
+	}
+
+	//Tokenizing and parsing of pasted tables
+	void TestPaste()
+	{
+		//Blank tokens, CRLF and a trailing line break are skipped; separators inside a token are
+		//digit grouping. The buffer ends at a NUL before its capacity
+		const char szTable[] = "1,000\t2 000\r\n\r\n 3;x\n\t;\n18446744073709551616\n\0" "99";
+		PasteResult result = parse_paste(10, szTable, sizeof(szTable));
+		CHECK(result.values.size() == 5);
+		CHECK(result.values.size() == 5 && result.values[0] == 1000 && result.values[1] == 2000 && result.values[2] == 3);
+		CHECK(result.values.size() == 5 && result.values[3] == UINT64_MAX && result.values[4] == UINT64_MAX);
+		CHECK(result.errors.size() == 2);
+		if (result.errors.size() == 2)
+		{
+			CHECK(result.errors[0].index == 3 && result.errors[0].offset == 18 && result.errors[0].length == 1);
+			CHECK(result.errors[0].status == ParseStatus::Invalid);
+			CHECK(result.errors[1].index == 4 && result.errors[1].length == 20);
+		}
+
+		//Capped token count, and a buffer with no NUL
+		CHECK(parse_paste(10, szTable, sizeof(szTable), 2).values.size() == 2);
+		CHECK(parse_paste(16, u"0xff\n10", 7).values == std::vector<uint64_t>({ 0xFF, 0x10 }));
+		CHECK(parse_paste(10, static_cast<const char*>(nullptr), 10).values.empty());
+		CHECK(parse_paste(7, "1\n2", 4).values.empty());
+
+		//Results are reserved once from the delimiter count, and the default cap bounds them
+		result = parse_paste(10, "1\n2\n3", 6);
+		CHECK(result.values.size() == 3 && result.values.capacity() == 3);
+		std::string sMany(2 * DEFAULT_MAX_PASTE_TOKENS + 2, '\n');
+		for (size_t i = 0; i < sMany.size(); i += 2)
+			sMany[i] = '7';
+
+		result = parse_paste(10, sMany.c_str(), sMany.size() + 1);
+		CHECK(result.values.size() == DEFAULT_MAX_PASTE_TOKENS && result.values.capacity() == DEFAULT_MAX_PASTE_TOKENS);
+
+		//Long tokens take the lane-at-a-time scan in both 8- and 16-bit text
+		std::u16string sLong;
+		std::string sNarrow;
+		for (int i = 0; i < 1000; ++i)
+		{
+			sLong += u"0x0123456789abcdef;";
+			sNarrow += "1111000011110000\t";
+		}
+
+		result = parse_paste(16, sLong.c_str(), sLong.size() + 1);
+		CHECK(result.values.size() == 1000 && result.errors.empty() && result.values[999] == 0x0123456789ABCDEF);
+		result = parse_paste(2, sNarrow.c_str(), sNarrow.size() + 1);
+		CHECK(result.values.size() == 1000 && result.errors.empty() && result.values[999] == 0xF0F0);
+
+		//A fixed format rejects tokens that typed text could not hold
+		const char szSigned[] = "127\n-128\n300\n-129\n-5\nabc";
+		result = parse_paste(10, szSigned, sizeof(szSigned), FixedFormat{ 8, true });
+		CHECK(result.values.size() == 6 && result.errors.size() == 3);
+		if (result.values.size() == 6 && result.errors.size() == 3)
+		{
+			CHECK(result.values[0] == 127 && result.values[1] == uint64_t(-128) && result.values[4] == uint64_t(-5));
+			CHECK(result.errors[0].index == 2 && result.errors[0].status == ParseStatus::OutOfRange);
+			CHECK(result.errors[1].index == 3 && result.errors[1].status == ParseStatus::OutOfRange);
+			CHECK(result.errors[2].index == 5 && result.errors[2].status == ParseStatus::Invalid);
+		}
+
+		result = parse_paste(10, szSigned, sizeof(szSigned), FixedFormat{ 8, false });
+		CHECK(result.errors.size() == 5 && result.values.size() == 6 && result.values[0] == 127);
+
+		result = parse_paste(16, "0xff\n0x100", 11, FixedFormat{ 8, true });
+		CHECK(result.values.size() == 2 && result.values[0] == uint64_t(-1) && result.errors.size() == 1 && result.errors[0].status == ParseStatus::OutOfRange);
+
+		//Any parser, e.g. expressions
+		ExprEvaluator<char> evaluator;
+		result = parse_paste_with("1 + 1\n2 *\n\n", 12, [&](std::string_view token, uint64_t& value)
+		{
+			ExprResult expr = evaluator.Evaluate(token, ExprOptions());
+			value = expr.value;
+			return ExprParseStatus(expr.status);
+		});
+
+		CHECK(result.values.size() == 2 && result.values[0] == 2 && result.errors.size() == 1 && result.errors[0].index == 1);
+	}
+
+	//Every cell's text against a fresh format() of the model's value and mode
+	bool GridMatches(GridModel<char>& grid, size_t nFirstRow, size_t nRows)
+	{
+		for (size_t nRow = nFirstRow; nRow < nFirstRow + nRows && nRow < grid.Rows(); ++nRow)
+		{
+			for (size_t nColumn = 0; nColumn < grid.Columns(); ++nColumn)
+			{
+				char szText[FORMAT_BUFFER_SIZE] = "";
+				if (!grid.IsEmpty(nRow, nColumn))
+					format(RadixOf(grid.GetMode(nRow, nColumn)), grid.GetValue(nRow, nColumn), szText, sizeof(szText));
+
+				std::string_view text = grid.GetText(nRow, nColumn);
+				if (text != szText || text.data()[text.size()] != 0)
+					return false;
+			}
+		}
+
+		return true;
+	}
+
+	//GridModel values, modes, text edits and the row ring cache
+	void TestGrid()
+	{
+		GridModel<char> grid(100, 4);
+		grid.SetVisibleRows(10);
+		CHECK(grid.IsEmpty(5, 2) && grid.GetText(5, 2).empty() && grid.GetMode(5, 2) == DisplayMode::Decimal);
+
+		for (size_t nRow = 0; nRow < grid.Rows(); ++nRow)
+		{
+			for (size_t nColumn = 0; nColumn < grid.Columns(); ++nColumn)
+				grid.SetValue(nRow, nColumn, nRow * 1000 + nColumn);
+		}
+
+		grid.SetColumnMode(1, DisplayMode::Hex);
+		grid.SetMode(3, 2, DisplayMode::Binary);
+		CHECK(grid.GetText(3, 1) == "0xbb9" && grid.GetText(3, 2) == "101110111010" && grid.GetText(3, 0) == "3000");
+
+		//The first view formats every cell once; scrolling by a row formats only the new row
+		grid.Invalidate();
+		grid.ResetCacheStats();
+		CHECK(GridMatches(grid, 0, 10) && grid.GetCacheStats().misses == 40 && grid.GetCacheStats().hits == 0);
+		CHECK(GridMatches(grid, 1, 10) && grid.GetCacheStats().misses == 44 && grid.GetCacheStats().hits == 36);
+
+		//A change reformats just its cell
+		grid.SetValue(5, 0, 7);
+		grid.SetMode(5, 3, DisplayMode::Octal);
+		grid.ResetCacheStats();
+		CHECK(GridMatches(grid, 1, 10) && grid.GetCacheStats().misses == 2);
+		CHECK(grid.GetText(5, 0) == "7" && grid.GetText(5, 3) == "011613");
+
+		//Text edits in the cell's mode; invalid text leaves the cell unchanged, blank text empties it
+		CHECK(grid.SetText(6, 1, "0xff") && grid.GetValue(6, 1) == 255 && grid.GetText(6, 1) == "0xff");
+		CHECK(!grid.SetText(6, 1, "0xfg") && grid.GetValue(6, 1) == 255);
+		CHECK(grid.SetText(6, 1, " , ") && grid.IsEmpty(6, 1) && grid.GetText(6, 1).empty());
+		CHECK(grid.SetText(6, 1, "10") && !grid.IsEmpty(6, 1) && grid.GetText(6, 1) == "0x10");
+
+		//Rows that share a slot take it over from each other
+		CHECK(grid.GetText(7, 0) == "7000" && grid.GetText(17, 0) == "17000" && grid.GetText(7, 0) == "7000");
+
+		//Random edits and views, with and without a cache
+		std::mt19937_64 random(15);
+		for (size_t nVisible : { size_t(0), size_t(1), size_t(7), size_t(200) })
+		{
+			GridModel<char> randomGrid(50, 3, DisplayMode::Hex);
+			randomGrid.SetVisibleRows(nVisible);
+			for (int i = 0; i < 2000; ++i)
+			{
+				size_t nRow = random() % 50, nColumn = random() % 3;
+				switch (random() % 4)
+				{
+					case 0:		randomGrid.SetValue(nRow, nColumn, random() >> (random() % 64));
+								break;
+
+					case 1:		randomGrid.SetMode(nRow, nColumn, static_cast<DisplayMode>(random() % 4));
+								break;
+
+					case 2:		randomGrid.SetEmpty(nRow, nColumn);
+								break;
+
+					default:	randomGrid.SetColumnMode(nColumn, static_cast<DisplayMode>(random() % 4));
+								break;
+				}
+
+				if (!CHECK(GridMatches(randomGrid, random() % 50, 8)))
+					break;
+			}
+		}
+
+		//Resizing discards the cells and the cache
+		grid.Resize(3, 2, DisplayMode::Binary);
+		CHECK(grid.Rows() == 3 && grid.IsEmpty(2, 1) && grid.GetText(2, 1).empty() && grid.GetMode(0, 0) == DisplayMode::Binary);
+		grid.SetValue(2, 1, 5);
+		CHECK(grid.GetText(2, 1) == "101");
+	}
+
+	//Format a wide value in every radix and parse it back, checking 64-bit values against format()
+	template <size_t Bits>
+	void CheckWideRoundTrip(const WideUInt<Bits>& value)
+	{
+		for (unsigned int radix : RADICES)
+		{
+			char szText[WideUInt<Bits>::FORMAT_BUFFER_SIZE + 2];
+			size_t nLength = format_wide(radix, value, szText, sizeof(szText));
+			WideUInt<Bits> parsed;
+			if (!CHECK(nLength != 0 && parse_wide(radix, std::string_view(szText, nLength), parsed) && parsed == value))
+				fprintf(stderr, "  %zu bits, radix %u: \"%s\"\n", Bits, radix, szText);
+
+			if (value.BitLength() <= 64)
+			{
+				char szNarrow[FORMAT_BUFFER_SIZE];
+				format(radix, value.limbs[0], szNarrow, sizeof(szNarrow));
+				CHECK(!strcmp(szText, szNarrow));
+			}
+		}
+	}
+
+	template <size_t Bits>
+	void TestWideBits(std::mt19937_64& random)
+	{
+		using Wide = WideUInt<Bits>;
+
+		Wide value;
+		CHECK(value.IsZero() && value.BitLength() == 0);
+		CheckWideRoundTrip(value);
+
+		for (size_t nBit = 0; nBit < Bits; ++nBit)
+		{
+			value = Wide();
+			value.limbs[nBit / 64] = uint64_t(1) << (nBit % 64);
+			CHECK(!value.IsZero() && value.BitLength() == nBit + 1);
+			if (nBit % 61 == 0 || nBit + 1 == Bits)
+				CheckWideRoundTrip(value);
+		}
+
+		Wide ones;
+		for (uint64_t& limb : ones.limbs)
+			limb = UINT64_MAX;
+
+		CHECK(ones.BitLength() == Bits);
+		CheckWideRoundTrip(ones);
+
+		for (int i = 0; i < 50; ++i)
+		{
+			for (uint64_t& limb : value.limbs)
+				limb = random() >> (random() % 64);
+
+			value.limbs[Wide::LIMBS - 1] >>= random() % 64;
+			CheckWideRoundTrip(value);
+		}
+
+		//One more than the largest value, in hex, does not fit; "-1" wraps to all ones
+		std::string sTooWide = "0x1" + std::string(Bits / 4, '0');
+		Wide parsed;
+		CHECK(!parse_wide(16, std::string_view(sTooWide), parsed));
+		CHECK(parse_wide(10, std::string_view("-1"), parsed) && parsed == ones);
+
+		//A buffer one character short
+		char szText[WideUInt<Bits>::FORMAT_BUFFER_SIZE];
+		CHECK(format_wide(2, ones, szText, Bits) == 0 && format_wide(2, ones, szText, Bits + 1) == Bits);
+	}
+
+	//WideUInt conversion from 128 to 4096 bits
+	void TestWide()
+	{
+		std::mt19937_64 random(7);
+		TestWideBits<128>(random);
+		TestWideBits<256>(random);
+		TestWideBits<4096>(random);
+
+		//2^128 - 1 and 2^128 in decimal, with separators and white space
+		WideUInt<128> value;
+		CHECK(parse_wide(10, std::string_view(" 340,282,366,920,938,463,463,374,607,431,768,211,455"), value));
+		CHECK(value.limbs[0] == UINT64_MAX && value.limbs[1] == UINT64_MAX);
+		CHECK(!parse_wide(10, std::string_view("340282366920938463463374607431768211456"), value));
+
+		WideUInt<256> wider;
+		CHECK(parse_wide(10, std::u16string_view(u"340282366920938463463374607431768211456"), wider));
+		CHECK(wider.limbs[0] == 0 && wider.limbs[1] == 0 && wider.limbs[2] == 1 && wider.BitLength() == 129);
+
+		//Leading zeros do not count against the width; invalid text is rejected
+		CHECK(parse_wide(16, std::string_view("0x" + std::string(100, '0') + "1"), value) && value == WideUInt<128>(1));
+		CHECK(!parse_wide(16, std::string_view("0x"), value));
+		CHECK(!parse_wide(8, std::string_view("0778"), value));
+		CHECK(!parse_wide(2, std::string_view(""), value));
+
+		//At a given width a value must fit it, and negative values wrap to it as parse() wraps
+		//them at 64 bits
+		WideUInt<4096> narrow;
+		for (size_t nBits : { 1, 63, 64, 65, 100, 128, 4095, 4096 })
+		{
+			WideUInt<4096> expected;
+			for (size_t nBit = 0; nBit < nBits; ++nBit)
+				expected.limbs[nBit / 64] |= uint64_t(1) << (nBit % 64);
+
+			CHECK(parse_wide(10, std::string_view("-1"), narrow, nBits) && narrow == expected && narrow.BitLength() == nBits);
+
+			std::vector<char> max(WideUInt<4096>::FORMAT_BUFFER_SIZE);
+			std::string sMax(max.data(), format_wide(16, expected, max.data(), max.size()));
+			CHECK(parse_wide(16, std::string_view(sMax), narrow, nBits) && narrow == expected);
+			CHECK(parse_wide(16, std::string_view("-" + sMax), narrow, nBits) && narrow == WideUInt<4096>(1));
+			CHECK(!parse_wide(16, std::string_view(sMax + "0"), narrow, nBits));
+			CHECK(!parse_wide(16, std::string_view("-" + sMax + "0"), narrow, nBits));
+		}
+
+		CHECK(parse_wide(10, std::string_view("-0"), narrow, 100) && narrow.IsZero());
+		CHECK(parse_wide(10, std::string_view("-5"), narrow, 64) && narrow == WideUInt<4096>(uint64_t(-5)));
+		CHECK(parse_wide(10, std::string_view("-340282366920938463463374607431768211455"), narrow, 128) && narrow == WideUInt<4096>(1));
+		CHECK(!parse_wide(10, std::string_view("-340282366920938463463374607431768211456"), narrow, 128));
+	}
+
+	template <typename T>
+	bool FloatRoundTrips(T value)
+	{
+		char szText[REAL_FORMAT_BUFFER_SIZE];
+		size_t nLength = format_float(value, szText, sizeof(szText));
+		T parsed = 0;
+		bool bOk = nLength && parse_float(std::string_view(szText, nLength), parsed) == ParseStatus::Ok && FloatBits(parsed) == FloatBits(value);
+		if (!bOk)
+			fprintf(stderr, "  %s\n", szText);
+
+		return bOk;
+	}
+
+	template <typename T>
+	std::string FloatText(T value)
+	{
+		char szText[REAL_FORMAT_BUFFER_SIZE];
+		return std::string(szText, format_float(value, szText, sizeof(szText)));
+	}
+
+	std::string QText(uint64_t raw, QFormat q)
+	{
+		char szText[REAL_FORMAT_BUFFER_SIZE];
+		return std::string(szText, format_q(raw, q, szText, sizeof(szText)));
+	}
+
+	ParseStatus ParseQ(const char* pszText, QFormat q, uint64_t& raw)
+	{
+		return parse_q(std::string_view(pszText), q, raw);
+	}
+
+	//format_float(), parse_float(), format_q() and parse_q()
+	void TestReal()
+	{
+		CHECK(FloatText(0.1) == "0.1" && FloatText(0.1f) == "0.1");
+		CHECK(FloatText(1e16) == "1e+16");
+		CHECK(FloatText(-INFINITY) == "-inf" && FloatText(NAN) == "nan");
+		CHECK(FloatText(-0.0) == "-0");
+
+		double dValue = 0;
+		float fValue = 0;
+		CHECK(parse_float(std::string_view("0x1.8p3"), dValue) == ParseStatus::Ok && dValue == 12);
+		CHECK(parse_float(std::string_view("-0x1p-2"), dValue) == ParseStatus::Ok && dValue == -0.25);
+		CHECK(parse_float(std::string_view(" 1,000.5"), dValue) == ParseStatus::Ok && dValue == 1000.5);
+		CHECK(parse_float(std::string_view("+2.5e-3"), dValue) == ParseStatus::Ok && dValue == 2.5e-3);
+		CHECK(parse_float(std::string_view("-infinity"), dValue) == ParseStatus::Ok && std::isinf(dValue) && dValue < 0);
+		CHECK(parse_float(std::string_view("nan"), dValue) == ParseStatus::Ok && std::isnan(dValue));
+		CHECK(parse_float(std::string_view("1e400"), dValue) == ParseStatus::OutOfRange);
+		CHECK(parse_float(std::string_view("1e39"), fValue) == ParseStatus::OutOfRange);
+		CHECK(parse_float(std::string_view("1e39"), dValue) == ParseStatus::Ok && dValue == 1e39);
+		CHECK(parse_float(std::string_view(" , "), dValue) == ParseStatus::Empty);
+		CHECK(parse_float(std::string_view("1.5.2"), dValue) == ParseStatus::Invalid);
+		CHECK(parse_float(std::string_view("--1"), dValue) == ParseStatus::Invalid);
+		CHECK(parse_float(std::string_view("0x"), dValue) == ParseStatus::Invalid);
+		CHECK(parse_float(std::string_view(std::string(REAL_FORMAT_BUFFER_SIZE, '1')), dValue) == ParseStatus::Invalid);
+
+		//Shortest text reads back bit for bit, including zeros, subnormals and the extremes
+		for (double d : { 0.0, -0.0, 5e-324, 2.2250738585072014e-308, 1.7976931348623157e308, 0.3, 1.0 / 3, 123456789012345678.0 })
+			CHECK(FloatRoundTrips(d));
+
+		for (float f : { 0.0f, -0.0f, 1e-45f, 3.4028235e38f, 0.3f, 1.0f / 3 })
+			CHECK(FloatRoundTrips(f));
+
+		std::mt19937_64 random(20);
+		for (int i = 0; i < 20000; ++i)
+		{
+			double d = FloatFromBits<double>(random());
+			float f = FloatFromBits<float>(random());
+			if (!std::isnan(d))
+				CHECK(FloatRoundTrips(d));
+
+			if (!std::isnan(f))
+				CHECK(FloatRoundTrips(f));
+		}
+
+		//Short decimal text takes the fast path and must round as strtod() does
+		for (int i = 0; i < 20000; ++i)
+		{
+			char szText[40];
+			snprintf(szText, sizeof(szText), "%llu.%llue%d", static_cast<unsigned long long>(random() % 1000000000),
+				static_cast<unsigned long long>(random() % 1000000), static_cast<int>(random() % 40) - 20);
+
+			CHECK(parse_float(std::string_view(szText), dValue) == ParseStatus::Ok && dValue == strtod(szText, nullptr));
+		}
+
+		//Qm.n: exact text
+		QFormat q15{ 1, 15, true };
+		CHECK(QText(0x8000, q15) == "-1" && QText(0x4000, q15) == "0.5" && QText(0x0001, q15) == "0.000030517578125");
+		CHECK(QText(0x7FFF, q15) == "0.999969482421875" && QText(0xFFFF, q15) == "-0.000030517578125");
+		CHECK(QText(0x00018000, QFormat{ 16, 16, true }) == "1.5");
+		CHECK(QText(1, QFormat{ 1, 63, true }).size() == 2 + 63);
+		CHECK(QText(0, QFormat{ 0, 64, false }).empty());
+
+		uint64_t raw = 0;
+		CHECK(ParseQ("-1", q15, raw) == ParseStatus::Ok && raw == uint64_t(-32768));
+		CHECK(ParseQ("1", q15, raw) == ParseStatus::OutOfRange);
+		CHECK(ParseQ(".5", q15, raw) == ParseStatus::Ok && raw == 0x4000);
+		CHECK(ParseQ("2.", QFormat{ 8, 0, false }, raw) == ParseStatus::Ok && raw == 2);
+		CHECK(ParseQ("2.5", QFormat{ 8, 0, false }, raw) == ParseStatus::Ok && raw == 2);
+		CHECK(ParseQ("3.5", QFormat{ 8, 0, false }, raw) == ParseStatus::Ok && raw == 4);
+		CHECK(ParseQ("255.5", QFormat{ 8, 0, false }, raw) == ParseStatus::OutOfRange);
+		CHECK(ParseQ("-1", QFormat{ 8, 8, false }, raw) == ParseStatus::OutOfRange);
+		CHECK(ParseQ("0.0000152587890625", q15, raw) == ParseStatus::Ok && raw == 0);
+		CHECK(ParseQ("0.00001525878906250001", q15, raw) == ParseStatus::Ok && raw == 1);
+		CHECK(ParseQ("", q15, raw) == ParseStatus::Empty);
+		CHECK(ParseQ("1.2.3", q15, raw) == ParseStatus::Invalid);
+
+		//Every 16-bit pattern, and samples of wider formats, read back exactly
+		for (QFormat q : { q15, QFormat{ 8, 8, false }, QFormat{ 4, 12, true } })
+		{
+			for (uint64_t n = 0; n < 0x10000; ++n)
+			{
+				uint64_t expected = q.isSigned ? SignExtend(n, 16) : n;
+				if (!CHECK(ParseQ(QText(n, q).c_str(), q, raw) == ParseStatus::Ok && raw == expected))
+					break;
+			}
+		}
+
+		for (QFormat q : { QFormat{ 16, 16, true }, QFormat{ 1, 63, true }, QFormat{ 32, 32, false }, QFormat{ 64, 0, false } })
+		{
+			for (int i = 0; i < 5000; ++i)
+			{
+				uint64_t n = random() & WidthMask(QWidth(q));
+				uint64_t expected = q.isSigned ? SignExtend(n, QWidth(q)) : n;
+				CHECK(ParseQ(QText(n, q).c_str(), q, raw) == ParseStatus::Ok && raw == expected);
+			}
+		}
+	}
+
+	//Apply trace text to a model
+	bool Replay(NumericEditModel<char16_t>& model, EditClipboard<char16_t>& clipboard, std::string_view text)
+	{
+		EditTrace<char16_t> trace;
+		if (!CHECK(parse_edit_trace(text, trace) == 0))
+			return false;
+
+		replay_edit_trace(model, clipboard, trace);
+		return true;
+	}
+
+	//NumericEditModel driven by replayed traces, and the trace format itself
+	void TestModel()
+	{
+		EditClipboard<char16_t> clipboard;
+		uint64_t value = 0;
+
+		//Typing, keystroke rejection and mode changes
+		{
+			NumericEditModel<char16_t> model(clipboard);
+			Replay(model, clipboard, "type 12a34\n");
+			CHECK(model.GetText() == u"1234" && model.GetCaret() == 4);
+			CHECK(model.GetValue(value) == ParseStatus::Ok && value == 1234);
+
+			Replay(model, clipboard, "cmd hex\n");
+			CHECK(model.GetText() == u"0x4d2");
+			Replay(model, clipboard, "cmd bin\n");
+			CHECK(model.GetText() == u"10011010010");
+			Replay(model, clipboard, "cmd oct\ncmd dec\n");
+			CHECK(model.GetText() == u"1234" && model.GetRadix() == 10);
+
+			//Backspace, caret movement, selection and delete. Displaying a value puts the caret at
+			//the start
+			CHECK(model.GetCaret() == 0);
+			Replay(model, clipboard, "key end\nchar 8\nkey home\nkey right shift\nkey delete\n");
+			CHECK(model.GetText() == u"23");
+			Replay(model, clipboard, "key end\ntype 9\nkey left\nkey left\nchar 8\n");
+			CHECK(model.GetText() == u"39");
+
+			//Digits that would take the value beyond the width are refused, and separators left in
+			//the text are not counted as digits
+			Replay(model, clipboard, "text \nwidth 8\ntype 2566\n");
+			CHECK(model.GetText() == u"25");
+			Replay(model, clipboard, "text \ntype 999\n");
+			CHECK(model.GetText() == u"99");
+			Replay(model, clipboard, "text 1,2\nkey end\ntype 59\n");
+			CHECK(model.GetText() == u"1,25" && model.GetValue(value) == ParseStatus::Ok && value == 125);
+			Replay(model, clipboard, "text \nwidth 64\ntype 99999999999999999999\n");
+			CHECK(model.GetText() == u"9999999999999999999");
+			Replay(model, clipboard, "text \ntype 18446744073709551615\n");
+			CHECK(model.GetValue(value) == ParseStatus::Ok && value == UINT64_MAX);
+			Replay(model, clipboard, "cmd hex\nwidth 12\ntext \ntype 0xfff\n");
+			CHECK(model.GetText() == u"0xfff");
+		}
+
+		//Signed widths
+		{
+			NumericEditModel<char16_t> model(clipboard);
+			Replay(model, clipboard, "width 8\nsigned 1\ntype -128\n");
+			CHECK(model.GetValue(value) == ParseStatus::Ok && value == uint64_t(-128));
+			Replay(model, clipboard, "cmd hex\n");
+			CHECK(model.GetText() == u"0x80");
+			Replay(model, clipboard, "cmd dec\ntext -129\n");
+			CHECK(model.GetValue(value) == ParseStatus::OutOfRange);
+			Replay(model, clipboard, "text \ntype -129\n");
+			CHECK(model.GetText() == u"-12");
+			Replay(model, clipboard, "text \ntype 128\n");
+			CHECK(model.GetText() == u"12");
+			Replay(model, clipboard, "width 4\ntext \ntype 8-8\n");
+			CHECK(model.GetText() == u"-8");
+		}
+
+		//Grouping regroups on focus loss; expressions are replaced by their value
+		{
+			NumericEditModel<char16_t> model(clipboard);
+			Replay(model, clipboard, "group dec 3\ntype 1234567\nblur\n");
+			CHECK(model.GetText() == u"1,234,567");
+			Replay(model, clipboard, "cmd hex\ngroup hex 4\nvalue 305419896\n");
+			CHECK(model.GetText() == u"0x1234 5678");
+
+			Replay(model, clipboard, "text \nexpr 1\ntype 0x10 + 1\n");
+			CHECK(model.GetValue(value) == ParseStatus::Ok && value == 17);
+			Replay(model, clipboard, "blur\n");
+			CHECK(model.GetText() == u"0x11");
+			Replay(model, clipboard, "text 1 +\nblur\n");
+			CHECK(model.GetText() == u"1 +" && model.GetValue(value) == ParseStatus::Invalid);
+		}
+
+		//Clipboard: copy, cut, and paste of valid and invalid text
+		{
+			NumericEditModel<char16_t> model(clipboard);
+			Replay(model, clipboard, "value 42\nkey c ctrl\n");
+			CHECK(clipboard.text == u"42");
+			Replay(model, clipboard, "cmd cut\n");
+			CHECK(model.GetText().empty() && model.GetValue(value) == ParseStatus::Empty);
+			Replay(model, clipboard, "clip 0x20\ncmd hex\nkey v ctrl\n");
+			CHECK(model.GetText() == u"0x20" && model.GetValue(value) == ParseStatus::Ok && value == 32);
+			Replay(model, clipboard, "clip zz\ncmd paste\n");
+			CHECK(model.GetText().empty());
+		}
+
+		//The value cache follows the text and the settings
+		{
+			NumericEditModel<char16_t> model(clipboard);
+			model.SetText(u"300");
+			CHECK(model.GetValue(value) == ParseStatus::Ok && value == 300);
+			model.SetBitWidth(8);
+			CHECK(model.GetValue(value) == ParseStatus::OutOfRange);
+			model.SetBitWidth(16);
+			CHECK(model.GetValue(value) == ParseStatus::Ok && value == 300);
+		}
+
+		//Trace errors name their line; synthetic sessions replay deterministically
+		EditTrace<char16_t> trace;
+		CHECK(parse_edit_trace("# comment\n\ntype 1\nkey up\n", trace) == 4);
+		trace = EditTrace<char16_t>();
+		CHECK(parse_edit_trace("cmd hex\nchar x\n", trace) == 2);
+
+		std::string sTrace = MakeEditSessionTrace(200);
+		CHECK(sTrace == MakeEditSessionTrace(200));
+		trace = EditTrace<char16_t>();
+		CHECK(parse_edit_trace(sTrace, trace) == 0 && !trace.events.empty());
+
+		std::u16string sFinal[2];
+		for (std::u16string& sText : sFinal)
+		{
+			EditClipboard<char16_t> sessionClipboard;
+			NumericEditModel<char16_t> model(sessionClipboard);
+			ReplayStats stats;
+			replay_edit_trace(model, sessionClipboard, trace, stats);
+
+			uint64_t nCalls = 0;
+			for (const trace::ProbeStats& probe : stats.events)
+				nCalls += probe.calls;
+
+			CHECK(nCalls == trace.events.size());
+			sText = model.GetText();
+		}
+
+		CHECK(sFinal[0] == sFinal[1]);
+	}
+
+	//FormatCache hits and misses, CLOCK eviction within a set, what is never cached, and lookups
+	//from several threads at once
+	void TestCache()
+	{
+		using Cache = FormatCache<char16_t>;
+		char16_t szText[FORMAT_BUFFER_SIZE];
+
+		//Size a cache to a single set from the bytes a larger one reports
+		FormatCacheStats stats = Cache(64 * 1024).GetStats();
+		size_t nSetBytes = stats.bytes / (stats.entries / Cache::WAYS);
+		CHECK(Cache(nSetBytes).GetStats().entries == Cache::WAYS);
+
+		//Too small for a set: every call formats
+		{
+			Cache cache(nSetBytes - 1);
+			CHECK(cache.GetStats().entries == 0);
+			CHECK(cache.Format(16, 255, szText, FORMAT_BUFFER_SIZE) == 4 && std::u16string_view(szText) == u"0xff");
+			CHECK(cache.Format(16, 255, szText, FORMAT_BUFFER_SIZE) == 4 && cache.GetStats().hits == 0);
+		}
+
+		//A miss formats and a repeat hits; the options are part of the key
+		{
+			Cache cache(nSetBytes);
+			CHECK(cache.Format(16, 255, szText, FORMAT_BUFFER_SIZE) == 4 && std::u16string_view(szText) == u"0xff");
+			CHECK(cache.Format(16, 255, szText, FORMAT_BUFFER_SIZE) == 4 && std::u16string_view(szText) == u"0xff");
+			CHECK(cache.Format(10, 255, szText, FORMAT_BUFFER_SIZE) == 3 && std::u16string_view(szText) == u"255");
+			stats = cache.GetStats();
+			CHECK(stats.hits == 1 && stats.misses == 2 && stats.evictions == 0);
+
+			//A buffer too small for the cached text is a miss, and the format fails as without the cache
+			CHECK(cache.Format(16, 255, szText, 4) == 0);
+			CHECK(cache.GetStats().misses == 3);
+			CHECK(cache.Format(16, 255, szText, 5) == 4 && std::u16string_view(szText) == u"0xff");
+
+			cache.ResetStats();
+			stats = cache.GetStats();
+			CHECK(stats.hits == 0 && stats.misses == 0 && stats.evictions == 0);
+		}
+
+		//A full set evicts in CLOCK order, passing over an entry hit since the hand last passed it
+		{
+			Cache cache(nSetBytes);
+			for (uint64_t value = 0; value < Cache::WAYS; ++value)
+				cache.Format(10, value, szText, FORMAT_BUFFER_SIZE);
+
+			CHECK(cache.Format(10, 0, szText, FORMAT_BUFFER_SIZE) == 1 && cache.GetStats().hits == 1);
+			cache.Format(10, 100, szText, FORMAT_BUFFER_SIZE);
+			CHECK(cache.GetStats().evictions == 1);
+
+			cache.ResetStats();
+			cache.Format(10, 0, szText, FORMAT_BUFFER_SIZE);
+			cache.Format(10, 100, szText, FORMAT_BUFFER_SIZE);
+			CHECK(cache.GetStats().hits == 2 && cache.GetStats().misses == 0);
+			cache.Format(10, 1, szText, FORMAT_BUFFER_SIZE);
+			CHECK(cache.GetStats().misses == 1 && std::u16string_view(szText) == u"1");
+		}
+
+		//Text that is not ASCII, or longer than MAX_LENGTH, is formatted every time
+		{
+			Cache cache(nSetBytes);
+			size_t nCalls = 0;
+			auto fnAccented = [&](char16_t* pBuffer, size_t nCapacity) -> size_t
+			{
+				++nCalls;
+				if (nCapacity < 3)
+					return 0;
+
+				pBuffer[0] = u'1';
+				pBuffer[1] = u'\u00e9';
+				pBuffer[2] = 0;
+				return 2;
+			};
+
+			CHECK(cache.Get(1, 0x100, szText, FORMAT_BUFFER_SIZE, fnAccented) == 2 && szText[1] == u'\u00e9');
+			CHECK(cache.Get(1, 0x100, szText, FORMAT_BUFFER_SIZE, fnAccented) == 2 && nCalls == 2);
+
+			char16_t szLong[Cache::MAX_LENGTH + 2];
+			auto fnLong = [&](char16_t* pBuffer, size_t nCapacity) -> size_t
+			{
+				++nCalls;
+				if (nCapacity < Cache::MAX_LENGTH + 2)
+					return 0;
+
+				std::fill(pBuffer, pBuffer + Cache::MAX_LENGTH + 1, u'7');
+				pBuffer[Cache::MAX_LENGTH + 1] = 0;
+				return Cache::MAX_LENGTH + 1;
+			};
+
+			nCalls = 0;
+			CHECK(cache.Get(2, 0x100, szLong, Cache::MAX_LENGTH + 2, fnLong) == Cache::MAX_LENGTH + 1);
+			CHECK(cache.Get(2, 0x100, szLong, Cache::MAX_LENGTH + 2, fnLong) == Cache::MAX_LENGTH + 1 && nCalls == 2);
+			CHECK(cache.GetStats().hits == 0);
+		}
+
+		//Threads sharing a cache small enough to evict constantly always read what format() writes
+		{
+			Cache cache(4 * nSetBytes);
+			std::atomic<size_t> nMismatches{ 0 };
+			std::vector<std::thread> threads;
+			for (unsigned int nThread = 0; nThread < 4; ++nThread)
+			{
+				threads.emplace_back([&, nThread]()
+				{
+					std::mt19937_64 random(nThread);
+					char16_t szCached[FORMAT_BUFFER_SIZE];
+					char16_t szDirect[FORMAT_BUFFER_SIZE];
+					for (int i = 0; i < 20000; ++i)
+					{
+						unsigned int radix = RADICES[random() % 4];
+						uint64_t value = random() % 64;
+						size_t nLength = cache.Format(radix, value, szCached, FORMAT_BUFFER_SIZE);
+						if (nLength != format(radix, value, szDirect, FORMAT_BUFFER_SIZE) || std::u16string_view(szCached) != std::u16string_view(szDirect))
+							nMismatches.fetch_add(1, std::memory_order_relaxed);
+					}
+				});
+			}
+
+			for (std::thread& thread : threads)
+				thread.join();
+
+			CHECK(nMismatches == 0);
+			stats = cache.GetStats();
+			CHECK(stats.hits + stats.misses == 4 * 20000 && stats.hits > 0 && stats.evictions > 0);
+		}
+	}
+
+	//ValueSlot: the latest value wins, Take() with nothing pending, the counts, and publishers
+	//racing a consumer
+	void TestPublish()
+	{
+		uint64_t value = 7;
+		{
+			ValueSlot slot;
+			CHECK(!slot.IsPending() && !slot.Take(value) && value == 7);
+
+			slot.Publish(1);
+			slot.Publish(2);
+			slot.Publish(3);
+			CHECK(slot.IsPending() && slot.Take(value) && value == 3);
+			CHECK(!slot.IsPending() && !slot.Take(value) && value == 3);
+
+			ValueSlotStats stats = slot.GetStats();
+			CHECK(stats.published == 3 && stats.taken == 1 && stats.coalesced == 2);
+
+			slot.Publish(4);
+			CHECK(slot.Take(value) && value == 4);
+			stats = slot.GetStats();
+			CHECK(stats.published == 4 && stats.taken == 2 && stats.coalesced == 2);
+
+			slot.ResetStats();
+			stats = slot.GetStats();
+			CHECK(stats.published == 0 && stats.taken == 0 && stats.coalesced == 0 && !slot.IsPending());
+		}
+
+		//Each publisher's values are taken in the order it published them, and every value is
+		//either taken or coalesced
+		constexpr unsigned int nPublishers = 4;
+		constexpr uint64_t nPerPublisher = 100000;
+		ValueSlot slot;
+		std::atomic<unsigned int> nRunning{ nPublishers };
+		std::vector<std::thread> publishers;
+		for (unsigned int nThread = 0; nThread < nPublishers; ++nThread)
+		{
+			publishers.emplace_back([&, nThread]()
+			{
+				for (uint64_t i = 1; i <= nPerPublisher; ++i)
+					slot.Publish((static_cast<uint64_t>(nThread) << 32) | i);
+
+				nRunning.fetch_sub(1, std::memory_order_release);
+			});
+		}
+
+		uint64_t nLast[nPublishers] = {};
+		bool bOrdered = true;
+		for (bool bDone = false; !bDone; )
+		{
+			bDone = nRunning.load(std::memory_order_acquire) == 0;
+			while (slot.Take(value))
+			{
+				uint64_t& nSeen = nLast[value >> 32];
+				bOrdered &= (value & 0xFFFFFFFF) >= nSeen;
+				nSeen = value & 0xFFFFFFFF;
+			}
+		}
+
+		for (std::thread& publisher : publishers)
+			publisher.join();
+
+		ValueSlotStats stats = slot.GetStats();
+		CHECK(bOrdered && (value & 0xFFFFFFFF) == nPerPublisher);
+		CHECK(stats.published == nPublishers * nPerPublisher && stats.taken + stats.coalesced == stats.published);
+	}
+
+	struct Suite
+	{
+		const char* pszName;
+		void (*fnRun)();
+	};
+
+	constexpr Suite SUITES[] =
+	{
+		{ "core",		TestCore },
+		{ "cache",		TestCache },
+		{ "grid",		TestGrid },
+		{ "group",		TestGroup },
+		{ "expr",		TestExpr },
+		{ "model",		TestModel },
+		{ "parallel",	TestParallel },
+		{ "paste",		TestPaste },
+		{ "publish",	TestPublish },
+		{ "real",		TestReal },
+		{ "signed",		TestSigned },
+		{ "wide",		TestWide },
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		bool bFound = false;
+		for (const Suite& suite : SUITES)
+			bFound |= !strcmp(argv[i], suite.pszName);
+
+		if (!bFound)
+		{
+			fprintf(stderr, "Unknown suite %s\n", argv[i]);
+			return 2;
+		}
+	}
+
+	for (const Suite& suite : SUITES)
+	{
+		bool bRun = argc == 1;
+		for (int i = 1; i < argc; ++i)
+			bRun |= !strcmp(argv[i], suite.pszName);
+
+		if (!bRun)
+			continue;
+
+		unsigned int nFailures = g_nFailures;
+		suite.fnRun();
+		fprintf(stderr, "%-10s %s\n", suite.pszName, g_nFailures == nFailures ? "passed" : "FAILED");
+	}
+
+	fprintf(stderr, "%u checks, %u failures\n", g_nChecks, g_nFailures);
+	return g_nFailures ? 1 : 0;
+}
@@ -0,0 +1,206 @@
+/*
+	editreplay.cpp
+
+	Replays a keystroke and command trace (see NumericRadixReplay.h) against the headless model of
+	CNumericEditControl's input logic and reports throughput and the latency distribution of each
+	event type:
+
+		editreplay session.trace
+		editreplay -g 10000 -n 5
+
+	The trace is replayed once untimed for throughput, then REPEAT times with each event timed.
+	Latencies are shown in nanoseconds as log2 bucket upper bounds (so "p99 <= 511" means 99% of
+	events took at most 511ns), converted from time stamp counter ticks at a rate measured over
+	the run. With -g a synthetic trace of SESSIONS editing sessions is generated instead of reading
+	one, and -w writes it out for reuse.
+
+	Exit status: 0 on success, 2 on usage, I/O or trace errors.
+
+	MIT License for CNumericEditControl:
+
+	Copyright (c) 2019-2020 Data Synergy UK Ltd
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "NumericRadixReplay.h"
+
+namespace
+{
+	struct Options
+	{
+		const char* pszTrace = nullptr;
+		const char* pszWrite = nullptr;
+		size_t sessions = 0;
+		unsigned int repeat = 3;
+	};
+
+	bool ReadFile(const char* pszPath, std::string& text)
+	{
+		FILE* f = fopen(pszPath, "rb");
+		if (!f)
+			return false;
+
+		char buffer[1 << 16];
+		size_t nRead = 0;
+		while ((nRead = fread(buffer, 1, sizeof(buffer), f)) != 0)
+			text.append(buffer, nRead);
+
+		bool bOk = !ferror(f);
+		fclose(f);
+		return bOk;
+	}
+
+	bool WriteFile(const char* pszPath, const std::string& text)
+	{
+		FILE* f = fopen(pszPath, "wb");
+		if (!f)
+			return false;
+
+		bool bOk = fwrite(text.data(), 1, text.size(), f) == text.size();
+		return fclose(f) == 0 && bOk;
+	}
+
+	void PrintUsage(FILE* f)
+	{
+		fprintf(f,
+			"Usage: editreplay [-n REPEAT] [-g SESSIONS [-w OUTPUT]] [TRACE]\n"
+			"Replay a keystroke and command trace against the headless edit control model\n"
+			"and report throughput and per-event latency.\n"
+			"\n"
+			"  -n REPEAT    timed replays of the trace (default 3)\n"
+			"  -g SESSIONS  generate a synthetic trace of SESSIONS editing sessions\n"
+			"  -w OUTPUT    write the generated trace to OUTPUT\n");
+	}
+
+	double NanosecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* pszArg = argv[i];
+		if (strcmp(pszArg, "-n") == 0 && i + 1 < argc)
+			options.repeat = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+
+		else if (strcmp(pszArg, "-g") == 0 && i + 1 < argc)
+			options.sessions = static_cast<size_t>(strtoull(argv[++i], nullptr, 10));
+
+		else if (strcmp(pszArg, "-w") == 0 && i + 1 < argc)
+			options.pszWrite = argv[++i];
+
+		else if (strcmp(pszArg, "-h") == 0 || strcmp(pszArg, "--help") == 0)
+		{
+			PrintUsage(stdout);
+			return 0;
+		}
+
+		else if (pszArg[0] != '-' && !options.pszTrace)
+			options.pszTrace = pszArg;
+
+		else
+		{
+			PrintUsage(stderr);
+			return 2;
+		}
+	}
+
+	if (!options.pszTrace == !options.sessions || (options.pszWrite && !options.sessions))
+	{
+		PrintUsage(stderr);
+		return 2;
+	}
+
+	std::string text;
+	if (options.sessions)
+	{
+		text = numeric_radix::MakeEditSessionTrace(options.sessions);
+		if (options.pszWrite && !WriteFile(options.pszWrite, text))
+		{
+			fprintf(stderr, "editreplay: cannot write '%s'\n", options.pszWrite);
+			return 2;
+		}
+	}
+
+	else if (!ReadFile(options.pszTrace, text))
+	{
+		fprintf(stderr, "editreplay: cannot read '%s'\n", options.pszTrace);
+		return 2;
+	}
+
+	numeric_radix::EditTrace<char16_t> trace;
+	size_t nBadLine = numeric_radix::parse_edit_trace(text, trace);
+	if (nBadLine)
+	{
+		fprintf(stderr, "editreplay: invalid event on line %zu\n", nBadLine);
+		return 2;
+	}
+
+	if (trace.events.empty())
+	{
+		fprintf(stderr, "editreplay: no events\n");
+		return 2;
+	}
+
+	numeric_radix::EditClipboard<char16_t> clipboard;
+	numeric_radix::NumericEditModel<char16_t> model(clipboard);
+
+	auto start = std::chrono::steady_clock::now();
+	numeric_radix::replay_edit_trace(model, clipboard, trace);
+	double dUntimed = NanosecondsSince(start);
+
+	numeric_radix::ReplayStats stats;
+	start = std::chrono::steady_clock::now();
+	uint64_t nStartTicks = numeric_radix::trace::ReadCycles();
+	for (unsigned int i = 0; i < options.repeat; ++i)
+		numeric_radix::replay_edit_trace(model, clipboard, trace, stats);
+
+	double dTimed = NanosecondsSince(start);
+	uint64_t nTicks = numeric_radix::trace::ReadCycles() - nStartTicks;
+	double dTicksPerNanosecond = dTimed > 0 && nTicks ? static_cast<double>(nTicks) / dTimed : 1.0;
+
+	printf("%zu events, %.1f M events/s untimed (%.1f ns/event)\n", trace.events.size(),
+		static_cast<double>(trace.events.size()) / dUntimed * 1e3, dUntimed / static_cast<double>(trace.events.size()));
+
+	printf("\n%-10s %12s %10s %10s %10s %10s %12s\n", "event", "count", "mean ns", "p50 <=", "p90 <=", "p99 <=", "max ns");
+	for (size_t nType = 0; nType < numeric_radix::EDIT_EVENT_TYPE_COUNT; ++nType)
+	{
+		const numeric_radix::trace::ProbeStats& probe = stats.events[nType];
+		if (!probe.calls)
+			continue;
+
+		auto fnNanoseconds = [&](uint64_t nCycles) { return static_cast<double>(nCycles) / dTicksPerNanosecond; };
+		printf("%-10s %12llu %10.1f %10.0f %10.0f %10.0f %12.0f\n", numeric_radix::EditEventName(static_cast<numeric_radix::EditEventType>(nType)),
+			static_cast<unsigned long long>(probe.calls), fnNanoseconds(probe.totalCycles) / static_cast<double>(probe.calls),
+			fnNanoseconds(probe.Percentile(0.5)), fnNanoseconds(probe.Percentile(0.9)), fnNanoseconds(probe.Percentile(0.99)), fnNanoseconds(probe.maxCycles));
+	}
+
+	return 0;
+}
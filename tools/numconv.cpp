@@ -0,0 +1,586 @@
+/*
+	numconv.cpp
+
+	Command-line counterpart of CNumericEditControl::ChangeMode() for batch pipelines. Reads one
+	value per line from standard input, converts it from one display radix to another with the
+	control's conversion rules (see NumericRadix.h) and writes it to standard output:
+
+		numconv -f dec -t hex < values.txt > values.hex
+		numconv -f hex -t dec -i trace.txt -o trace.dec
+
+	Commas and spaces are stripped, hex input may be prefixed with "0x" and octal with "0", and
+	output uses the control's display format. CRLF line ends are accepted. Each invalid line is
+	written as an empty line, so output lines stay aligned with input lines, and is reported on
+	standard error with its line number and byte offset. Empty lines are passed through.
+
+	Input is read and output written in 1MB blocks, so the cost is dominated by conversion
+	rather than I/O calls.
+
+	With -i and -o (not available on Windows) the input file is memory-mapped and parsed in
+	place by several threads. The file is processed in rounds of one 8MB chunk per thread, split
+	at line ends. Each thread converts its chunk into a private buffer, then the output file is
+	extended, the new part is mapped and the buffers are copied into it in parallel. Processed
+	input pages are released after each round, so peak memory use depends on the thread count,
+	not on the file size. Throughput and peak RSS are reported on standard error.
+
+	Exit status: 0 if every line converted, 1 if any line was invalid, 2 on usage or I/O errors.
+
+	MIT License for CNumericEditControl:
+
+	Copyright (c) 2019-2020 Data Synergy UK Ltd
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "NumericRadix.h"
+
+namespace
+{
+	constexpr size_t IO_BLOCK_SIZE = 1 << 20;
+
+	//Input per thread per round in memory-mapped mode
+	constexpr size_t CHUNK_SIZE = 8 << 20;
+
+	//Longest output line: a formatted value and the line end
+	constexpr size_t MAX_OUTPUT_LINE = numeric_radix::FORMAT_BUFFER_SIZE;
+
+	struct Options
+	{
+		unsigned int fromRadix = 10;
+		unsigned int toRadix = 16;
+		bool bQuiet = false;
+
+		//Memory-mapped mode
+		const char* pszInput = nullptr;
+		const char* pszOutput = nullptr;
+		unsigned int threadCount = 0;
+	};
+
+	//An invalid line, relative to the start of the block it was found in
+	struct LineError
+	{
+		uint64_t line;
+		uint64_t offset;
+	};
+
+	//Growable output block. Lines are formatted directly into it
+	class OutputBuffer
+	{
+	public:
+		char* Reserve(size_t nLength)
+		{
+			if (m_data.size() - m_nSize < nLength)
+				m_data.resize((m_data.size() + nLength) * 2);
+
+			return m_data.data() + m_nSize;
+		}
+
+		void Commit(size_t nLength) { m_nSize += nLength; }
+		void Clear() { m_nSize = 0; }
+		const char* Data() const { return m_data.data(); }
+		size_t Size() const { return m_nSize; }
+
+	private:
+		std::vector<char> m_data;
+		size_t m_nSize = 0;
+	};
+
+	//Convert the lines of [pFirst, pLast). Every line but the last ends in '\n'; a final line
+	//without one is converted as if it had one. Returns the number of lines
+	template <unsigned int From, unsigned int To>
+	uint64_t ConvertBlock(const char* pFirst, const char* pLast, OutputBuffer& output, std::vector<LineError>& errors)
+	{
+		uint64_t nLines = 0;
+		for (const char* pLine = pFirst; pLine != pLast; ++nLines)
+		{
+			const char* pEnd = static_cast<const char*>(memchr(pLine, '\n', static_cast<size_t>(pLast - pLine)));
+			const char* pNext = pEnd ? pEnd + 1 : pLast;
+			if (!pEnd)
+				pEnd = pLast;
+
+			if (pEnd != pLine && pEnd[-1] == '\r')
+				--pEnd;
+
+			char* pOut = output.Reserve(MAX_OUTPUT_LINE);
+			size_t nLength = 0;
+			if (pEnd != pLine)
+			{
+				uint64_t value = 0;
+				if (numeric_radix::parse<From>(std::string_view(pLine, static_cast<size_t>(pEnd - pLine)), value))
+					nLength = numeric_radix::format<To>(value, pOut, MAX_OUTPUT_LINE);
+				else
+					errors.push_back(LineError{ nLines, static_cast<uint64_t>(pLine - pFirst) });
+			}
+
+			pOut[nLength] = '\n';
+			output.Commit(nLength + 1);
+			pLine = pNext;
+		}
+
+		return nLines;
+	}
+
+	using ConvertBlockFn = uint64_t (*)(const char*, const char*, OutputBuffer&, std::vector<LineError>&);
+
+	//Select the conversion once, rather than dispatching on both radices for every line
+	template <unsigned int From>
+	ConvertBlockFn GetConvertBlock(unsigned int toRadix)
+	{
+		switch (toRadix)
+		{
+			case 2:		return ConvertBlock<From, 2>;
+			case 8:		return ConvertBlock<From, 8>;
+			case 10:	return ConvertBlock<From, 10>;
+			default:	return ConvertBlock<From, 16>;
+		}
+	}
+
+	ConvertBlockFn GetConvertBlock(unsigned int fromRadix, unsigned int toRadix)
+	{
+		switch (fromRadix)
+		{
+			case 2:		return GetConvertBlock<2>(toRadix);
+			case 8:		return GetConvertBlock<8>(toRadix);
+			case 10:	return GetConvertBlock<10>(toRadix);
+			default:	return GetConvertBlock<16>(toRadix);
+		}
+	}
+
+	struct StreamState
+	{
+		uint64_t nLine = 0;
+		uint64_t nOffset = 0;
+		uint64_t nInvalid = 0;
+	};
+
+	void ReportError(uint64_t nLine, uint64_t nOffset, const Options& options)
+	{
+		if (!options.bQuiet)
+			fprintf(stderr, "numconv: invalid value at line %llu, offset %llu\n", static_cast<unsigned long long>(nLine + 1), static_cast<unsigned long long>(nOffset));
+	}
+
+	//Report the errors of a block and advance past it
+	void EndBlock(StreamState& state, uint64_t nLines, uint64_t nBytes, std::vector<LineError>& errors, const Options& options)
+	{
+		for (const LineError& error : errors)
+			ReportError(state.nLine + error.line, state.nOffset + error.offset, options);
+
+		state.nInvalid += errors.size();
+		state.nLine += nLines;
+		state.nOffset += nBytes;
+		errors.clear();
+	}
+
+	bool WriteOutput(OutputBuffer& output)
+	{
+		bool bWritten = fwrite(output.Data(), 1, output.Size(), stdout) == output.Size();
+		output.Clear();
+		return bWritten;
+	}
+
+	//Convert standard input to standard output. The complete lines of each block are converted as
+	//it is read and a partial line at the end is moved to the front for the next read. A line
+	//longer than a whole block cannot hold a value; it is reported as invalid and skipped
+	int ConvertStream(const Options& options)
+	{
+		ConvertBlockFn fnConvert = GetConvertBlock(options.fromRadix, options.toRadix);
+
+		std::vector<char> input(IO_BLOCK_SIZE);
+		OutputBuffer output;
+		std::vector<LineError> errors;
+		StreamState state;
+		size_t nPending = 0;
+		bool bSkipping = false;
+
+		for (;;)
+		{
+			size_t nRead = fread(input.data() + nPending, 1, input.size() - nPending, stdin);
+			if (nRead == 0 && ferror(stdin))
+			{
+				fprintf(stderr, "numconv: read error\n");
+				return 2;
+			}
+
+			bool bEnd = nRead == 0;
+			const char* pData = input.data();
+			size_t nAvailable = nPending + nRead;
+
+			//Rest of an overlong line
+			if (bSkipping)
+			{
+				const char* pLineEnd = static_cast<const char*>(memchr(pData, '\n', nAvailable));
+				size_t nSkip = pLineEnd ? static_cast<size_t>(pLineEnd + 1 - pData) : nAvailable;
+				state.nOffset += nSkip;
+				pData += nSkip;
+				nAvailable -= nSkip;
+				bSkipping = !pLineEnd;
+			}
+
+			//Complete lines, or everything at the end of input
+			size_t nComplete = nAvailable;
+			if (!bEnd)
+			{
+				while (nComplete && pData[nComplete - 1] != '\n')
+					--nComplete;
+
+				if (!nComplete && nAvailable == input.size())
+				{
+					ReportError(state.nLine, state.nOffset, options);
+					++state.nInvalid;
+					++state.nLine;
+					state.nOffset += nAvailable;
+					output.Reserve(1)[0] = '\n';
+					output.Commit(1);
+					nAvailable = 0;
+					bSkipping = true;
+				}
+			}
+
+			uint64_t nLines = fnConvert(pData, pData + nComplete, output, errors);
+			EndBlock(state, nLines, nComplete, errors, options);
+
+			if (!WriteOutput(output))
+			{
+				fprintf(stderr, "numconv: write error\n");
+				return 2;
+			}
+
+			if (bEnd)
+				break;
+
+			nPending = nAvailable - nComplete;
+			memmove(input.data(), pData + nComplete, nPending);
+		}
+
+		if (fflush(stdout) != 0)
+		{
+			fprintf(stderr, "numconv: write error\n");
+			return 2;
+		}
+
+		return state.nInvalid ? 1 : 0;
+	}
+
+#ifndef _WIN32
+	//Run fn(0) .. fn(nThreads - 1) concurrently, fn(0) on the calling thread
+	template <typename Fn>
+	void RunThreads(unsigned int nThreads, Fn fn)
+	{
+		std::vector<std::thread> threads;
+		for (unsigned int i = 1; i < nThreads; ++i)
+			threads.emplace_back(fn, i);
+
+		fn(0);
+		for (std::thread& thread : threads)
+			thread.join();
+	}
+
+	//One thread's share of a round: its lines and their converted output
+	struct Chunk
+	{
+		const char* pFirst = nullptr;
+		const char* pLast = nullptr;
+		OutputBuffer output;
+		std::vector<LineError> errors;
+		uint64_t nLines = 0;
+		uint64_t nOutputOffset = 0;
+	};
+
+	//Start of the line after p, or pEnd
+	const char* NextLine(const char* p, const char* pEnd)
+	{
+		const char* pLineEnd = p != pEnd ? static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(pEnd - p))) : nullptr;
+		return pLineEnd ? pLineEnd + 1 : pEnd;
+	}
+
+	//Start of the last line that begins at or before p, or pFirst
+	const char* LineStart(const char* pFirst, const char* p)
+	{
+		while (p != pFirst && p[-1] != '\n')
+			--p;
+
+		return p;
+	}
+
+	int ConvertFile(const Options& options)
+	{
+		auto start = std::chrono::steady_clock::now();
+		ConvertBlockFn fnConvert = GetConvertBlock(options.fromRadix, options.toRadix);
+		unsigned int nThreads = options.threadCount ? options.threadCount : std::thread::hardware_concurrency();
+		if (!nThreads)
+			nThreads = 1;
+
+		int fdIn = open(options.pszInput, O_RDONLY);
+		if (fdIn < 0)
+		{
+			fprintf(stderr, "numconv: cannot open '%s'\n", options.pszInput);
+			return 2;
+		}
+
+		int fdOut = open(options.pszOutput, O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (fdOut < 0)
+		{
+			fprintf(stderr, "numconv: cannot create '%s'\n", options.pszOutput);
+			close(fdIn);
+			return 2;
+		}
+
+		struct stat st;
+		size_t nInputSize = fstat(fdIn, &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+		const char* pInput = nullptr;
+		if (nInputSize)
+		{
+			void* pMap = mmap(nullptr, nInputSize, PROT_READ, MAP_PRIVATE, fdIn, 0);
+			if (pMap == MAP_FAILED)
+			{
+				fprintf(stderr, "numconv: cannot map '%s'\n", options.pszInput);
+				close(fdIn);
+				close(fdOut);
+				return 2;
+			}
+
+			pInput = static_cast<const char*>(pMap);
+			madvise(pMap, nInputSize, MADV_SEQUENTIAL);
+		}
+
+		const size_t nPageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+		const char* pInputEnd = pInput + nInputSize;
+		std::vector<Chunk> chunks(nThreads);
+		StreamState state;
+		uint64_t nOutputSize = 0;
+		bool bFailed = false;
+
+		for (const char* pRound = pInput; pRound != pInputEnd && !bFailed;)
+		{
+			//Round of up to one chunk per thread, ending at a line end. A line longer than a
+			//whole round extends it to its end
+			const char* pRoundEnd = pInputEnd;
+			if (static_cast<size_t>(pInputEnd - pRound) > nThreads * CHUNK_SIZE)
+			{
+				pRoundEnd = LineStart(pRound, pRound + nThreads * CHUNK_SIZE);
+				if (pRoundEnd == pRound)
+					pRoundEnd = NextLine(pRound + nThreads * CHUNK_SIZE, pInputEnd);
+			}
+
+			//Split the round into chunks at line ends and convert them
+			size_t nRoundSize = static_cast<size_t>(pRoundEnd - pRound);
+			const char* pChunk = pRound;
+			for (unsigned int i = 0; i < nThreads; ++i)
+			{
+				const char* pNominal = pRound + nRoundSize / nThreads * (i + 1);
+				chunks[i].pFirst = pChunk;
+				chunks[i].pLast = i + 1 == nThreads ? pRoundEnd : (pNominal > pChunk ? NextLine(pNominal - 1, pRoundEnd) : pChunk);
+				pChunk = chunks[i].pLast;
+			}
+
+			RunThreads(nThreads, [&](unsigned int i)
+			{
+				Chunk& chunk = chunks[i];
+				chunk.output.Clear();
+				chunk.nLines = fnConvert(chunk.pFirst, chunk.pLast, chunk.output, chunk.errors);
+			});
+
+			//Place the chunks' output one after another in the output file
+			uint64_t nRoundStart = nOutputSize;
+			for (Chunk& chunk : chunks)
+			{
+				chunk.nOutputOffset = nOutputSize;
+				nOutputSize += chunk.output.Size();
+				EndBlock(state, chunk.nLines, static_cast<uint64_t>(chunk.pLast - chunk.pFirst), chunk.errors, options);
+			}
+
+			if (nOutputSize != nRoundStart)
+			{
+				uint64_t nMapStart = nRoundStart / nPageSize * nPageSize;
+				size_t nMapSize = static_cast<size_t>(nOutputSize - nMapStart);
+				void* pMap = ftruncate(fdOut, static_cast<off_t>(nOutputSize)) == 0 ?
+					mmap(nullptr, nMapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fdOut, static_cast<off_t>(nMapStart)) : MAP_FAILED;
+
+				if (pMap == MAP_FAILED)
+				{
+					fprintf(stderr, "numconv: cannot write '%s'\n", options.pszOutput);
+					bFailed = true;
+					break;
+				}
+
+				RunThreads(nThreads, [&](unsigned int i)
+				{
+					memcpy(static_cast<char*>(pMap) + (chunks[i].nOutputOffset - nMapStart), chunks[i].output.Data(), chunks[i].output.Size());
+				});
+
+				munmap(pMap, nMapSize);
+			}
+
+			//Release the input pages of this round
+			size_t nDone = static_cast<size_t>(pRoundEnd - pInput) / nPageSize * nPageSize;
+			size_t nReleased = static_cast<size_t>(pRound - pInput) / nPageSize * nPageSize;
+			if (nDone > nReleased)
+				madvise(const_cast<char*>(pInput) + nReleased, nDone - nReleased, MADV_DONTNEED);
+
+			pRound = pRoundEnd;
+		}
+
+		if (pInput)
+			munmap(const_cast<char*>(pInput), nInputSize);
+
+		close(fdIn);
+		if (close(fdOut) != 0 && !bFailed)
+		{
+			fprintf(stderr, "numconv: cannot write '%s'\n", options.pszOutput);
+			bFailed = true;
+		}
+
+		if (bFailed)
+			return 2;
+
+		if (!options.bQuiet)
+		{
+			double dSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			struct rusage usage;
+			getrusage(RUSAGE_SELF, &usage);
+
+			fprintf(stderr, "numconv: %llu lines, %llu bytes in %.3f s (%.1f MB/s, %u threads, peak RSS %ld KB)\n",
+				static_cast<unsigned long long>(state.nLine), static_cast<unsigned long long>(nInputSize), dSeconds,
+				dSeconds > 0 ? static_cast<double>(nInputSize) / dSeconds / 1e6 : 0.0, nThreads, static_cast<long>(usage.ru_maxrss));
+		}
+
+		return state.nInvalid ? 1 : 0;
+	}
+#else
+	int ConvertFile(const Options&)
+	{
+		fprintf(stderr, "numconv: -i and -o are not available on this platform\n");
+		return 2;
+	}
+#endif
+
+	bool ParseRadix(const char* pszName, unsigned int& radix)
+	{
+		static const struct { const char* pszName; unsigned int radix; } radices[] =
+		{
+			{ "dec", 10 }, { "10", 10 }, { "hex", 16 }, { "16", 16 }, { "oct", 8 }, { "8", 8 }, { "bin", 2 }, { "2", 2 },
+		};
+
+		for (const auto& entry : radices)
+		{
+			if (strcmp(pszName, entry.pszName) == 0)
+			{
+				radix = entry.radix;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void PrintUsage(FILE* f)
+	{
+		fprintf(f,
+			"Usage: numconv [-f RADIX] [-t RADIX] [-q] [-i INPUT -o OUTPUT [-j THREADS]]\n"
+			"Convert one value per line from standard input to standard output, or from\n"
+			"INPUT to OUTPUT using memory-mapped files and several threads.\n"
+			"\n"
+			"  -f RADIX    input radix (default dec)\n"
+			"  -t RADIX    output radix (default hex)\n"
+			"  -q          do not report invalid lines or throughput\n"
+			"  -i INPUT    input file\n"
+			"  -o OUTPUT   output file\n"
+			"  -j THREADS  threads for file conversion (default: one per hardware thread)\n"
+			"\n"
+			"RADIX is dec, hex, oct or bin (or 10, 16, 8, 2).\n");
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* pszArg = argv[i];
+		if ((strcmp(pszArg, "-f") == 0 || strcmp(pszArg, "-t") == 0) && i + 1 < argc)
+		{
+			unsigned int& radix = pszArg[1] == 'f' ? options.fromRadix : options.toRadix;
+			if (!ParseRadix(argv[++i], radix))
+			{
+				fprintf(stderr, "numconv: unknown radix '%s'\n", argv[i]);
+				return 2;
+			}
+		}
+
+		else if (strcmp(pszArg, "-q") == 0)
+			options.bQuiet = true;
+
+		else if (strcmp(pszArg, "-i") == 0 && i + 1 < argc)
+			options.pszInput = argv[++i];
+
+		else if (strcmp(pszArg, "-o") == 0 && i + 1 < argc)
+			options.pszOutput = argv[++i];
+
+		else if (strcmp(pszArg, "-j") == 0 && i + 1 < argc)
+			options.threadCount = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+
+		else if (strcmp(pszArg, "-h") == 0 || strcmp(pszArg, "--help") == 0)
+		{
+			PrintUsage(stdout);
+			return 0;
+		}
+
+		else
+		{
+			PrintUsage(stderr);
+			return 2;
+		}
+	}
+
+	if (options.pszInput || options.pszOutput)
+	{
+		if (!options.pszInput || !options.pszOutput)
+		{
+			PrintUsage(stderr);
+			return 2;
+		}
+
+		return ConvertFile(options);
+	}
+
+#ifdef _WIN32
+	_setmode(_fileno(stdin), _O_BINARY);
+	_setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+	return ConvertStream(options);
+}